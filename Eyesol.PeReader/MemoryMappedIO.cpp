@@ -1,6 +1,7 @@
 #include <cassert>
 #include "MemoryMappedIO.hpp"
 #include "Runtime.hpp"
+#include "ViewCache.hpp"
 
 namespace Eyesol::MemoryMappedIO
 {
@@ -27,6 +28,20 @@ namespace Eyesol::MemoryMappedIO
 			return MemoryMappedFile{ fileImpl };
 		}
 
+		MappingMode ResolveMappingMode(MappingMode mode, std::uint64_t fileLength) noexcept
+		{
+			if (mode != MappingMode::Auto)
+			{
+				return mode;
+			}
+			// An empty file has nothing to map
+			if (fileLength == 0 || fileLength > WholeFileMappingThreshold)
+			{
+				return MappingMode::Windowed;
+			}
+			return MappingMode::WholeFile;
+		}
+
 		std::size_t CalculateMapRegionParameters(
 			std::uint64_t absoluteOffset, // Absolute offset in the file
 			std::uint64_t fileLength, // Total file length in bytes
@@ -39,6 +54,21 @@ namespace Eyesol::MemoryMappedIO
 			{
 				throw std::out_of_range{ "File offset is out of range of file length" };
 			}
+			return *TryCalculateMapRegionParameters(absoluteOffset, fileLength, baseOffsetPtr, regionLengthPtr, offsetInRegionPtr);
+		}
+
+		Result<std::size_t> TryCalculateMapRegionParameters(
+			std::uint64_t absoluteOffset,
+			std::uint64_t fileLength,
+			std::uint64_t* baseOffsetPtr,
+			std::size_t* regionLengthPtr,
+			std::size_t* offsetInRegionPtr
+		) noexcept
+		{
+			if (absoluteOffset >= fileLength)
+			{
+				return Unexpected{ ErrorCode::OffsetOutOfRange };
+			}
 			std::size_t granularity = { Eyesol::Runtime::AllocationGranularity() };
 			// Allocate a new region
 			std::uint64_t base{ absoluteOffset / granularity * granularity };
@@ -70,28 +100,33 @@ namespace Eyesol::MemoryMappedIO
 
 	#pragma region MemoryMappedFile implementation
 	MemoryMappedFile::MemoryMappedFile() noexcept
-		: _length{ 0 }
+		: _length{ 0 },
+		_wholeFileView{ nullptr }
 	{
 	}
 
-	MemoryMappedFile::MemoryMappedFile(std::string path)
+	MemoryMappedFile::MemoryMappedFile(std::string path, MappingMode mode)
 	{
-		_impl = Impl::OpenFile(path, _length);
+		_impl = Impl::OpenFile(path, _length, mode);
+		_wholeFileView = Impl::GetWholeFileView(*_impl);
 	}
 
-	MemoryMappedFile::MemoryMappedFile(std::u16string path)
+	MemoryMappedFile::MemoryMappedFile(std::u16string path, MappingMode mode)
 	{
-		_impl = Impl::OpenFile(path, _length);
+		_impl = Impl::OpenFile(path, _length, mode);
+		_wholeFileView = Impl::GetWholeFileView(*_impl);
 	}
 
-	MemoryMappedFile::MemoryMappedFile(std::wstring path)
+	MemoryMappedFile::MemoryMappedFile(std::wstring path, MappingMode mode)
 	{
-		_impl = Impl::OpenFile(path, _length);
+		_impl = Impl::OpenFile(path, _length, mode);
+		_wholeFileView = Impl::GetWholeFileView(*_impl);
 	}
 
 	MemoryMappedFile::MemoryMappedFile(const MemoryMappedFile& other)
 		: _impl{ other._impl },
-		_length{ other._length }
+		_length{ other._length },
+		_wholeFileView{ other._wholeFileView }
 	{
 	}
 
@@ -99,19 +134,23 @@ namespace Eyesol::MemoryMappedIO
 	{
 		_impl = Impl::get_impl(*Impl::get_impl(region));
 		_length = Impl::GetFileLength(*_impl);
+		_wholeFileView = Impl::GetWholeFileView(*_impl);
 	}
 
 	MemoryMappedFile::MemoryMappedFile(const std::shared_ptr<Impl::MemoryMappedFileImpl>& impl)
 		: _impl{ impl },
-		_length{ Impl::GetFileLength(*impl) }
+		_length{ Impl::GetFileLength(*impl) },
+		_wholeFileView{ Impl::GetWholeFileView(*impl) }
 	{
 	}
 
 	MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept
 		: _impl{ std::move(other._impl) },
-		_length{ other._length }
+		_length{ other._length },
+		_wholeFileView{ other._wholeFileView }
 	{
 		other._length = 0;
+		other._wholeFileView = nullptr;
 	}
 
 	MemoryMappedFile::~MemoryMappedFile()
@@ -122,6 +161,7 @@ namespace Eyesol::MemoryMappedIO
 	{
 		_impl = other._impl;
 		_length = other._length;
+		_wholeFileView = other._wholeFileView;
 		return *this;
 	}
 
@@ -129,7 +169,9 @@ namespace Eyesol::MemoryMappedIO
 	{
 		_impl = std::move(other._impl);
 		_length = other._length;
+		_wholeFileView = other._wholeFileView;
 		other._length = 0;
+		other._wholeFileView = nullptr;
 		return *this;
 	}
 
@@ -140,6 +182,10 @@ namespace Eyesol::MemoryMappedIO
 			throw std::out_of_range{ "absolute offset is too long: "
 				+ std::to_string(absoluteOffset) + ", maximum " + std::to_string(_length) + " is allowed" };
 		}
+		if (_wholeFileView != nullptr)
+		{
+			return _wholeFileView[absoluteOffset];
+		}
 		// If cache is empty
 		std::size_t offsetInRegion;
 		std::uint64_t baseOffset;
@@ -167,6 +213,24 @@ namespace Eyesol::MemoryMappedIO
 		return Impl::GetFilePath(*_impl);
 	}
 
+	ViewCacheStatistics MemoryMappedFile::GetViewCacheStatistics() const
+	{
+		if (_impl == nullptr)
+		{
+			return ViewCacheStatistics{};
+		}
+		return Impl::GetViewCache(*_impl).statistics();
+	}
+
+	void MemoryMappedFile::SetViewCacheCapacity(std::size_t viewsCount)
+	{
+		if (_impl == nullptr)
+		{
+			throw std::runtime_error{ "object is empty" };
+		}
+		Impl::GetViewCache(*_impl).SetCapacity(viewsCount);
+	}
+
 	MemoryMappedFileRegion MemoryMappedFile::MapRegion(std::uint64_t offset, std::size_t length) const
 	{
 		if (empty())
@@ -176,11 +240,94 @@ namespace Eyesol::MemoryMappedIO
 		return MemoryMappedFileRegion(_impl, offset, length);
 	}
 
+	Result<MemoryMappedFileRegion> MemoryMappedFile::TryMapRegion(std::uint64_t offset, std::size_t length) const
+	{
+		if (empty())
+		{
+			return Unexpected{ ErrorCode::EmptyObject };
+		}
+		// The same checks, as the platform implementation performs
+		if (offset % Eyesol::Runtime::AllocationGranularity() != 0)
+		{
+			return Unexpected{ ErrorCode::MisalignedOffset };
+		}
+		if (offset >= _length)
+		{
+			return Unexpected{ ErrorCode::OffsetOutOfRange };
+		}
+		if (length > _length - offset)
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		return MapRegion(offset, length);
+	}
+
+	Result<MemoryMappedFileRegion> MemoryMappedFile::TryMapRange(std::uint64_t offset, std::size_t length, std::size_t& offsetInRegion) const
+	{
+		if (offset > _length || length > _length - offset)
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		if (length == 0)
+		{
+			// Nothing to map
+			offsetInRegion = 0;
+			return MemoryMappedFileRegion{};
+		}
+		// Views must start at a multiple of the allocation granularity
+		std::size_t granularity = Eyesol::Runtime::AllocationGranularity();
+		std::uint64_t baseOffset = offset / granularity * granularity;
+		offsetInRegion = static_cast<std::size_t>(offset - baseOffset);
+		if (length > std::numeric_limits<std::size_t>::max() - offsetInRegion)
+		{
+			return Unexpected{ ErrorCode::LengthOverflow };
+		}
+		return MapRegion(baseOffset, offsetInRegion + length);
+	}
+
+	MemoryMappedFileRegion MemoryMappedFile::MapRange(std::uint64_t offset, std::size_t length, std::size_t& offsetInRegion) const
+	{
+		if (offset > _length || length > _length - offset)
+		{
+			throw std::out_of_range{ "Range [" + std::to_string(offset) + ", " + std::to_string(offset) + " + "
+				+ std::to_string(length) + ") is out of range of file length " + std::to_string(_length) };
+		}
+		Result<MemoryMappedFileRegion> region = TryMapRange(offset, length, offsetInRegion);
+		if (!region)
+		{
+			ThrowError(region.error());
+		}
+		return std::move(*region);
+	}
+
+	Result<std::size_t> MemoryMappedFile::ViewLength(std::size_t count, std::size_t elementSize) noexcept
+	{
+		if (elementSize != 0 && count > std::numeric_limits<std::size_t>::max() / elementSize)
+		{
+			return Unexpected{ ErrorCode::LengthOverflow };
+		}
+		return count * elementSize;
+	}
+
 	std::size_t MemoryMappedFile::Read(unsigned char* buf, std::size_t bufLength, std::uint64_t fileOffset, std::size_t bufOffset, std::size_t readLength) const
 	{
-		if (fileOffset >= _length)
+		Result<std::size_t> bytesRead = TryRead(buf, bufLength, fileOffset, bufOffset, readLength);
+		if (!bytesRead)
 		{
-			throw std::out_of_range{ "File offset is out of range" };
+			ThrowError(bytesRead.error());
+		}
+		return *bytesRead;
+	}
+
+	Result<std::size_t> MemoryMappedFile::TryRead(unsigned char* buf, std::size_t bufLength, std::uint64_t fileOffset, std::size_t bufOffset, std::size_t readLength) const
+	{
+		if (fileOffset >= _length || bufOffset > bufLength)
+		{
+			return Unexpected{ ErrorCode::OffsetOutOfRange };
+		}
+		if (readLength > std::numeric_limits<std::uint64_t>::max() - fileOffset)
+		{
+			return Unexpected{ ErrorCode::LengthOverflow };
 		}
 		std::size_t remainingBufLength = bufLength - bufOffset;
 		std::size_t bytesToRead = readLength;
@@ -193,6 +340,16 @@ namespace Eyesol::MemoryMappedIO
 		{
 			bytesToRead = { static_cast<std::size_t>(remainingFileLength) };
 		}
+		if (_wholeFileView != nullptr)
+		{
+			// Buffers must not overlap
+			std::memcpy(buf + bufOffset, _wholeFileView + fileOffset, bytesToRead);
+			return bytesToRead;
+		}
+		if (bytesToRead == 0)
+		{
+			return std::size_t{ 0 };
+		}
 		// Reading data region by region
 		std::size_t bytesRead = 0;
 		do
@@ -200,11 +357,16 @@ namespace Eyesol::MemoryMappedIO
 			std::uint64_t baseOffset;
 			std::size_t regionLength;
 			std::size_t offsetInRegion;
+			// The offset is within the file, so this doesn't throw
 			Impl::CalculateMapRegionParameters(fileOffset + bytesRead, _length, &baseOffset, &regionLength, &offsetInRegion);
 			std::size_t currentRegionBytesToRead = std::min(regionLength - offsetInRegion, bytesToRead - bytesRead);
-			MemoryMappedFileRegion currentRegion = MapRegion(baseOffset, regionLength);
+			Result<MemoryMappedFileRegion> currentRegion = TryMapRegion(baseOffset, regionLength);
+			if (!currentRegion)
+			{
+				return Unexpected{ currentRegion.error() };
+			}
 			// Buffers must not overlap
-			std::memcpy(buf + bytesRead, currentRegion.data() + offsetInRegion, currentRegionBytesToRead);
+			std::memcpy(buf + bufOffset + bytesRead, currentRegion->data() + offsetInRegion, currentRegionBytesToRead);
 			bytesRead += currentRegionBytesToRead;
 		} while (bytesRead != bytesToRead);
 		return bytesRead;
@@ -235,11 +397,20 @@ namespace Eyesol::MemoryMappedIO
 
 	const unsigned char* MemoryMappedFileRegion::begin() const
 	{
+		// An empty region
+		if (_impl == nullptr)
+		{
+			return nullptr;
+		}
 		return Impl::RegionBegin(*_impl);
 	}
 
 	const unsigned char* MemoryMappedFileRegion::end() const
 	{
+		if (_impl == nullptr)
+		{
+			return nullptr;
+		}
 		return Impl::RegionEnd(*_impl);
 	}
 
@@ -255,6 +426,49 @@ namespace Eyesol::MemoryMappedIO
 	}
 	#pragma endregion
 
+	#pragma region PrivateMemory implementation
+	PrivateMemory::PrivateMemory() noexcept
+		: _pages{},
+		_length{}
+	{
+	}
+
+	Result<PrivateMemory> PrivateMemory::Allocate(std::size_t length)
+	{
+		PrivateMemory memory;
+		if (length == 0)
+		{
+			return memory;
+		}
+		memory._pages = Impl::AllocatePrivatePages(length);
+		if (memory._pages == nullptr)
+		{
+			return Unexpected{ ErrorCode::OutOfMemory };
+		}
+		memory._length = length;
+		return memory;
+	}
+
+	Result<bool> PrivateMemory::TryMapFile(std::size_t offset, const MemoryMappedFile& file, std::uint64_t fileOffset, std::size_t length)
+	{
+		std::size_t granularity = Runtime::AllocationGranularity();
+		if (length == 0 || offset % granularity != 0 || fileOffset % granularity != 0 || length % granularity != 0)
+		{
+			return false;
+		}
+		if (offset > _length || length > _length - offset)
+		{
+			return false;
+		}
+		// A view beyond the end of the file would fault on access
+		if (fileOffset > file.length() || length > file.length() - fileOffset)
+		{
+			return false;
+		}
+		return Impl::MapFilePagesAt(*Impl::get_impl(file), _pages, offset, fileOffset, length);
+	}
+	#pragma endregion
+
 	#pragma region MemoryMappedFileIterator implementation
 	MemoryMappedFileIterator::MemoryMappedFileIterator(MemoryMappedFileIterator&& other) noexcept
 		: _fileImpl{ std::move(other._fileImpl) },
@@ -5,6 +5,7 @@
 #	endif
 
 #	include <algorithm>
+#	include <bit>
 #	include <cstdio>
 #	include <cstring>
 #	include <utility>
@@ -69,7 +70,7 @@
    || (defined(_MSC_VER) && _M_IX86) /*MSVC++*/ \
    || defined(__i386__) /*GCC,Clang,Intel*/
 // ... x86-32
-#			define _X86_VERSION_IMPL_ X86_32
+#		define _PROCESSOR_ARCHITECTURE_IMPL_ X86_32
 #		if _M_IX86 >= 600
 		// Pentium Pro instructions and instruction scheduling
 #			define _X86_VERSION_IMPL_ PentiumPro
@@ -84,7 +85,7 @@
 #			define _X86_VERSION_IMPL_ _80386
 #		else
 		// This must be GCC or Clang.
-#			define _PROCESSOR_ARCHITECTURE_IMPL_ Unknown
+#			define _X86_VERSION_IMPL_ Unknown
 #		endif
 #	elif __I86__ || _M_I86 /*OpenWatcom*/ \
    || (defined(__DMC__) && !defined(_M_IX86)) /*DigitalMars*/
@@ -112,11 +113,25 @@
 		// 8086 instructions and instruction scheduling
 #			define _X86_VERSION_IMPL_ _8086
 #		endif
+#	elif defined(__aarch64__) /*GCC,Clang*/ \
+   || defined(_M_ARM64) /*MSVC++*/
+// ... AArch64
+#		define _PROCESSOR_ARCHITECTURE_IMPL_ Arm64
+#		define _ARM_VERSION_IMPL_ Unknown
+#	elif defined(__arm__) /*GCC,Clang*/ \
+   || defined(_M_ARM) /*MSVC++*/
+// ... AArch32
+#		define _PROCESSOR_ARCHITECTURE_IMPL_ Arm32
+#		define _ARM_VERSION_IMPL_ Unknown
+#	else
+#		define _PROCESSOR_ARCHITECTURE_IMPL_ Unknown
 #	endif
 
 /*******************************************************
  * TODO : Implement more compiler versions detection,  *
- * add an ARM and IA64 version detection               *
+ * add an ARM and IA64 version detection.              *
+ * Instruction set extensions are detected at runtime, *
+ * see CpuFeatures.hpp                                 *
  *******************************************************/
 
 namespace Eyesol
@@ -162,10 +177,17 @@ namespace Eyesol
 
 	namespace Memory
 	{
+		// Misaligned scalar loads are handled by the hardware on these architectures,
+		// and the compilers emit plain loads for them. GCC and Clang may assume alignment
+		// of dereferenced pointers, so they are only given std::memcpy, which becomes a single load
 		constexpr bool UnalignedAccessAllowed
-			= (Eyesol::Compiler::CurrentCompiler == Eyesol::Compiler::CompilerType::MSVC)
-			&& ((Eyesol::Cpu::CurrentProcessorArch == Eyesol::Cpu::ArchType::X86_32)
-				|| (Eyesol::Cpu::CurrentProcessorArch == Eyesol::Cpu::ArchType::X86_64));
+			= ((Eyesol::Compiler::CurrentCompiler == Eyesol::Compiler::CompilerType::MSVC)
+				&& ((Eyesol::Cpu::CurrentProcessorArch == Eyesol::Cpu::ArchType::X86_32)
+					|| (Eyesol::Cpu::CurrentProcessorArch == Eyesol::Cpu::ArchType::X86_64)))
+			|| ((Eyesol::Compiler::CurrentCompiler == Eyesol::Compiler::CompilerType::Gcc
+					|| Eyesol::Compiler::CurrentCompiler == Eyesol::Compiler::CompilerType::Clang)
+				&& ((Eyesol::Cpu::CurrentProcessorArch == Eyesol::Cpu::ArchType::X86_64)
+					|| (Eyesol::Cpu::CurrentProcessorArch == Eyesol::Cpu::ArchType::Arm64)));
 	}
 }
 
@@ -227,9 +249,9 @@ namespace Eyesol::Compiler
 		return right;
 	}
 
-	// The syntax (#value##"") allows even empty macros definitions to be substituted.
+	// The syntax (#value "") allows even empty macros definitions to be substituted.
 	// A preprocessor authomatically escapes strings in macros if necessary
-#define COMPILER_SPECIFIC_STRING(value) #value##"" 
+#define COMPILER_SPECIFIC_STRING(value) #value "" 
 
 #define COMPILER_SPECIFIC_ENTRY(name) { #name, right_or_null_if_equals(#name, COMPILER_SPECIFIC_STRING(name)) },
 
@@ -0,0 +1,170 @@
+#if !defined _CPUFEATURES_H_
+#	define _CPUFEATURES_H_
+#	include <atomic>
+#	include <initializer_list>
+#	include <stdexcept>
+#	include <string>
+#	include <vector>
+#	include "framework.hpp"
+
+namespace Eyesol::Cpu
+{
+	// Instruction set extensions, which may be used by runtime-dispatched kernels
+	enum class Feature : std::uint32_t
+	{
+		// x86
+		Sse2 = 1U << 0,
+		Ssse3 = 1U << 1,
+		Sse41 = 1U << 2,
+		Sse42 = 1U << 3,
+		Popcnt = 1U << 4,
+		Pclmul = 1U << 5,
+		Avx = 1U << 6,
+		Avx2 = 1U << 7,
+		Bmi2 = 1U << 8,
+		Avx512F = 1U << 9,
+		Avx512Bw = 1U << 10,
+		Avx512Vl = 1U << 11,
+		Sha = 1U << 12,
+		// ARM
+		Neon = 1U << 16,
+		ArmCrc32 = 1U << 17,
+		ArmPmull = 1U << 18,
+		ArmSha1 = 1U << 19,
+		ArmSha2 = 1U << 20,
+	};
+
+	// A set of CPU features
+	class Features
+	{
+	public:
+		constexpr Features() noexcept
+			: _bits{}
+		{
+		}
+
+		constexpr Features(Feature feature) noexcept
+			: _bits{ static_cast<std::uint32_t>(feature) }
+		{
+		}
+
+		constexpr Features(std::initializer_list<Feature> features) noexcept
+			: _bits{}
+		{
+			for (Feature feature : features)
+			{
+				_bits |= static_cast<std::uint32_t>(feature);
+			}
+		}
+
+		static constexpr Features FromBits(std::uint32_t bits) noexcept
+		{
+			Features features;
+			features._bits = bits;
+			return features;
+		}
+
+		// Features of the running CPU, which the OS supports too. Probed only once
+		EYESOLPEREADER_API static Features Detected() noexcept;
+		// Detected features, which are allowed to be used. Kernels are selected from these
+		EYESOLPEREADER_API static Features Current() noexcept;
+
+		constexpr std::uint32_t bits() const noexcept { return _bits; }
+		constexpr bool empty() const noexcept { return _bits == 0; }
+		constexpr bool Has(Feature feature) const noexcept { return (_bits & static_cast<std::uint32_t>(feature)) != 0; }
+		// Returns true if every feature of the required set is present
+		constexpr bool Supports(Features required) const noexcept { return (_bits & required._bits) == required._bits; }
+
+		constexpr Features operator|(Features other) const noexcept { return FromBits(_bits | other._bits); }
+		constexpr Features operator&(Features other) const noexcept { return FromBits(_bits & other._bits); }
+		constexpr Features operator~() const noexcept { return FromBits(~_bits); }
+		constexpr bool operator==(const Features& other) const noexcept = default;
+
+		// Space-separated feature names, e.g. "sse2 ssse3 avx2"
+		EYESOLPEREADER_API std::string ToString() const;
+
+	private:
+		std::uint32_t _bits;
+	};
+
+	// Limits features which runtime-dispatched kernels may use, e.g. to compare kernels
+	// or to work around a faulty host. All features are allowed by default.
+	// Takes effect for every dispatch table on its next call
+	EYESOLPEREADER_API void SetAllowedFeatures(Features allowed) noexcept;
+	EYESOLPEREADER_API Features GetAllowedFeatures() noexcept;
+
+	namespace Impl
+	{
+		// Changes whenever the allowed features change
+		EYESOLPEREADER_API std::uint32_t FeaturesGeneration() noexcept;
+	}
+
+	// Selects the best implementation of an algorithm for the current CPU.
+	// Implementations are listed from the most preferred one, and the last one
+	// must require no features. The choice is made on the first call and cached
+	template <typename Kernel>
+	class DispatchTable
+	{
+	public:
+		struct Entry
+		{
+			// Features the kernel is compiled for
+			Features required;
+			Kernel kernel;
+			const char* name;
+		};
+
+		DispatchTable(std::initializer_list<Entry> entries)
+			: _entries{ entries },
+			_selection{ NOT_SELECTED }
+		{
+			if (_entries.empty() || !_entries.back().required.empty())
+			{
+				throw std::invalid_argument{ "A portable kernel must be the last one in a dispatch table" };
+			}
+		}
+
+		DispatchTable(const DispatchTable&) = delete;
+		DispatchTable& operator=(const DispatchTable&) = delete;
+
+		const Entry& Selected() const noexcept
+		{
+			std::uint64_t selection = _selection.load(std::memory_order_acquire);
+			std::uint32_t generation = Impl::FeaturesGeneration();
+			if (selection == NOT_SELECTED || static_cast<std::uint32_t>(selection >> 32) != generation)
+			{
+				// Concurrent callers may select simultaneously, but they select the same entry
+				std::size_t index = Select(Features::Current());
+				selection = (static_cast<std::uint64_t>(generation) << 32) | index;
+				_selection.store(selection, std::memory_order_release);
+			}
+			return _entries[static_cast<std::size_t>(selection & 0xFFFFFFFFU)];
+		}
+
+		const Kernel& operator*() const noexcept { return Selected().kernel; }
+		const Kernel* operator->() const noexcept { return &Selected().kernel; }
+
+		// Returns an index of the best entry for the features specified
+		std::size_t Select(Features available) const noexcept
+		{
+			for (std::size_t i = 0; i < _entries.size(); i++)
+			{
+				if (available.Supports(_entries[i].required))
+				{
+					return i;
+				}
+			}
+			return _entries.size() - 1;
+		}
+
+		const std::vector<Entry>& entries() const noexcept { return _entries; }
+
+	private:
+		static constexpr std::uint64_t NOT_SELECTED = ~std::uint64_t{};
+
+		std::vector<Entry> _entries;
+		// A generation of allowed features in the high half, an entry index in the low one
+		mutable std::atomic<std::uint64_t> _selection;
+	};
+}
+#endif // _CPUFEATURES_H_
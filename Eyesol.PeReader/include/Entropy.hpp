@@ -0,0 +1,81 @@
+#if !defined _ENTROPY_H_
+#	define _ENTROPY_H_
+#	include <array>
+#	include <cstdint>
+#	include <span>
+#	include <vector>
+#	include "framework.hpp"
+#	include "ErrorCodes.hpp"
+#	include "MemoryMappedIO.hpp"
+
+namespace Eyesol::Analysis
+{
+	constexpr std::size_t HISTOGRAM_BINS = 256;
+
+	// Counts of every byte value. Bytes are counted by SIMD kernels into several tables at once,
+	// see HistogramKernels.hpp, so long runs of a single byte don't stall on the same counter
+	class EYESOLPEREADER_API ByteHistogram
+	{
+	public:
+		ByteHistogram() noexcept;
+
+		void Add(std::span<const unsigned char> data) noexcept;
+		ByteHistogram& operator+=(const ByteHistogram& other) noexcept;
+		// The other histogram must be a part of this one
+		ByteHistogram& operator-=(const ByteHistogram& other) noexcept;
+		void Reset() noexcept;
+
+		std::uint64_t operator[](unsigned char value) const noexcept { return _counts[value]; }
+		const std::array<std::uint64_t, HISTOGRAM_BINS>& counts() const noexcept { return _counts; }
+		std::uint64_t total() const noexcept { return _total; }
+		bool empty() const noexcept { return _total == 0; }
+
+		// Shannon entropy in bits per byte, from 0 for a single repeated byte to 8 for uniform data.
+		// Packed and encrypted data is usually above 7
+		double entropy() const noexcept;
+
+	private:
+		std::array<std::uint64_t, HISTOGRAM_BINS> _counts;
+		std::uint64_t _total;
+	};
+
+	// Entropy of windows of step * windowSteps bytes, each one step after the previous.
+	// Every step is counted once into its own histogram, and a window is the sum of its steps,
+	// so data may be fed in pieces of any length, e.g. region by region, without being kept
+	class EYESOLPEREADER_API SlidingEntropy
+	{
+	public:
+		// Throws std::invalid_argument, if the step or the count of steps is zero
+		SlidingEntropy(std::size_t step, std::size_t windowSteps);
+
+		void Update(std::span<const unsigned char> data);
+
+		std::size_t step() const noexcept { return _step; }
+		std::size_t windowLength() const noexcept { return _step * _stepHistograms.size(); }
+
+		// Entropies of complete windows. The window i starts at i * step bytes from the start of the data.
+		// Data shorter than a window has no windows, its entropy is the one of its histogram
+		const std::vector<double>& entropies() const noexcept { return _entropies; }
+
+	private:
+		void CompleteStep();
+
+		std::size_t _step;
+		// A ring of histograms of the last steps of the window
+		std::vector<ByteHistogram> _stepHistograms;
+		std::size_t _nextStep;
+		std::size_t _completedSteps;
+		ByteHistogram _window;
+		// x * log2(x) for every count up to the window length, if it is short enough to be tabulated
+		std::vector<double> _entropyTerms;
+		std::vector<double> _entropies;
+	};
+
+	// Counts bytes of a file range region by region, as MemoryMappedFileIterator maps them.
+	// Returns ErrorCode::TruncatedData, if the range doesn't fit into the file
+	EYESOLPEREADER_API Result<ByteHistogram> ComputeHistogram(const MemoryMappedIO::MemoryMappedFile& file, std::uint64_t offset, std::uint64_t length);
+	EYESOLPEREADER_API Result<ByteHistogram> ComputeHistogram(const MemoryMappedIO::MemoryMappedFile& file);
+	// Sliding window entropies of a file range. Throws std::invalid_argument like SlidingEntropy
+	EYESOLPEREADER_API Result<std::vector<double>> ComputeSlidingEntropy(const MemoryMappedIO::MemoryMappedFile& file, std::uint64_t offset, std::uint64_t length, std::size_t step, std::size_t windowSteps);
+}
+#endif // _ENTROPY_H_
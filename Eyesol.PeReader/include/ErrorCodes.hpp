@@ -0,0 +1,114 @@
+#if !defined _ERROR_CODES_H_
+#	define _ERROR_CODES_H_
+#	include <exception>
+#	include "framework.hpp"
+#	include "Expected.hpp"
+
+namespace Eyesol
+{
+	// Groups of error codes, so they may be counted coarsely
+	enum class ErrorCategory
+	{
+		// An offset or a length points outside the file
+		Bounds,
+		// A structure contains invalid values
+		Format,
+		// The file is valid, but not supported
+		Unsupported,
+		// A failure not caused by the file contents
+		Internal,
+	};
+
+	constexpr std::size_t ERROR_CATEGORIES_COUNT = static_cast<std::size_t>(ErrorCategory::Internal) + 1;
+
+	// Reasons of rejecting malformed and unsupported files.
+	// Values are contiguous, so they may index arrays of counters
+	enum class ErrorCode
+	{
+		/* Bounds: */
+		// An offset is beyond the end of the file
+		OffsetOutOfRange,
+		// A structure or a range doesn't fit into the file
+		TruncatedData,
+		// A length is not representable on the host
+		LengthOverflow,
+		// An offset doesn't meet an alignment requirement
+		MisalignedOffset,
+		// DOS relocations table doesn't fit into the file
+		DosRelocationsOutOfFile,
+		// An RVA is outside of the image headers and sections
+		RvaOutOfImage,
+		// An RVA points to data, which the loader fills with zeros, so it has no file offset
+		RvaNotInFile,
+		// No export has the requested name or ordinal
+		ExportNotFound,
+		// No resource has the requested type, name or language
+		ResourceNotFound,
+		// The debug directory has no entry of the requested type
+		DebugInfoNotFound,
+		// A metadata token or a heap index points past its table or heap
+		TokenOutOfRange,
+		// No runtime function of the exception directory contains the address
+		FunctionNotFound,
+
+		/* Format: */
+		// The DOS header doesn't describe a DOS executable
+		BadDosHeader,
+		// The "Rich" header is found, but it is inconsistent
+		BadRichHeader,
+		// The PE optional header has an unknown magic, or is too short
+		BadOptionalHeader,
+		// An import descriptor or an import lookup table entry is invalid
+		BadImportDirectory,
+		// The export directory table or its tables are invalid
+		BadExportDirectory,
+		// A resource directory table or entry is invalid
+		BadResourceDirectory,
+		// The resource tree is cyclic, or exceeds the depth or the budget of a walk
+		ResourceLimitExceeded,
+		// The version resource has invalid block lengths or no VS_VERSION_INFO root
+		BadVersionInfo,
+		// A base relocation block has an invalid length
+		BadRelocationDirectory,
+		// A debug directory entry or its data, e.g. a CodeView record, is invalid
+		BadDebugDirectory,
+		// The CLR header, the metadata root, its streams or tables are invalid
+		BadClrMetadata,
+		// Exception directory entries are not sorted, or unwind data is invalid
+		BadExceptionDirectory,
+
+		/* Unsupported: */
+		// No parser recognizes the file
+		UnknownFormat,
+		// The format is recognized, but its parsing is not implemented yet
+		NotImplemented,
+		// A base relocation type is machine-specific and is not applied
+		UnsupportedRelocation,
+
+		/* Internal: */
+		// The MemoryMappedFile object is empty
+		EmptyObject,
+		// Memory cannot be allocated or the address space is exhausted
+		OutOfMemory,
+		// A parser, which doesn't report error codes, has thrown an exception
+		UnclassifiedException,
+	};
+
+	constexpr std::size_t ERROR_CODES_COUNT = static_cast<std::size_t>(ErrorCode::UnclassifiedException) + 1;
+
+	// A value or an error code
+	template <typename T>
+	using Result = Expected<T, ErrorCode>;
+
+	EYESOLPEREADER_API ErrorCategory CategoryOf(ErrorCode code) noexcept;
+
+	EYESOLPEREADER_API const char* ToString(ErrorCode code) noexcept;
+	EYESOLPEREADER_API const char* ToString(ErrorCategory category) noexcept;
+
+	// Converts an error code to an exception for APIs reporting errors by exceptions.
+	// Bounds errors become std::out_of_range, NotImplemented - NotImplementedException,
+	// and the others - std::runtime_error
+	EYESOLPEREADER_API std::exception_ptr MakeExceptionPtr(ErrorCode code);
+	[[noreturn]] EYESOLPEREADER_API void ThrowError(ErrorCode code);
+}
+#endif
@@ -1,11 +1,13 @@
 #if !defined _EXECUTABLE_H_
 #	define _EXECUTABLE_H_
+#	include <array>
 #	include <set>
 #	include <exception>
 #	include "framework.hpp"
 #	include "Arch.hpp"
 #	include "Compiler.hpp"
 #	include "MemoryMappedIO.hpp"
+#	include "ErrorCodes.hpp"
 
 namespace Eyesol::Executables
 {
@@ -63,9 +65,59 @@ namespace Eyesol::Executables
 		PortablePdb
 	};
 
+	// A format signature at the beginning of a file
+	enum class ExecutableMagic
+	{
+		Unknown,
+		// "MZ". DOS and all its derivatives, PE among them
+		Mz,
+		// "\x7F" "ELF"
+		Elf,
+		// FEEDFACE or FEEDFACF in either byte order
+		MachO,
+		// CAFEBABE with a small architectures count, or CAFEBABF
+		MachOFat,
+		// "!<arch>\n". Unix and COFF static libraries
+		UnixArchive,
+		// CAFEBABE with a class file version
+		JavaClass,
+		// "PK". JAR and other ZIP-based archives
+		Zip,
+	};
+
+	constexpr std::size_t EXECUTABLE_MAGICS_COUNT = static_cast<std::size_t>(ExecutableMagic::Zip) + 1;
+
+	// The beginning of a file, mapped once and shared by all parsers probing the file.
+	// It covers the same view as the first read of the file, so parsers don't map anything new
+	class EYESOLPEREADER_API ExecutableProbe
+	{
+	public:
+		explicit ExecutableProbe(const Eyesol::MemoryMappedIO::MemoryMappedFile& file);
+
+		// At most an allocation granularity long
+		std::span<const unsigned char> bytes() const noexcept { return _bytes; }
+		ExecutableMagic magic() const noexcept { return _magic; }
+
+		static ExecutableMagic DetectMagic(std::span<const unsigned char> bytes) noexcept;
+
+	private:
+		Eyesol::MemoryMappedIO::MemoryMappedFileRegion _region;
+		std::span<const unsigned char> _bytes;
+		ExecutableMagic _magic;
+	};
+
+	// A state of a parser, passed from format probing to parsing
+	// so the parser doesn't read the same data twice
+	struct EYESOLPEREADER_API ExecutableParseContext
+	{
+		virtual ~ExecutableParseContext();
+	};
+
 	class EYESOLPEREADER_API DebugInfo
 	{
 	public:
+		virtual ~DebugInfo() noexcept;
+
 		virtual DebugInfoType type() const = 0;
 	};
 
@@ -103,6 +155,23 @@ namespace Eyesol::Executables
 
 		virtual bool IsTypeSupported(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, ExecutableObjectFormat* format, ExecutableType* type) const = 0;
 		virtual std::shared_ptr<Executable> TryParse(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::exception_ptr* excPtr) const = 0;
+
+		// Magics of files the parser may accept. A parser with no magics is probed for any file
+		virtual std::vector<ExecutableMagic> SupportedMagics() const;
+		// Like IsTypeSupported, but reads the beginning of the file from the probe,
+		// and returns ErrorCode::UnknownFormat for files of other formats.
+		// If ctx is not null, it may receive a context to pass into TryParseProbed
+		virtual Result<void> ProbeType(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext>* ctx, ExecutableObjectFormat* format, ExecutableType* type) const;
+		// Like TryParse, but continues from the probe and the context returned by ProbeType, if any.
+		// Malformed files are reported by error codes, only failures of the system throw
+		virtual Result<std::shared_ptr<Executable>> TryParseProbed(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext> ctx) const;
+
+		// A non-throwing TryParse. Returns the reason of rejecting the file instead of an exception
+		Result<std::shared_ptr<Executable>> TryParseNoThrow(const Eyesol::MemoryMappedIO::MemoryMappedFile& file) const;
+
+	protected:
+		// Converts a result to the TryParse convention: files of other formats are not errors
+		static std::shared_ptr<Executable> FromResult(Result<std::shared_ptr<Executable>> result, std::exception_ptr* excPtr);
 	};
 
 	class EYESOLPEREADER_API CompoundExecutableParser : public ExecutableParser
@@ -115,12 +184,19 @@ namespace Eyesol::Executables
 		bool IsTypeSupported(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, ExecutableObjectFormat* format, ExecutableType* type) const;
 		std::shared_ptr<Executable> TryParse(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::exception_ptr* excPtr) const;
 
+		std::vector<ExecutableMagic> SupportedMagics() const;
+		Result<void> ProbeType(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext>* ctx, ExecutableObjectFormat* format, ExecutableType* type) const;
+		Result<std::shared_ptr<Executable>> TryParseProbed(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext> ctx) const;
+
 	private:
 		std::vector<std::shared_ptr<ExecutableParser>> _orderedParsers;
+		// Parsers to probe for every magic, in the original order
+		std::array<std::vector<const ExecutableParser*>, EXECUTABLE_MAGICS_COUNT> _parsersByMagic;
 
 		std::vector<std::string> _supportedFormatNames;
 
-		const std::shared_ptr<ExecutableParser>* FindSuitableParser(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, ExecutableObjectFormat* format, ExecutableType* type) const;
+		// If no parser accepts the file, returns the first error other than ErrorCode::UnknownFormat, if any
+		Result<const ExecutableParser*> FindSuitableParser(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext>* ctx, ExecutableObjectFormat* format, ExecutableType* type) const;
 	};
 
 	// Used for parsers of extendable executable formats
@@ -0,0 +1,150 @@
+#if !defined _EXPECTED_H_
+#	define _EXPECTED_H_
+#	include <exception>
+#	include <optional>
+#	include <variant>
+#	include "framework.hpp"
+
+namespace Eyesol
+{
+	// A subset of C++23 std::expected. Replace with it, when the project moves to C++23
+
+	template <typename E>
+	class Unexpected
+	{
+	public:
+		constexpr explicit Unexpected(E error) noexcept(std::is_nothrow_move_constructible_v<E>)
+			: _error{ std::move(error) }
+		{
+		}
+
+		constexpr const E& error() const noexcept { return _error; }
+
+	private:
+		E _error;
+	};
+
+	// Thrown by Expected::value() if the object holds an error
+	template <typename E>
+	class BadExpectedAccess : public std::exception
+	{
+	public:
+		explicit BadExpectedAccess(E error)
+			: _error{ std::move(error) }
+		{
+		}
+
+		const E& error() const noexcept { return _error; }
+
+		const char* what() const noexcept override
+		{
+			return "Access to the value of an Expected object holding an error";
+		}
+
+	private:
+		E _error;
+	};
+
+	// Holds either a value or an error. Errors are returned instead of being thrown
+	template <typename T, typename E>
+	class Expected
+	{
+	public:
+		constexpr Expected()
+			requires std::is_default_constructible_v<T>
+			: _storage{ std::in_place_index<0> }
+		{
+		}
+
+		constexpr Expected(T value)
+			: _storage{ std::in_place_index<0>, std::move(value) }
+		{
+		}
+
+		constexpr Expected(Unexpected<E> error)
+			: _storage{ std::in_place_index<1>, error.error() }
+		{
+		}
+
+		constexpr bool has_value() const noexcept { return _storage.index() == 0; }
+		constexpr explicit operator bool() const noexcept { return has_value(); }
+
+		constexpr T& value() &
+		{
+			CheckValue();
+			return *std::get_if<0>(&_storage);
+		}
+
+		constexpr const T& value() const&
+		{
+			CheckValue();
+			return *std::get_if<0>(&_storage);
+		}
+
+		constexpr T&& value() &&
+		{
+			CheckValue();
+			return std::move(*std::get_if<0>(&_storage));
+		}
+
+		// The behaviour is undefined if the object holds an error
+		constexpr T& operator*() & noexcept { return *std::get_if<0>(&_storage); }
+		constexpr const T& operator*() const& noexcept { return *std::get_if<0>(&_storage); }
+		constexpr T&& operator*() && noexcept { return std::move(*std::get_if<0>(&_storage)); }
+		constexpr T* operator->() noexcept { return std::get_if<0>(&_storage); }
+		constexpr const T* operator->() const noexcept { return std::get_if<0>(&_storage); }
+
+		// The behaviour is undefined if the object holds a value
+		constexpr const E& error() const noexcept { return *std::get_if<1>(&_storage); }
+
+		template <typename U>
+		constexpr T value_or(U&& defaultValue) const&
+		{
+			return has_value() ? **this : static_cast<T>(std::forward<U>(defaultValue));
+		}
+
+	private:
+		std::variant<T, E> _storage;
+
+		constexpr void CheckValue() const
+		{
+			if (!has_value())
+			{
+				throw BadExpectedAccess<E>{ error() };
+			}
+		}
+	};
+
+	// A status of an operation without a result
+	template <typename E>
+	class Expected<void, E>
+	{
+	public:
+		constexpr Expected() noexcept
+		{
+		}
+
+		constexpr Expected(Unexpected<E> error)
+			: _error{ error.error() }
+		{
+		}
+
+		constexpr bool has_value() const noexcept { return !_error.has_value(); }
+		constexpr explicit operator bool() const noexcept { return has_value(); }
+
+		constexpr void value() const
+		{
+			if (!has_value())
+			{
+				throw BadExpectedAccess<E>{ error() };
+			}
+		}
+
+		// The behaviour is undefined if the object holds no error
+		constexpr const E& error() const noexcept { return *_error; }
+
+	private:
+		std::optional<E> _error;
+	};
+}
+#endif
@@ -0,0 +1,118 @@
+#if !defined _HASHING_H_
+#	define _HASHING_H_
+#	include <array>
+#	include <functional>
+#	include <span>
+#	include <string>
+#	include <string_view>
+#	include <vector>
+#	include "framework.hpp"
+#	include "ErrorCodes.hpp"
+
+namespace Eyesol::Hashing
+{
+	// Incremental MD5. Used for fingerprints like imphash, not for security
+	class EYESOLPEREADER_API Md5
+	{
+	public:
+		static constexpr std::size_t DIGEST_LENGTH = 16;
+		static constexpr std::size_t BLOCK_LENGTH = 64;
+		using Digest = std::array<std::uint8_t, DIGEST_LENGTH>;
+
+		Md5() noexcept;
+
+		void Update(std::span<const unsigned char> data) noexcept;
+		void Update(std::string_view str) noexcept;
+		// Pads the message and returns the digest. The object must be reset before reuse
+		Digest Final() noexcept;
+		void Reset() noexcept;
+
+	private:
+		void ProcessBlock(const unsigned char* block) noexcept;
+
+		std::array<std::uint32_t, 4> _state;
+		std::uint64_t _length;
+		std::array<unsigned char, BLOCK_LENGTH> _buffer;
+	};
+
+	enum class HashAlgorithm
+	{
+		Sha1,
+		Sha256,
+	};
+
+	EYESOLPEREADER_API std::size_t DigestLength(HashAlgorithm algorithm) noexcept;
+
+	// Incremental SHA-1. Blocks are compressed by SHA-NI or ARMv8 crypto instructions, if the CPU has them
+	class EYESOLPEREADER_API Sha1
+	{
+	public:
+		static constexpr std::size_t DIGEST_LENGTH = 20;
+		static constexpr std::size_t BLOCK_LENGTH = 64;
+		using Digest = std::array<std::uint8_t, DIGEST_LENGTH>;
+
+		Sha1() noexcept;
+
+		void Update(std::span<const unsigned char> data) noexcept;
+		void Update(std::string_view str) noexcept;
+		// Pads the message and returns the digest. The object must be reset before reuse
+		Digest Final() noexcept;
+		void Reset() noexcept;
+
+	private:
+		std::array<std::uint32_t, 5> _state;
+		std::uint64_t _length;
+		std::array<unsigned char, BLOCK_LENGTH> _buffer;
+	};
+
+	// Incremental SHA-256. Blocks are compressed by SHA-NI or ARMv8 crypto instructions, if the CPU has them
+	class EYESOLPEREADER_API Sha256
+	{
+	public:
+		static constexpr std::size_t DIGEST_LENGTH = 32;
+		static constexpr std::size_t BLOCK_LENGTH = 64;
+		using Digest = std::array<std::uint8_t, DIGEST_LENGTH>;
+
+		Sha256() noexcept;
+
+		void Update(std::span<const unsigned char> data) noexcept;
+		void Update(std::string_view str) noexcept;
+		// Pads the message and returns the digest. The object must be reset before reuse
+		Digest Final() noexcept;
+		void Reset() noexcept;
+
+	private:
+		std::array<std::uint32_t, 8> _state;
+		std::uint64_t _length;
+		std::array<unsigned char, BLOCK_LENGTH> _buffer;
+	};
+
+	// Hashes several messages at once on the calling thread. Every message occupies a lane
+	// of the widest kernel available, e.g. one of 8 lanes of AVX2 registers, and a finished message
+	// yields its lane to the next one. Single-lane kernels hash the messages one by one.
+	// Messages are pulled piece by piece, and whole blocks are hashed in place
+	class EYESOLPEREADER_API MultiBufferHasher
+	{
+	public:
+		// Returns the next piece of a message, or an empty span at its end.
+		// A piece must stay valid until the next call of the reader
+		using Reader = std::function<Result<std::span<const unsigned char>>()>;
+		// A digest of a message, or an error returned by its reader
+		using Digest = Result<std::vector<std::uint8_t>>;
+
+		explicit MultiBufferHasher(HashAlgorithm algorithm) noexcept;
+
+		// A count of messages hashed at once by the kernel selected for the CPU
+		std::size_t lanes() const noexcept;
+
+		// Digests are in the order of the readers
+		std::vector<Digest> Hash(std::span<Reader> readers) const;
+
+	private:
+		HashAlgorithm _algorithm;
+	};
+
+	// Lowercase hexadecimal digits, as printed by hashing tools
+	EYESOLPEREADER_API std::string ToHexString(std::span<const std::uint8_t> digest);
+}
+#endif
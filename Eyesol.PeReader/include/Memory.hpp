@@ -1,5 +1,6 @@
 #if !defined _MEMORY_H_
 #	define _MEMORY_H_
+#	include <concepts>
 #	include <framework.hpp>
 
 namespace Eyesol::Memory
@@ -31,6 +32,21 @@ namespace Eyesol::Memory
 		{ t[std::declval<std::size_t>()] } -> IsAnyChar;
 	};
 
+	// std::byteswap is available since C++23 only.
+	// Compilers recognize the pattern and emit a single instruction
+	template <std::integral T>
+	constexpr T ByteSwap(T value) noexcept
+	{
+		using UnsignedType = std::make_unsigned_t<T>;
+		UnsignedType source = static_cast<UnsignedType>(value);
+		UnsignedType result{};
+		for (std::size_t i = 0; i < sizeof(T); i++)
+		{
+			result = static_cast<UnsignedType>((result << 8) | ((source >> (i * 8)) & 0xFFU));
+		}
+		return static_cast<T>(result);
+	}
+
 	template <std::endian DataEndianness, PrimitiveType T>
 	void Read(const void* ptr, T& obj)
 	{
@@ -38,6 +54,11 @@ namespace Eyesol::Memory
 		{
 			obj = *reinterpret_cast<const T*>(ptr);
 		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			std::memcpy(&obj, ptr, sizeof(T));
+			obj = ByteSwap(obj);
+		}
 		else
 		{
 			char* dataPtr = reinterpret_cast<char*>(&obj);
@@ -91,11 +112,11 @@ namespace Eyesol::Memory
 	{
 		if constexpr (DataEndianness == std::endian::native)
 		{
-			if constexpr (UnalignedAccessAllowed)
+			if constexpr (UnalignedAccessAllowed && Compiler::CurrentCompiler == Compiler::CompilerType::MSVC)
 			{
 				// unaligned access allowed
 				// actually an undefined behavior if unaligned, according to a standard.
-				// but in this case, it always should work
+				// but MSVC doesn't assume alignment or strict aliasing, so it always should work
 				obj = *reinterpret_cast<const T*>(ptr);
 			}
 			else
@@ -103,6 +124,11 @@ namespace Eyesol::Memory
 				std::memcpy(&obj, ptr, sizeof(T));
 			}
 		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			std::memcpy(&obj, ptr, sizeof(T));
+			obj = ByteSwap(obj);
+		}
 		else
 		{
 			char* dataPtr = reinterpret_cast<char*>(&obj);
@@ -114,6 +140,29 @@ namespace Eyesol::Memory
 		}
 	}
 
+	template <std::endian DataEndianness, PrimitiveType T>
+	void UnalignedWrite(void* ptr, T obj)
+	{
+		if constexpr (DataEndianness == std::endian::native)
+		{
+			std::memcpy(ptr, &obj, sizeof(T));
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			obj = ByteSwap(obj);
+			std::memcpy(ptr, &obj, sizeof(T));
+		}
+		else
+		{
+			const char* dataPtr = reinterpret_cast<const char*>(&obj);
+			char* bufPtr = reinterpret_cast<char*>(ptr);
+			for (std::size_t i = 0; i < sizeof(T); i++)
+			{
+				bufPtr[i] = dataPtr[sizeof(T) - i - 1];
+			}
+		}
+	}
+
 	template <PrimitiveType T>
 	void UnalignedRead(const void* ptr, std::endian dataEndianness, T& obj)
 	{
@@ -126,5 +175,133 @@ namespace Eyesol::Memory
 			return UnalignedRead<std::endian::big, T>(ptr, obj);
 		}
 	}
+
+	namespace Impl
+	{
+		template <typename T>
+		constexpr void SwapFieldByteOrder(T& field) noexcept
+		{
+			if constexpr (std::is_array_v<T>)
+			{
+				for (auto&& element : field)
+				{
+					SwapFieldByteOrder(element);
+				}
+			}
+			else if constexpr (std::is_class_v<T>)
+			{
+				// A nested structure is swapped by its own layout, found by ADL like the outer one
+				decltype(DescribeLayout(static_cast<const T*>(nullptr)))::SwapByteOrder(field);
+			}
+			else
+			{
+				static_assert(std::is_integral_v<T>, "Only integral fields, described structures and arrays of them are supported");
+				if constexpr (sizeof(T) > 1)
+				{
+					field = ByteSwap(field);
+				}
+			}
+		}
+
+		template <typename MemberPointer>
+		struct MemberPointerTraits;
+
+		template <typename Struct, typename Member>
+		struct MemberPointerTraits<Member Struct::*>
+		{
+			using StructType = Struct;
+			using MemberType = Member;
+		};
+	}
+
+	// Describes fields of a POD structure, which may be stored with a non-native byte order.
+	// A structure is described by a DescribeLayout(const Struct*) function found by ADL,
+	// which returns StructLayout<Struct, &Struct::field1, &Struct::field2, ...>.
+	// Fields are integers, described structures or arrays of them
+	template <typename Struct, auto... Members>
+	struct StructLayout
+	{
+		static_assert((std::is_same_v<typename Impl::MemberPointerTraits<decltype(Members)>::StructType, Struct> && ...),
+			"All fields must belong to the structure");
+		static_assert((sizeof(typename Impl::MemberPointerTraits<decltype(Members)>::MemberType) + ...) == sizeof(Struct),
+			"Fields must cover the whole structure, and the structure must have no padding");
+
+		// Reverses byte order of every multi-byte field. Single-byte fields are untouched
+		static constexpr void SwapByteOrder(Struct& obj) noexcept
+		{
+			(Impl::SwapFieldByteOrder(obj.*Members), ...);
+		}
+	};
+
+	template <typename T>
+	concept DescribedStruct = PrimitiveType<T> && requires(const T* ptr)
+	{
+		DescribeLayout(ptr);
+	};
+
+	template <DescribedStruct T>
+	using StructLayoutOf = decltype(DescribeLayout(std::declval<const T*>()));
+
+	// Decodes a structure with a single copy, then swaps multi-byte fields if the byte order differs
+	template <std::endian DataEndianness, DescribedStruct T>
+	void ReadStruct(const void* ptr, T& obj) noexcept
+	{
+		std::memcpy(&obj, ptr, sizeof(T));
+		if constexpr (DataEndianness != std::endian::native)
+		{
+			StructLayoutOf<T>::SwapByteOrder(obj);
+		}
+	}
+
+	namespace Impl
+	{
+		// Copies count elements of elementSize (1, 2, 4 or 8) bytes, reversing byte order of each one.
+		// Uses the widest vector instructions supported by the CPU.
+		// src and dst may be equal, but must not partially overlap
+		EYESOLPEREADER_API void ByteSwapArray(const void* src, void* dst, std::size_t count, std::size_t elementSize);
+
+		// Returns a sum of little endian 16-bit words modulo 2^16, as used by the MZ checksum.
+		// A trailing odd byte is zero-extended. Uses the widest vector instructions supported by the CPU
+		EYESOLPEREADER_API std::uint16_t LittleEndianWordSum(const void* data, std::size_t length) noexcept;
+		// Returns a ones' complement sum of little endian 16-bit words, as used by the PE checksum:
+		// carries out of the low 16 bits are added back. Sums of parts starting at even offsets
+		// are combined by FoldCarries of their sum. A trailing odd byte is zero-extended
+		EYESOLPEREADER_API std::uint16_t LittleEndianOnesComplementSum(const void* data, std::size_t length) noexcept;
+
+		// Adds the carries out of the low 16 bits back, until there are none
+		constexpr std::uint16_t FoldCarries(std::uint64_t sum) noexcept
+		{
+			while ((sum >> 16) != 0)
+			{
+				sum = (sum & 0xFFFF) + (sum >> 16);
+			}
+			return static_cast<std::uint16_t>(sum);
+		}
+
+		// Returns an index of the last of count dwords, which is equal to the pattern, or count if there is none.
+		// Dwords are compared as they are stored in memory, so the pattern must be in the data byte order
+		EYESOLPEREADER_API std::size_t FindLastDword(const void* data, std::size_t count, std::uint32_t pattern) noexcept;
+		// XORs count dwords with the key, stored in the data byte order.
+		// src and dst may be equal, but must not partially overlap
+		EYESOLPEREADER_API void XorDwords(const void* src, void* dst, std::size_t count, std::uint32_t key) noexcept;
+	}
+
+	// Decodes an array of integers. Unlike element-wise Read, converts non-native byte order
+	// in bulk. Neither pointer has to be aligned. Decoding in place is allowed
+	template <std::endian DataEndianness, std::integral T>
+	void ReadArray(const void* ptr, T* arr, std::size_t count)
+	{
+		if constexpr (DataEndianness == std::endian::native || sizeof(T) == 1)
+		{
+			if (ptr != arr)
+			{
+				std::memmove(arr, ptr, count * sizeof(T));
+			}
+		}
+		else
+		{
+			Impl::ByteSwapArray(ptr, arr, count, sizeof(T));
+		}
+	}
 }
 #endif // _MEMORY_H_
\ No newline at end of file
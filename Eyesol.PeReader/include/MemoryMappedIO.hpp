@@ -1,7 +1,10 @@
 #if !defined _MEMORYMAPPEDIO_H_
 #	define _MEMORYMAPPEDIO_H_
 #	include <framework.hpp>
+#	include <iterator>
+#	include <span>
 #	include "Memory.hpp"
+#	include "ErrorCodes.hpp"
 
 namespace Eyesol::MemoryMappedIO
 {
@@ -9,10 +12,41 @@ namespace Eyesol::MemoryMappedIO
 	class MemoryMappedFileRegion;
 	class MemoryMappedFileIterator;
 
+	enum class MappingMode
+	{
+		// WholeFile for files not longer than WholeFileMappingThreshold, Windowed otherwise
+		Auto,
+		// Every region is mapped as a separate view aligned to an allocation granularity
+		Windowed,
+		// The whole file is mapped once, and all regions point into that single view
+		WholeFile
+	};
+
+	// A maximum file length mapped as a single view in MappingMode::Auto.
+	// 32-bit hosts are limited by their address space, so only small files are mapped there
+	constexpr std::uint64_t WholeFileMappingThreshold
+		= sizeof(void*) >= sizeof(std::uint64_t)
+		? 4ULL * 1024 * 1024 * 1024 // 4 GiB
+		: 16ULL * 1024 * 1024; // 16 MiB
+
+	// Counters of a view cache shared by all copies of a MemoryMappedFile
+	struct ViewCacheStatistics
+	{
+		// Regions served by an already mapped view
+		std::uint64_t hits;
+		// Regions which required a new view to be mapped
+		std::uint64_t misses;
+		// Views dropped from the cache to respect its capacity
+		std::uint64_t evictions;
+		// Maximum count of views kept mapped by the cache
+		std::size_t capacity;
+	};
+
 	namespace Impl
 	{
 		class MemoryMappedFileImpl;
 		class MemoryMappedFileRegionImpl;
+		class ViewCache;
 
 		const ::std::shared_ptr<MemoryMappedFileImpl>& get_impl(const MemoryMappedFile&);
 		const ::std::shared_ptr<MemoryMappedFileRegionImpl>& get_impl(const MemoryMappedFileRegion&);
@@ -32,9 +66,21 @@ namespace Eyesol::MemoryMappedIO
 			std::size_t* offsetInRegionPtr // Starting offset in the region
 		); // returns granularity
 
-		::std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::string str, std::uint64_t& fileLength);
-		::std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::wstring str, std::uint64_t& fileLength);
-		::std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::u16string str, std::uint64_t& fileLength);
+		// Same as above, but returns ErrorCode::OffsetOutOfRange instead of throwing
+		Result<std::size_t> TryCalculateMapRegionParameters(
+			std::uint64_t absoluteOffset,
+			std::uint64_t fileLength,
+			std::uint64_t* baseOffsetPtr,
+			std::size_t* regionLengthPtr,
+			std::size_t* offsetInRegionPtr
+		) noexcept;
+
+		// Resolves MappingMode::Auto to a concrete mode
+		MappingMode ResolveMappingMode(MappingMode mode, std::uint64_t fileLength) noexcept;
+
+		::std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::string str, std::uint64_t& fileLength, MappingMode mode);
+		::std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::wstring str, std::uint64_t& fileLength, MappingMode mode);
+		::std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::u16string str, std::uint64_t& fileLength, MappingMode mode);
 
 		// May throw exceptions std::out_of_range and std::runtime_error
 		::std::shared_ptr<MemoryMappedFileRegionImpl> MapRegion(const std::shared_ptr<Impl::MemoryMappedFileImpl>& fileHandle, std::uint64_t offset, std::uint64_t length);
@@ -44,6 +90,18 @@ namespace Eyesol::MemoryMappedIO
 
 		std::uint64_t GetFileLength(const MemoryMappedFileImpl&);
 		std::string GetFilePath(const MemoryMappedFileImpl&);
+		// Returns nullptr if the file is not mapped as a single view
+		const unsigned char* GetWholeFileView(const MemoryMappedFileImpl&);
+		ViewCache& GetViewCache(const MemoryMappedFileImpl&);
+
+		// Writable pages, released when the last reference is released
+		using PrivatePages = std::shared_ptr<unsigned char>;
+		// Reserves zero-filled pages, which the system commits on first access. Returns nullptr on failure
+		PrivatePages AllocatePrivatePages(std::size_t length);
+		// Replaces the pages at the address with a copy-on-write view of the file.
+		// Returns false if the platform can't place a view at a given address, so the pages are left as they were,
+		// and ErrorCode::OutOfMemory if the pages were released and could not be restored
+		Result<bool> MapFilePagesAt(const MemoryMappedFileImpl& file, const PrivatePages& pages, std::size_t pagesOffset, std::uint64_t offset, std::size_t length);
 	}
 
 	//class MemoryMappedFileImpl;
@@ -91,13 +149,169 @@ namespace Eyesol::MemoryMappedIO
 		std::size_t _length;
 	};
 
+	// A typed view of a mapped file part in the native data layout.
+	// Keeps the underlying region mapped while the object is alive
+	template <Memory::PrimitiveType T>
+	class MemoryMappedSpan
+	{
+	public:
+		MemoryMappedSpan() noexcept = default;
+
+		MemoryMappedSpan(MemoryMappedFileRegion region, const T* data, std::size_t count) noexcept
+			: _region{ std::move(region) },
+			_span{ data, count }
+		{
+		}
+
+		std::span<const T> span() const noexcept { return _span; }
+		operator std::span<const T>() const noexcept { return _span; }
+
+		const T* data() const noexcept { return _span.data(); }
+		std::size_t size() const noexcept { return _span.size(); }
+		bool empty() const noexcept { return _span.empty(); }
+
+		auto begin() const noexcept { return _span.begin(); }
+		auto end() const noexcept { return _span.end(); }
+
+		const T& operator[](std::size_t index) const { return _span[index]; }
+
+		const T& at(std::size_t index) const
+		{
+			if (index >= _span.size())
+			{
+				throw std::out_of_range{ "Invalid index in the view" };
+			}
+			return _span[index];
+		}
+
+	private:
+		MemoryMappedFileRegion _region;
+		std::span<const T> _span;
+	};
+
+	// A typed view of a mapped file part stored with the given endianness.
+	// Elements are decoded on access, so neither alignment nor byte order matter.
+	// Structures must be described (see Memory::StructLayout) to have their fields decoded.
+	// Keeps the underlying region mapped while the object is alive
+	template <std::endian DataEndianness, Memory::PrimitiveType T>
+	class MemoryMappedRange
+	{
+	public:
+		class Iterator
+		{
+		public:
+			using iterator_concept = std::random_access_iterator_tag;
+			using iterator_category = std::input_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using reference = T;
+
+			Iterator() noexcept
+				: _ptr{ nullptr }
+			{
+			}
+
+			explicit Iterator(const unsigned char* ptr) noexcept
+				: _ptr{ ptr }
+			{
+			}
+
+			T operator*() const { return Decode(_ptr); }
+
+			T operator[](difference_type n) const { return *(*this + n); }
+
+			Iterator& operator++() noexcept { _ptr += sizeof(T); return *this; }
+			Iterator operator++(int) noexcept { Iterator old{ *this }; ++*this; return old; }
+			Iterator& operator--() noexcept { _ptr -= sizeof(T); return *this; }
+			Iterator operator--(int) noexcept { Iterator old{ *this }; --*this; return old; }
+
+			Iterator& operator+=(difference_type n) noexcept { _ptr += n * static_cast<difference_type>(sizeof(T)); return *this; }
+			Iterator& operator-=(difference_type n) noexcept { _ptr -= n * static_cast<difference_type>(sizeof(T)); return *this; }
+
+			friend Iterator operator+(Iterator it, difference_type n) noexcept { return it += n; }
+			friend Iterator operator+(difference_type n, Iterator it) noexcept { return it += n; }
+			friend Iterator operator-(Iterator it, difference_type n) noexcept { return it -= n; }
+
+			friend difference_type operator-(const Iterator& left, const Iterator& right) noexcept
+			{
+				return (left._ptr - right._ptr) / static_cast<difference_type>(sizeof(T));
+			}
+
+			bool operator==(const Iterator& other) const noexcept = default;
+			auto operator<=>(const Iterator& other) const noexcept = default;
+
+		private:
+			const unsigned char* _ptr;
+		};
+
+		MemoryMappedRange() noexcept
+			: _data{ nullptr },
+			_count{}
+		{
+		}
+
+		MemoryMappedRange(MemoryMappedFileRegion region, const unsigned char* data, std::size_t count) noexcept
+			: _region{ std::move(region) },
+			_data{ data },
+			_count{ count }
+		{
+		}
+
+		std::size_t size() const noexcept { return _count; }
+		bool empty() const noexcept { return _count == 0; }
+
+		Iterator begin() const noexcept { return Iterator{ _data }; }
+		Iterator end() const noexcept { return Iterator{ _data + _count * sizeof(T) }; }
+
+		T operator[](std::size_t index) const { return Decode(_data + index * sizeof(T)); }
+
+		T at(std::size_t index) const
+		{
+			if (index >= _count)
+			{
+				throw std::out_of_range{ "Invalid index in the view" };
+			}
+			return (*this)[index];
+		}
+
+		// Raw bytes of the range, in the file byte order
+		std::span<const unsigned char> bytes() const noexcept { return { _data, _count * sizeof(T) }; }
+
+		// Decodes the whole range at once, which is much faster than decoding element by element.
+		// arr must have room for size() elements
+		void CopyTo(T* arr) const requires std::integral<T>
+		{
+			Memory::ReadArray<DataEndianness>(_data, arr, _count);
+		}
+
+	private:
+		MemoryMappedFileRegion _region;
+		const unsigned char* _data;
+		std::size_t _count;
+
+		// Described structures are decoded field by field, other types as a whole
+		static T Decode(const unsigned char* ptr)
+		{
+			T obj;
+			if constexpr (Memory::DescribedStruct<T>)
+			{
+				Memory::ReadStruct<DataEndianness>(ptr, obj);
+			}
+			else
+			{
+				Memory::UnalignedRead<DataEndianness>(ptr, obj);
+			}
+			return obj;
+		}
+	};
+
 	class EYESOLPEREADER_API MemoryMappedFile
 	{
 	public:
 		MemoryMappedFile() noexcept;
-		MemoryMappedFile(std::string path);
-		MemoryMappedFile(std::wstring path);
-		MemoryMappedFile(std::u16string path);
+		MemoryMappedFile(std::string path, MappingMode mode = MappingMode::Auto);
+		MemoryMappedFile(std::wstring path, MappingMode mode = MappingMode::Auto);
+		MemoryMappedFile(std::u16string path, MappingMode mode = MappingMode::Auto);
 		MemoryMappedFile(const MemoryMappedFile&);
 		MemoryMappedFile(MemoryMappedFile&&) noexcept;
 
@@ -115,6 +329,16 @@ namespace Eyesol::MemoryMappedIO
 
 		bool empty() const { return _length == 0; }
 
+		// True if the whole file is mapped as a single view,
+		// so reads and regions don't create new views
+		bool IsWholeFileMapped() const noexcept { return _wholeFileView != nullptr; }
+
+		// Views mapped in the windowed mode are cached per file,
+		// and the cache is shared by all copies of the object, its iterators and regions
+		ViewCacheStatistics GetViewCacheStatistics() const;
+		// Sets a maximum count of views kept mapped by the cache. Zero disables caching
+		void SetViewCacheCapacity(std::size_t viewsCount);
+
 		std::string path() const;
 
 		MemoryMappedFileIterator begin() const;
@@ -137,18 +361,161 @@ namespace Eyesol::MemoryMappedIO
 			//Read(reinterpret_cast<unsigned char*>(&obj), sizeof(T), fileOffset, 0, sizeof(T));
 		}
 
+		// Reads a described structure with a single copy, swapping its multi-byte fields if needed.
+		// May throw std::out_of_range if the structure doesn't fit into the file
+		template <std::endian DataEndianness, Memory::DescribedStruct T>
+		void ReadStruct(T& obj, std::uint64_t fileOffset) const
+		{
+			Result<T> result = TryReadStruct<DataEndianness, T>(fileOffset);
+			if (!result)
+			{
+				ThrowError(result.error());
+			}
+			obj = *result;
+		}
+
+		/* Non-throwing reads. Malformed offsets are reported by error codes, so scanning
+		   broken files doesn't unwind. Failures of the system, like a failed mapping, still throw */
+
+		// Same as Read, but returns an error instead of throwing
+		[[nodiscard]] Result<std::size_t> TryRead(unsigned char* buf, std::size_t bufLength, std::uint64_t fileOffset, std::size_t bufOffset, std::size_t readLength) const;
+
+		// Reads the whole object, or returns ErrorCode::TruncatedData if it doesn't fit into the file
+		template <std::endian DataEndianness, Memory::PrimitiveType T>
+		[[nodiscard]] Result<T> TryRead(std::uint64_t fileOffset) const
+		{
+			unsigned char bytes[sizeof(T)];
+			Result<std::size_t> bytesRead = TryRead(bytes, sizeof(T), fileOffset, 0, sizeof(T));
+			if (!bytesRead)
+			{
+				return Unexpected{ bytesRead.error() };
+			}
+			if (*bytesRead < sizeof(T))
+			{
+				return Unexpected{ ErrorCode::TruncatedData };
+			}
+			T obj;
+			Memory::UnalignedRead<DataEndianness>(bytes, obj);
+			return obj;
+		}
+
+		template <std::endian DataEndianness, Memory::DescribedStruct T>
+		[[nodiscard]] Result<T> TryReadStruct(std::uint64_t fileOffset) const
+		{
+			T obj;
+			Result<std::size_t> bytesRead = TryRead(reinterpret_cast<unsigned char*>(&obj), sizeof(T), fileOffset, 0, sizeof(T));
+			if (!bytesRead)
+			{
+				return Unexpected{ bytesRead.error() };
+			}
+			if (*bytesRead < sizeof(T))
+			{
+				return Unexpected{ ErrorCode::TruncatedData };
+			}
+			if constexpr (DataEndianness != std::endian::native)
+			{
+				Memory::StructLayoutOf<T>::SwapByteOrder(obj);
+			}
+			return obj;
+		}
+
 		unsigned char operator[](std::uint64_t absoluteOffset) const;
 
 		[[nodiscard]] MemoryMappedFileRegion MapRegion(std::uint64_t offset, std::size_t length) const;
 
+		// Maps a region containing [offset, offset + length) with no granularity requirements.
+		// The data starts at offsetInRegion in the returned region.
+		// May throw std::out_of_range if the range is outside the file
+		[[nodiscard]] MemoryMappedFileRegion MapRange(std::uint64_t offset, std::size_t length, std::size_t& offsetInRegion) const;
+
+		// Same as MapRegion and MapRange, but return an error instead of throwing, if the arguments are invalid
+		[[nodiscard]] Result<MemoryMappedFileRegion> TryMapRegion(std::uint64_t offset, std::size_t length) const;
+		[[nodiscard]] Result<MemoryMappedFileRegion> TryMapRange(std::uint64_t offset, std::size_t length, std::size_t& offsetInRegion) const;
+
+		// Returns count elements of type T at the file offset without copying.
+		// The offset must be aligned for T, and the data must be in the native byte order
+		template <Memory::PrimitiveType T>
+		[[nodiscard]] MemoryMappedSpan<T> View(std::uint64_t offset, std::size_t count) const
+		{
+			if (offset % alignof(T) != 0)
+			{
+				throw std::out_of_range{ "File offset " + std::to_string(offset) + " is not aligned to " + std::to_string(alignof(T)) };
+			}
+			Result<MemoryMappedSpan<T>> view = TryView<T>(offset, count);
+			if (!view)
+			{
+				ThrowError(view.error());
+			}
+			return std::move(*view);
+		}
+
+		// Returns count elements of type T stored with the given endianness at the file offset without copying.
+		// Elements are decoded on access, so the offset may be unaligned
+		template <std::endian DataEndianness, Memory::PrimitiveType T>
+		[[nodiscard]] MemoryMappedRange<DataEndianness, T> View(std::uint64_t offset, std::size_t count) const
+		{
+			Result<MemoryMappedRange<DataEndianness, T>> view = TryView<DataEndianness, T>(offset, count);
+			if (!view)
+			{
+				ThrowError(view.error());
+			}
+			return std::move(*view);
+		}
+
+		// Same as View, but return an error instead of throwing
+		template <Memory::PrimitiveType T>
+		[[nodiscard]] Result<MemoryMappedSpan<T>> TryView(std::uint64_t offset, std::size_t count) const
+		{
+			if (offset % alignof(T) != 0)
+			{
+				return Unexpected{ ErrorCode::MisalignedOffset };
+			}
+			Result<std::size_t> length = ViewLength(count, sizeof(T));
+			if (!length)
+			{
+				return Unexpected{ length.error() };
+			}
+			std::size_t offsetInRegion;
+			Result<MemoryMappedFileRegion> region = TryMapRange(offset, *length, offsetInRegion);
+			if (!region)
+			{
+				return Unexpected{ region.error() };
+			}
+			const T* data = reinterpret_cast<const T*>(region->data() + offsetInRegion);
+			return MemoryMappedSpan<T>{ std::move(*region), data, count };
+		}
+
+		template <std::endian DataEndianness, Memory::PrimitiveType T>
+		[[nodiscard]] Result<MemoryMappedRange<DataEndianness, T>> TryView(std::uint64_t offset, std::size_t count) const
+		{
+			Result<std::size_t> length = ViewLength(count, sizeof(T));
+			if (!length)
+			{
+				return Unexpected{ length.error() };
+			}
+			std::size_t offsetInRegion;
+			Result<MemoryMappedFileRegion> region = TryMapRange(offset, *length, offsetInRegion);
+			if (!region)
+			{
+				return Unexpected{ region.error() };
+			}
+			const unsigned char* data = region->data() + offsetInRegion;
+			return MemoryMappedRange<DataEndianness, T>{ std::move(*region), data, count };
+		}
+
 	private:
 		MemoryMappedFile(const MemoryMappedFileRegion&);
 		MemoryMappedFile(const std::shared_ptr<Impl::MemoryMappedFileImpl>& impl);
 
+		// Returns count * elementSize, or ErrorCode::LengthOverflow
+		static Result<std::size_t> ViewLength(std::size_t count, std::size_t elementSize) noexcept;
+
 		// An order of fields is important, as it is expected
 		// that _impl initializes first, and then - _size
 		std::shared_ptr<Impl::MemoryMappedFileImpl> _impl;
 		std::uint64_t _length;
+		// Points into _impl, if the whole file is mapped as a single view
+		const unsigned char* _wholeFileView;
 
 		mutable MemoryMappedFileRegion _regionCache;
 
@@ -157,6 +524,33 @@ namespace Eyesol::MemoryMappedIO
 		friend class Impl::MemoryMappedFileImpl;
 	};
 
+	// Writable zero-filled pages of the process. File pages may be mapped into them copy-on-write,
+	// so they stay shared with the system cache until they are modified. Copies share the pages
+	class EYESOLPEREADER_API PrivateMemory
+	{
+	public:
+		PrivateMemory() noexcept;
+
+		// Returns ErrorCode::OutOfMemory if the address space is exhausted
+		static Result<PrivateMemory> Allocate(std::size_t length);
+
+		std::size_t length() const noexcept { return _length; }
+		unsigned char* data() const noexcept { return _pages.get(); }
+
+		// Maps the file range at the offset in the memory instead of copying it.
+		// All the arguments must be multiples of Runtime::AllocationGranularity().
+		// Returns false if they are not, if the ranges don't fit, or if the platform
+		// can't map views at a given address, so the data has to be copied.
+		// Returns ErrorCode::OutOfMemory if the memory at the offset was lost and can't be used any more.
+		// On Windows the memory around the range may be allocated anew and zero-filled,
+		// so all the views are mapped before any data is written
+		Result<bool> TryMapFile(std::size_t offset, const MemoryMappedFile& file, std::uint64_t fileOffset, std::size_t length);
+
+	private:
+		Impl::PrivatePages _pages;
+		std::size_t _length;
+	};
+
 	class EYESOLPEREADER_API MemoryMappedFileIterator
 	{
 	public:
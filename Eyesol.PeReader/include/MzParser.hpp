@@ -8,13 +8,17 @@ namespace Eyesol::Executables::Mz
 {
 	class MzExecutable;
 
-	struct MzParseContext
+	struct MzParseContext : ExecutableParseContext
 	{
 		std::optional<ExecutableObjectFormat> format;
 		std::optional<ExecutableType> type;
 		MzFileMetadata metadata;
 		MzDosHeader& header = metadata.header;
 		bool mzHeaderRead{};
+		// The DOS part of the file, in the probe bytes if they cover it, or in dosDataRegion.
+		// Valid while the file is parsed
+		std::span<const unsigned char> dosData;
+		MemoryMappedIO::MemoryMappedFileRegion dosDataRegion;
 		virtual ~MzParseContext();
 	};
 
@@ -26,24 +30,31 @@ namespace Eyesol::Executables::Mz
 		virtual bool IsTypeSupported(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, ExecutableObjectFormat* format, ExecutableType* type) const final;
 		virtual std::shared_ptr<Executable> TryParse(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::exception_ptr* excPtr) const final;
 
+		virtual std::vector<ExecutableMagic> SupportedMagics() const final;
+		virtual Result<void> ProbeType(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext>* ctx, ExecutableObjectFormat* format, ExecutableType* type) const final;
+		virtual Result<std::shared_ptr<Executable>> TryParseProbed(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext> ctx) const final;
+
 	protected:
-		virtual bool TryParseTypeAndFormat(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, MzDosHeader& header, MzParseContext* ctx) const;
+		// probeBytes are the beginning of the file. They may be empty or shorter than needed.
+		// Returns ErrorCode::UnknownFormat for files of other formats
+		virtual Result<void> TryParseTypeAndFormat(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, MzDosHeader& header, MzParseContext* ctx) const;
 
 		virtual std::unique_ptr<MzParseContext> CreateParseContext() const;
-		virtual std::shared_ptr<MzExecutable> ParseExecutable(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, MzParseContext& ctx) const;
+		virtual Result<std::shared_ptr<MzExecutable>> ParseExecutable(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, MzParseContext& ctx) const;
 		virtual std::uint32_t CalculateActualMzDataLength(const MemoryMappedIO::MemoryMappedFile& file, uint32_t precalculatedLength, const MzParseContext& ctx) const;
 
 	private:
-		void ReadDosMetadata(const MemoryMappedIO::MemoryMappedFile& file, MzParseContext& ctx) const;
-		bool TryParseTypeAndFormatPrivate(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, MzParseContext* ctx) const;
+		Result<void> TryReadDosMetadata(const MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, MzParseContext& ctx) const;
+		Result<void> TryParseTypeAndFormatPrivate(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, MzParseContext* ctx) const;
 
-		static void ReadDosHeader(const MemoryMappedIO::MemoryMappedFile& file, MzDosHeader& header);
+		static Result<void> TryReadDosHeader(const MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, MzDosHeader& header);
 
-		static uint16_t CalculateChecksum(const MemoryMappedIO::MemoryMappedFile& file, MzParseContext& ctx, bool includeBytesBeyondActualDosPart);
+		// The checksum of the DOS part, with the checksum field taken as zero
+		static uint16_t CalculateChecksum(std::span<const unsigned char> dosData);
 		static bool ChecksumValid(uint16_t checksum, uint16_t complementChecksum);
 
 		// Writes an offset of the "Rich" signature (if any) to the offset parameter
-		static void TryParseRichHeader(const MemoryMappedIO::MemoryMappedFile& file, MzParseContext& ctx);
+		static Result<void> TryParseRichHeader(MzParseContext& ctx);
 
 		static std::vector<std::string> _supportedFormatNames;
 	};
@@ -61,6 +72,26 @@ namespace Eyesol::Executables::Mz
 			return _metadata;
 		}
 
+		// The file, which the executable is parsed from
+		const MemoryMappedIO::MemoryMappedFile& file() const
+		{
+			return _file;
+		}
+
+		// Relocations are decoded on access, nothing is copied
+		MemoryMappedIO::MemoryMappedRange<DOS_ENDIANNESS, MzDosHeaderRelocation> dosRelocations() const
+		{
+			const FileLocation& loc = _metadata.dosRelocationsLoc;
+			return _file.View<DOS_ENDIANNESS, MzDosHeaderRelocation>(loc.AbsoluteOffset, loc.Length / DOS_HEADER_RELOCATION_SIZE);
+		}
+
+		// A view of the stub code in the mapped file
+		MemoryMappedIO::MemoryMappedSpan<unsigned char> dosStubCode() const
+		{
+			const FileLocation& loc = _metadata.dosStubCodeLoc;
+			return _file.View<unsigned char>(loc.AbsoluteOffset, loc.Length);
+		}
+
 		virtual ExecutableObjectFormat format() const;
 		virtual ExecutableType type() const;
 		virtual Eyesol::Cpu::ArchType arch() const;
@@ -72,7 +103,8 @@ namespace Eyesol::Executables::Mz
 		virtual bool ContainsDebugInfo() const;
 		virtual std::shared_ptr<DebugInfo> GetDebugInfo() const;
 
-		void init(MemoryMappedIO::MemoryMappedFile file, const MzParseContext& ctx);
+		// Takes the metadata over from the context
+		void init(MemoryMappedIO::MemoryMappedFile file, MzParseContext&& ctx);
 
 	private:
 		MemoryMappedIO::MemoryMappedFile _file;
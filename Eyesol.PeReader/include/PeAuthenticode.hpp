@@ -0,0 +1,31 @@
+#if !defined _PE_AUTHENTICODE_H_
+#	define _PE_AUTHENTICODE_H_
+#	include <span>
+#	include <vector>
+#	include "ErrorCodes.hpp"
+#	include "Hashing.hpp"
+#	include "PeHeaders.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	class PeExecutable;
+
+	// A digest of the image, or the reason it cannot be computed
+	using AuthenticodeDigest = Result<std::vector<std::uint8_t>>;
+
+	// File ranges covered by the Authenticode image hash, in the hashing order:
+	// the headers without CheckSum and the certificate table entry, raw data of the sections
+	// sorted by their file offsets, and the data after the hashed bytes except the certificate table.
+	// Returns ErrorCode::TruncatedData, if a range or the certificate table doesn't fit into the file,
+	// and ErrorCode::BadOptionalHeader, if the excluded fields lie beyond SizeOfHeaders
+	EYESOLPEREADER_API Result<std::vector<FileLocation>> GetAuthenticodeRanges(const PeExecutable& exe);
+
+	// The image hash, which the signature's SpcIndirectDataContent holds.
+	// The ranges are streamed from the mapped file window by window, nothing is copied
+	EYESOLPEREADER_API AuthenticodeDigest ComputeAuthenticodeHash(const PeExecutable& exe, Hashing::HashAlgorithm algorithm);
+
+	// Hashes several images at once on the calling thread, see Hashing::MultiBufferHasher.
+	// Digests are in the order of the executables
+	EYESOLPEREADER_API std::vector<AuthenticodeDigest> ComputeAuthenticodeHashes(std::span<const PeExecutable* const> executables, Hashing::HashAlgorithm algorithm);
+}
+#endif
@@ -0,0 +1,23 @@
+#if !defined _PE_CHECKSUM_H_
+#	define _PE_CHECKSUM_H_
+#	include "ErrorCodes.hpp"
+#	include "MemoryMappedIO.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	// When PeParser computes the image checksum
+	enum class ChecksumVerification
+	{
+		// On the first call of PeExecutable::actualChecksum or checksumValid, so parsing reads the headers only
+		Lazy,
+		// While parsing. A mismatch doesn't fail the parse
+		Eager,
+	};
+
+	// The image checksum, as the loader validates it for drivers and system files:
+	// a ones' complement sum of 16-bit words of the file, with the CheckSum field taken as zero,
+	// plus the file length. The file is summed window by window, nothing is copied.
+	// Returns ErrorCode::TruncatedData, if the field doesn't fit into the file
+	EYESOLPEREADER_API Result<std::uint32_t> ComputePeChecksum(const MemoryMappedIO::MemoryMappedFile& file, std::uint64_t checkSumOffset);
+}
+#endif
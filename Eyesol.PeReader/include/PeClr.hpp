@@ -0,0 +1,231 @@
+#if !defined _PE_CLR_H_
+#	define _PE_CLR_H_
+#	include <array>
+#	include <cstdint>
+#	include <span>
+#	include <string_view>
+#	include "ErrorCodes.hpp"
+#	include "MemoryMappedIO.hpp"
+#	include "PeHeaders.hpp"
+#	include "PeResources.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	class PeExecutable;
+
+	// Metadata tables, ECMA-335 II.22. Values are the table numbers of tokens and of the Valid mask
+	enum class MetadataTable : std::uint8_t
+	{
+		Module,
+		TypeRef,
+		TypeDef,
+		FieldPtr,
+		Field,
+		MethodPtr,
+		MethodDef,
+		ParamPtr,
+		Param,
+		InterfaceImpl,
+		MemberRef,
+		Constant,
+		CustomAttribute,
+		FieldMarshal,
+		DeclSecurity,
+		ClassLayout,
+		FieldLayout,
+		StandAloneSig,
+		EventMap,
+		EventPtr,
+		Event,
+		PropertyMap,
+		PropertyPtr,
+		Property,
+		MethodSemantics,
+		MethodImpl,
+		ModuleRef,
+		TypeSpec,
+		ImplMap,
+		FieldRva,
+		EncLog,
+		EncMap,
+		Assembly,
+		AssemblyProcessor,
+		AssemblyOs,
+		AssemblyRef,
+		AssemblyRefProcessor,
+		AssemblyRefOs,
+		File,
+		ExportedType,
+		ManifestResource,
+		NestedClass,
+		GenericParam,
+		MethodSpec,
+		GenericParamConstraint,
+	};
+
+	constexpr std::size_t METADATA_TABLES_COUNT = static_cast<std::size_t>(MetadataTable::GenericParamConstraint) + 1;
+	// The Assembly and AssemblyRef tables have the most columns
+	constexpr std::size_t METADATA_MAXIMUM_COLUMNS = 9;
+
+	// Coded indices, ECMA-335 II.24.2.6. Low bits of a value select the table, the rest is the row
+	enum class CodedIndex : std::uint8_t
+	{
+		TypeDefOrRef,
+		HasConstant,
+		HasCustomAttribute,
+		HasFieldMarshal,
+		HasDeclSecurity,
+		MemberRefParent,
+		HasSemantics,
+		MethodDefOrRef,
+		MemberForwarded,
+		Implementation,
+		CustomAttributeType,
+		ResolutionScope,
+		TypeOrMethodDef,
+	};
+
+	// A row of a table. Rows are numbered from 1, the zero row is a null reference
+	struct MetadataToken
+	{
+		MetadataTable table;
+		std::uint32_t row;
+
+		static MetadataToken FromValue(std::uint32_t token) noexcept
+		{
+			return { static_cast<MetadataTable>(token >> 24), token & 0x00FFFFFF };
+		}
+
+		std::uint32_t value() const noexcept { return static_cast<std::uint32_t>(table) << 24 | row; }
+		bool null() const noexcept { return row == 0; }
+	};
+
+	// Raw column values of a row: constants, flags, heap indices, table rows and coded indices
+	struct MetadataRow
+	{
+		std::array<std::uint32_t, METADATA_MAXIMUM_COLUMNS> columns;
+		std::uint8_t size;
+
+		std::uint32_t operator[](std::size_t column) const noexcept { return columns[column]; }
+	};
+
+	struct TypeDefRow
+	{
+		// TypeAttributes
+		std::uint32_t flags;
+		std::string_view typeName;
+		std::string_view typeNamespace;
+		// A TypeDef, TypeRef or TypeSpec. Null for interfaces and System.Object
+		MetadataToken extends;
+		// The first rows of the type fields and methods, which run up to the lists of the next type
+		std::uint32_t fieldList;
+		std::uint32_t methodList;
+	};
+
+	struct MethodDefRow
+	{
+		// The method body, zero for abstract and runtime implemented methods
+		std::uint32_t rva;
+		// MethodImplAttributes
+		std::uint16_t implFlags;
+		// MethodAttributes
+		std::uint16_t flags;
+		std::string_view name;
+		std::span<const unsigned char> signature;
+		std::uint32_t paramList;
+	};
+
+	struct MemberRefRow
+	{
+		// A TypeDef, TypeRef, ModuleRef, MethodDef or TypeSpec
+		MetadataToken parent;
+		std::string_view name;
+		std::span<const unsigned char> signature;
+	};
+
+	// The metadata root of a .NET assembly with its streams and table layouts.
+	// Row and index widths are computed once on creation, so a row is read at a computed offset
+	// without a walk over preceding tables. Strings, blobs and signatures are views of the mapped
+	// metadata, which is kept mapped while the object is alive
+	class EYESOLPEREADER_API ClrMetadata
+	{
+	public:
+		// An empty object, without tables and heaps
+		ClrMetadata() noexcept;
+
+		// Returns an empty object, if the image has no CLR header
+		static Result<ClrMetadata> Create(const PeExecutable& exe);
+		// Decodes the metadata root and the #~ (or the uncompressed #-) stream header
+		static Result<ClrMetadata> Parse(MemoryMappedIO::MemoryMappedSpan<unsigned char> data);
+
+		bool empty() const noexcept { return _data.empty(); }
+		// The runtime version the assembly is built for, e.g. "v4.0.30319"
+		std::string_view version() const noexcept { return _version; }
+		// Whether the tables stream is uncompressed, i.e. it may contain *Ptr tables and edit-and-continue data
+		bool uncompressed() const noexcept { return _uncompressed; }
+
+		std::uint32_t rowCount(MetadataTable table) const noexcept
+		{
+			return _tables[static_cast<std::size_t>(table)].rows;
+		}
+
+		// Whether the table is sorted by its primary key
+		bool sorted(MetadataTable table) const noexcept
+		{
+			return (_sortedMask >> static_cast<unsigned>(table) & 1) != 0;
+		}
+
+		// Returns ErrorCode::TokenOutOfRange, if the row is zero or beyond the table
+		Result<MetadataRow> RowAt(MetadataTable table, std::uint32_t row) const;
+		Result<MetadataRow> RowAt(MetadataToken token) const
+		{
+			return RowAt(token.table, token.row);
+		}
+
+		Result<TypeDefRow> TypeDefAt(std::uint32_t row) const;
+		Result<MethodDefRow> MethodDefAt(std::uint32_t row) const;
+		Result<MemberRefRow> MemberRefAt(std::uint32_t row) const;
+
+		// Heap accessors. Zero indices return empty values.
+		// Returns ErrorCode::TokenOutOfRange, if the index is beyond the heap
+
+		// A UTF-8 string of the #Strings heap
+		Result<std::string_view> GetString(std::uint32_t index) const;
+		// A string of the #US heap, without the trailing flag byte
+		Result<Utf16LeView> GetUserString(std::uint32_t index) const;
+		// Indices of the #GUID heap count GUIDs from 1
+		Result<Guid> GetGuid(std::uint32_t index) const;
+		// A blob of the #Blob heap, without its compressed length
+		Result<std::span<const unsigned char>> GetBlob(std::uint32_t index) const;
+
+		// Splits a coded index into a table and a row. Returns ErrorCode::BadClrMetadata for unused tags
+		static Result<MetadataToken> DecodeCodedIndex(CodedIndex kind, std::uint32_t value) noexcept;
+
+	private:
+		struct TableLayout
+		{
+			// From the start of the tables stream
+			std::uint32_t offset;
+			std::uint32_t rows;
+			std::uint8_t rowSize;
+			std::uint8_t columnsCount;
+			// Offsets of columns within the row, the last one is the row size
+			std::array<std::uint8_t, METADATA_MAXIMUM_COLUMNS + 1> columnOffsets;
+		};
+
+		Result<void> ComputeLayouts(std::span<const unsigned char> header, std::uint8_t heapSizes, std::uint64_t validMask);
+
+		MemoryMappedIO::MemoryMappedSpan<unsigned char> _data;
+		std::string_view _version;
+		bool _uncompressed;
+		std::uint64_t _sortedMask;
+		// Views of the streams within _data
+		std::span<const unsigned char> _tablesData;
+		std::span<const unsigned char> _strings;
+		std::span<const unsigned char> _userStrings;
+		std::span<const unsigned char> _guids;
+		std::span<const unsigned char> _blobs;
+		std::array<TableLayout, METADATA_TABLES_COUNT> _tables;
+	};
+}
+#endif
@@ -0,0 +1,132 @@
+#if !defined _PE_DEBUG_H_
+#	define _PE_DEBUG_H_
+#	include <cstdint>
+#	include <memory>
+#	include <string>
+#	include <string_view>
+#	include <vector>
+#	include "ErrorCodes.hpp"
+#	include "Executable.hpp"
+#	include "MemoryMappedIO.hpp"
+#	include "PeHeaders.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	class PeExecutable;
+
+	enum class CodeViewFormat
+	{
+		// CV_INFO_PDB70, PDB 7.0 and portable PDB files
+		Rsds,
+		// CV_INFO_PDB20, PDB 2.0 files of old linkers
+		Nb10,
+	};
+
+	// A PDB file referenced by a CodeView record. Keeps the record mapped, so the path is a view of the file
+	class EYESOLPEREADER_API PdbDebugInfo : public DebugInfo
+	{
+	public:
+		// Decodes the data of a CodeView entry. Returns ErrorCode::BadDebugDirectory,
+		// if the signature is unknown, the record is too short or the path has no terminator
+		static Result<std::shared_ptr<PdbDebugInfo>> Parse(const DebugDirectoryEntry& entry, MemoryMappedIO::MemoryMappedSpan<unsigned char> record);
+
+		// DebugInfoType::PortablePdb for portable PDB entries, DebugInfoType::Pdb otherwise
+		virtual DebugInfoType type() const override;
+
+		CodeViewFormat format() const noexcept { return _format; }
+		// Zero in NB10 records
+		const Guid& guid() const noexcept { return _guid; }
+		// The timestamp, which identifies PDB 2.0 files instead of a GUID. Zero in RSDS records
+		std::uint32_t pdbSignature() const noexcept { return _pdbSignature; }
+		std::uint32_t age() const noexcept { return _age; }
+		// As the linker has stored it, usually an absolute path. UTF-8 in RSDS records
+		std::string_view pdbPath() const noexcept { return _pdbPath; }
+
+		// The symbol server key: the GUID (or the NB10 signature) and the age as uppercase hex digits,
+		// e.g. "1D5C0A4E9B3F4C2A8E7D6B5A49382716" "1". Portable PDBs don't append the age, but use
+		// the "FFFFFFFF" suffix instead
+		std::string SymbolServerKey() const;
+
+	private:
+		PdbDebugInfo() noexcept;
+
+		MemoryMappedIO::MemoryMappedSpan<unsigned char> _record;
+		CodeViewFormat _format;
+		bool _portable;
+		Guid _guid;
+		std::uint32_t _pdbSignature;
+		std::uint32_t _age;
+		std::string_view _pdbPath;
+	};
+
+	struct PogoEntry
+	{
+		std::uint32_t rva;
+		std::uint32_t size;
+		// A section contribution, e.g. ".text$mn". Points into the mapped data
+		std::string_view name;
+	};
+
+	// Profile guided optimization data of a POGO entry. Keeps the data mapped
+	class EYESOLPEREADER_API PogoInfo
+	{
+	public:
+		PogoInfo() noexcept;
+		explicit PogoInfo(MemoryMappedIO::MemoryMappedSpan<unsigned char> data) noexcept;
+
+		// POGO_SIGNATURE_*, or zero if the data is empty
+		std::uint32_t signature() const noexcept;
+		// Entries up to the end of the data. Returns ErrorCode::BadDebugDirectory, if a name has no terminator
+		Result<std::vector<PogoEntry>> entries() const;
+
+	private:
+		MemoryMappedIO::MemoryMappedSpan<unsigned char> _data;
+	};
+
+	// The debug directory entries, decoded on access. Creating the object maps the entries only,
+	// and the data of an entry is mapped when it is requested, so a lookup reads a page or two.
+	// The object must not outlive the executable
+	class EYESOLPEREADER_API DebugDirectory
+	{
+	public:
+		// An empty directory
+		DebugDirectory() noexcept;
+
+		// Returns an empty directory, if the image has none
+		static Result<DebugDirectory> Create(const PeExecutable& exe);
+
+		std::size_t size() const noexcept { return _entries.size() / sizeof(DebugDirectoryEntry); }
+		bool empty() const noexcept { return _entries.empty(); }
+
+		DebugDirectoryEntry operator[](std::size_t index) const noexcept
+		{
+			DebugDirectoryEntry entry;
+			Memory::ReadStruct<PE_COFF_ENDIANNESS>(_entries.data() + index * sizeof(DebugDirectoryEntry), entry);
+			return entry;
+		}
+
+		// The first entry of the IMAGE_DEBUG_TYPE_* type, or ErrorCode::DebugInfoNotFound
+		Result<DebugDirectoryEntry> Find(std::uint32_t type) const;
+
+		// Data of the entry, found by PointerToRawData, or by AddressOfRawData if it isn't set.
+		// Data longer than maximumLength is cut. The view is empty, if the entry has no data
+		Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> DataOf(const DebugDirectoryEntry& entry, std::size_t maximumLength = SIZE_MAX) const;
+
+		// The first CodeView entry
+		Result<std::shared_ptr<PdbDebugInfo>> FindPdb() const;
+		// The first POGO entry
+		Result<PogoInfo> FindPogo() const;
+		// Whether the image is built deterministically, i.e. has a REPRO entry
+		bool reproducible() const;
+		// The hash of the build inputs stored in the REPRO entry. Empty, if the entry has no data,
+		// then TimeDateStamp fields of the image hold a part of the hash instead
+		Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> FindReproHash() const;
+
+	private:
+		Result<std::uint64_t> DataOffset(const DebugDirectoryEntry& entry) const;
+
+		const PeExecutable* _exe;
+		MemoryMappedIO::MemoryMappedSpan<unsigned char> _entries;
+	};
+}
+#endif
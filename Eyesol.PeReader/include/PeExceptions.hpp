@@ -0,0 +1,185 @@
+#if !defined _PE_EXCEPTIONS_H_
+#	define _PE_EXCEPTIONS_H_
+#	include <iterator>
+#	include <optional>
+#	include <span>
+#	include "ErrorCodes.hpp"
+#	include "PeHeaders.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	class PeExecutable;
+
+	// An entry of the exception directory
+	struct RuntimeFunction
+	{
+		std::uint32_t beginAddress;
+		// Exclusive. Zero for ARM64 functions, which keep their length in .xdata, see ExceptionDirectory::FunctionEnd
+		std::uint32_t endAddress;
+		// An UNWIND_INFO RVA on x64. On ARM64, an .xdata RVA, or packed unwind data, if its low bits are set
+		std::uint32_t unwindData;
+	};
+
+	struct X64UnwindInfo
+	{
+		std::uint8_t version;
+		// UNW_FLAG_*
+		std::uint8_t flags;
+		std::uint8_t sizeOfProlog;
+		// Zero, if the function doesn't establish a frame pointer
+		std::uint8_t frameRegister;
+		// The offset of the frame pointer from RSP, in 16-byte units
+		std::uint8_t frameOffset;
+		// UNWIND_CODE slots, two bytes each, in the reverse order of the prolog. Points into the mapped file
+		std::span<const unsigned char> unwindCodes;
+		// The language-specific handler and the RVA of its data, if flags has UNW_FLAG_EHANDLER or UNW_FLAG_UHANDLER
+		std::uint32_t exceptionHandler;
+		std::uint32_t handlerData;
+		// The function, which this one continues, if flags has UNW_FLAG_CHAININFO
+		std::optional<RuntimeFunction> chained;
+	};
+
+	struct Arm64UnwindInfo
+	{
+		// In bytes
+		std::uint32_t functionLength;
+		// The unwind data is packed into the entry, there is no .xdata record
+		bool packed;
+
+		/* Packed unwind data: */
+		// 1 for a single prolog and epilog, 2 for a fragment without a prolog
+		std::uint8_t flag;
+		// Saved floating point and integer registers
+		std::uint8_t regF;
+		std::uint8_t regI;
+		// Whether integer parameter registers are homed
+		bool homesParameters;
+		// Whether and how the link register and the frame pointer are saved
+		std::uint8_t cr;
+		// In bytes
+		std::uint16_t frameSize;
+
+		/* .xdata records: */
+		std::uint8_t version;
+		// Whether the record ends with an exception handler and its data
+		bool hasExceptionData;
+		// A single epilog is described by the header, so there are no epilog scopes
+		bool singleEpilog;
+		// Epilog scopes, or the unwind code index of the single epilog
+		std::uint16_t epilogCount;
+		// Epilog scope dwords. Points into the mapped file
+		std::span<const unsigned char> epilogScopes;
+		// Unwind code bytes, padded to dwords. Points into the mapped file
+		std::span<const unsigned char> unwindCodes;
+		std::uint32_t exceptionHandler;
+		std::uint32_t handlerData;
+	};
+
+	// The sorted runtime function table of x64 and ARM64 images, a view of the mapped section.
+	// Lookups are binary searches over the entries in place, so nothing is copied or allocated,
+	// and unwind data is decoded only on request. The object must not outlive the executable
+	class EYESOLPEREADER_API ExceptionDirectory
+	{
+	public:
+		class Iterator
+		{
+		public:
+			using iterator_concept = std::forward_iterator_tag;
+			using value_type = RuntimeFunction;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator() noexcept
+				: _owner{},
+				_index{}
+			{
+			}
+
+			Iterator(const ExceptionDirectory* owner, std::size_t index) noexcept
+				: _owner{ owner },
+				_index{ index }
+			{
+			}
+
+			RuntimeFunction operator*() const noexcept { return (*_owner)[_index]; }
+
+			Iterator& operator++() noexcept
+			{
+				_index++;
+				return *this;
+			}
+
+			Iterator operator++(int) noexcept
+			{
+				Iterator previous = *this;
+				_index++;
+				return previous;
+			}
+
+			bool operator==(const Iterator& other) const noexcept { return _index == other._index; }
+
+		private:
+			const ExceptionDirectory* _owner;
+			std::size_t _index;
+		};
+
+		// An empty directory
+		ExceptionDirectory() noexcept;
+
+		// Returns an empty directory, if the image has none. Tables of machines other than x64 and ARM64
+		// return ErrorCode::NotImplemented, unsorted tables return ErrorCode::BadExceptionDirectory
+		static Result<ExceptionDirectory> Create(const PeExecutable& exe);
+
+		std::size_t size() const noexcept { return _entries.size() / _entryLength; }
+		bool empty() const noexcept { return _entries.empty(); }
+
+		RuntimeFunction operator[](std::size_t index) const noexcept
+		{
+			const unsigned char* entry = _entries.data() + index * _entryLength;
+			RuntimeFunction function{};
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(entry, function.beginAddress);
+			if (_entryLength == sizeof(Amd64RuntimeFunctionEntry))
+			{
+				Memory::UnalignedRead<PE_COFF_ENDIANNESS>(entry + offsetof(Amd64RuntimeFunctionEntry, EndAddress), function.endAddress);
+				Memory::UnalignedRead<PE_COFF_ENDIANNESS>(entry + offsetof(Amd64RuntimeFunctionEntry, UnwindInfoAddress), function.unwindData);
+			}
+			else
+			{
+				Memory::UnalignedRead<PE_COFF_ENDIANNESS>(entry + offsetof(Arm64RuntimeFunctionEntry, UnwindData), function.unwindData);
+			}
+			return function;
+		}
+
+		Iterator begin() const noexcept { return { this, 0 }; }
+		Iterator end() const noexcept { return { this, size() }; }
+
+		// The index of the function containing the RVA. Returns ErrorCode::FunctionNotFound for RVAs
+		// before the first function, past the end of the preceding one, or in gaps between functions
+		Result<std::size_t> FindFunctionIndex(std::uint32_t rva) const;
+		Result<RuntimeFunction> FindFunction(std::uint32_t rva) const;
+
+		// The exclusive end of the function. ARM64 entries with .xdata records have it read from the record header
+		Result<std::uint32_t> FunctionEnd(const RuntimeFunction& function) const;
+
+		// Decodes UNWIND_INFO, following an indirect entry once.
+		// Returns ErrorCode::NotImplemented, if the image isn't an x64 one
+		Result<X64UnwindInfo> GetX64UnwindInfo(const RuntimeFunction& function) const;
+		// Decodes packed unwind data or the .xdata record.
+		// Returns ErrorCode::NotImplemented, if the image isn't an ARM64 one
+		Result<Arm64UnwindInfo> GetArm64UnwindInfo(const RuntimeFunction& function) const;
+
+	private:
+		std::uint32_t BeginAt(std::size_t index) const noexcept
+		{
+			std::uint32_t begin;
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(_entries.data() + index * _entryLength, begin);
+			return begin;
+		}
+
+		const PeExecutable* _exe;
+		// Entries of the section data, cut to whole entries
+		std::span<const unsigned char> _entries;
+		// sizeof(Amd64RuntimeFunctionEntry) or sizeof(Arm64RuntimeFunctionEntry)
+		std::size_t _entryLength;
+	};
+}
+#endif
@@ -0,0 +1,123 @@
+#if !defined _PE_EXPORTS_H_
+#	define _PE_EXPORTS_H_
+#	include <iterator>
+#	include <span>
+#	include <string_view>
+#	include "ErrorCodes.hpp"
+#	include "PeHeaders.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	class PeExecutable;
+
+	struct ExportedFunction
+	{
+		// Empty for exports by ordinal only, and for lookups by ordinal. Points into the mapped file
+		std::string_view name;
+		// Biased by the ordinal base
+		std::uint32_t ordinal;
+		// The exported code or data, or the forwarder string for forwarded exports
+		std::uint32_t rva;
+		// "Module.Function" or "Module.#Ordinal", if the export is forwarded to another module
+		std::string_view forwarder;
+
+		bool forwarded() const noexcept { return !forwarder.empty(); }
+	};
+
+	// The export directory with its tables validated once on creation.
+	// Lookups only index and binary search views of the mapped file, so they never allocate.
+	// The object must not outlive the executable
+	class EYESOLPEREADER_API ExportDirectory
+	{
+	public:
+		// Iterates exports in the order of either the address table or the name table.
+		// Unused address table entries are skipped. Iteration stops after the first error
+		class EYESOLPEREADER_API Iterator
+		{
+		public:
+			using iterator_concept = std::input_iterator_tag;
+			using value_type = Result<ExportedFunction>;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator() noexcept;
+			Iterator(const ExportDirectory* owner, bool byName);
+
+			const Result<ExportedFunction>& operator*() const noexcept { return _current; }
+			const Result<ExportedFunction>* operator->() const noexcept { return &_current; }
+
+			Iterator& operator++();
+			void operator++(int) { ++*this; }
+
+			bool operator==(std::default_sentinel_t) const noexcept { return _done; }
+
+		private:
+			void Load();
+
+			const ExportDirectory* _owner;
+			std::size_t _index;
+			Result<ExportedFunction> _current;
+			bool _byName;
+			bool _done;
+		};
+
+		class Range
+		{
+		public:
+			Range(const ExportDirectory* owner, bool byName) noexcept
+				: _owner{ owner },
+				_byName{ byName }
+			{
+			}
+
+			Iterator begin() const { return { _owner, _byName }; }
+			std::default_sentinel_t end() const noexcept { return {}; }
+
+		private:
+			const ExportDirectory* _owner;
+			bool _byName;
+		};
+
+		// An empty directory
+		ExportDirectory() noexcept;
+
+		// Returns an empty directory, if the image exports nothing
+		static Result<ExportDirectory> Create(const PeExecutable& exe);
+
+		const ExportDirectoryTable& table() const noexcept { return _table; }
+		// The module name stored in the image
+		std::string_view name() const noexcept { return _name; }
+
+		std::size_t functionsCount() const noexcept { return _functions.size() / sizeof(std::uint32_t); }
+		std::size_t namesCount() const noexcept { return _names.size() / sizeof(std::uint32_t); }
+
+		// Every export in the ordinal order, without names
+		Range functions() const noexcept { return { this, false }; }
+		// Exports with names, sorted by names
+		Range names() const noexcept { return { this, true }; }
+
+		// A binary search over the name table. Names are compared as bytes, like the loader does
+		Result<ExportedFunction> FindExport(std::string_view name) const;
+		// The ordinal is biased. The name is not looked up, as that takes a scan of the name table
+		Result<ExportedFunction> FindExport(std::uint32_t ordinal) const;
+
+		// An entry of the address table. Returns ErrorCode::ExportNotFound for unused entries
+		Result<ExportedFunction> ExportAt(std::size_t functionIndex) const;
+		// An entry of the name table, with its name
+		Result<ExportedFunction> NamedExportAt(std::size_t nameIndex) const;
+
+	private:
+		Result<std::string_view> NameAt(std::size_t nameIndex) const;
+
+		const PeExecutable* _exe;
+		ExportDirectoryTable _table;
+		std::string_view _name;
+		// Export RVAs within the directory point to forwarder strings
+		std::uint32_t _directoryRva;
+		std::uint32_t _directorySize;
+		// Views of the export address table, the name pointer table and the ordinal table
+		std::span<const unsigned char> _functions;
+		std::span<const unsigned char> _names;
+		std::span<const unsigned char> _nameOrdinals;
+	};
+}
+#endif
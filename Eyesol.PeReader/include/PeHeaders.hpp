@@ -2,7 +2,11 @@
 #	define _PEHEADERS_H_
 #	include "framework.hpp"
 #   include "MemoryMappedIO.hpp"
+#   include <algorithm>
+#   include <array>
+#   include <cstddef>
 #   include <optional>
+#   include <string_view>
 
 // ** Base address: the address at which a binary is loaded.
 // It is an address of the first byte of any bibary loaded into memory.
@@ -62,13 +66,26 @@ namespace Eyesol::Executables
         // A usual Microsoft Linker "Rich" header start
         constexpr std::size_t DOS_HEADER_RICH_HEADER_USUAL_START_OFFSET = 0x80;
 
+        // "DanS" and three padding dwords
+        constexpr std::size_t RICH_HEADER_DANS_BLOCK_SIZE = 4 * sizeof(std::uint32_t);
+
+        // Fields are in the file order, so decrypted elements may be copied as is.
+        // The @comp.id dword holds the build number in its low word
         struct RichHeaderElement
         {
-            std::uint16_t id;
             std::uint16_t build_number;
+            std::uint16_t id;
             std::uint32_t use_count;
         };
 
+        constexpr auto DescribeLayout(const RichHeaderElement*)
+        {
+            return Memory::StructLayout<RichHeaderElement,
+                &RichHeaderElement::build_number,
+                &RichHeaderElement::id,
+                &RichHeaderElement::use_count>{};
+        }
+
         struct RichHeader
         {
             std::vector<RichHeaderElement> elements;
@@ -105,6 +122,13 @@ namespace Eyesol::Executables
             std::uint16_t segment;
         };
 
+        constexpr auto DescribeLayout(const MzDosHeaderRelocation*)
+        {
+            return Memory::StructLayout<MzDosHeaderRelocation,
+                &MzDosHeaderRelocation::offset,
+                &MzDosHeaderRelocation::segment>{};
+        }
+
         // MS-DOS 2.0 Extended Compatible EXE Header
         struct MzDosHeader
         {
@@ -150,6 +174,30 @@ namespace Eyesol::Executables
             std::uint32_t e_lfanew;
         };
 
+        constexpr auto DescribeLayout(const MzDosHeader*)
+        {
+            return Memory::StructLayout<MzDosHeader,
+                &MzDosHeader::e_magic,
+                &MzDosHeader::e_cblp,
+                &MzDosHeader::e_cp,
+                &MzDosHeader::e_crlc,
+                &MzDosHeader::e_cparhdr,
+                &MzDosHeader::e_minalloc,
+                &MzDosHeader::e_maxalloc,
+                &MzDosHeader::e_ss,
+                &MzDosHeader::e_sp,
+                &MzDosHeader::e_csum,
+                &MzDosHeader::e_ip,
+                &MzDosHeader::e_cs,
+                &MzDosHeader::e_lfarlc,
+                &MzDosHeader::e_ovno,
+                &MzDosHeader::e_res,
+                &MzDosHeader::e_oemid,
+                &MzDosHeader::e_oeminfo,
+                &MzDosHeader::e_res2,
+                &MzDosHeader::e_lfanew>{};
+        }
+
         struct MzFileMetadata
         {
             MzFileMetadata()
@@ -178,6 +226,7 @@ namespace Eyesol::Executables
             /* Can be used for a generic DOS MZ format */
             // Located inside the DOS header
             // FileLocation _dosHeaderVendorSpecificDataLoc;
+            // Relocations and stub code are not copied. MzExecutable provides views of them
             FileLocation dosRelocationsLoc;
             FileLocation dosStubCodeLoc;
 
@@ -190,8 +239,6 @@ namespace Eyesol::Executables
 
             // Here, may be overlays data or other vendor-specific information
             // std::vector<unsigned char> _dosHeaderVendorSpecificData;
-            std::vector<MzDosHeaderRelocation> dosRelocations;
-            std::vector<unsigned char> dosStubCode;
         };
     }
 
@@ -204,6 +251,802 @@ namespace Eyesol::Executables
 
         constexpr std::uint32_t PE_SIGNATURE = 0x00004550U;
 
+        // IMAGE_FILE_HEADER::Machine values
+        constexpr std::uint16_t IMAGE_FILE_MACHINE_UNKNOWN = 0x0000;
+        constexpr std::uint16_t IMAGE_FILE_MACHINE_I386 = 0x014C;
+        constexpr std::uint16_t IMAGE_FILE_MACHINE_ARM = 0x01C0;
+        constexpr std::uint16_t IMAGE_FILE_MACHINE_THUMB = 0x01C2;
+        constexpr std::uint16_t IMAGE_FILE_MACHINE_ARMNT = 0x01C4;
+        constexpr std::uint16_t IMAGE_FILE_MACHINE_IA64 = 0x0200;
+        constexpr std::uint16_t IMAGE_FILE_MACHINE_AMD64 = 0x8664;
+        constexpr std::uint16_t IMAGE_FILE_MACHINE_ARM64 = 0xAA64;
+
+        // IMAGE_FILE_HEADER::Characteristics flags
+        constexpr std::uint16_t IMAGE_FILE_RELOCS_STRIPPED = 0x0001;
+        constexpr std::uint16_t IMAGE_FILE_EXECUTABLE_IMAGE = 0x0002;
+        constexpr std::uint16_t IMAGE_FILE_LARGE_ADDRESS_AWARE = 0x0020;
+        constexpr std::uint16_t IMAGE_FILE_32BIT_MACHINE = 0x0100;
+        constexpr std::uint16_t IMAGE_FILE_DEBUG_STRIPPED = 0x0200;
+        constexpr std::uint16_t IMAGE_FILE_SYSTEM = 0x1000;
+        constexpr std::uint16_t IMAGE_FILE_DLL = 0x2000;
+
+        // IMAGE_OPTIONAL_HEADER::Magic values
+        constexpr std::uint16_t IMAGE_NT_OPTIONAL_HDR32_MAGIC = 0x010B;
+        constexpr std::uint16_t IMAGE_NT_OPTIONAL_HDR64_MAGIC = 0x020B;
+
+        // The loader ignores data directories beyond this count
+        constexpr std::size_t IMAGE_NUMBEROF_DIRECTORY_ENTRIES = 16;
+
+        // IMAGE_FILE_HEADER
+        struct CoffFileHeader
+        {
+            std::uint16_t Machine;
+            std::uint16_t NumberOfSections;
+            std::uint32_t TimeDateStamp;
+            std::uint32_t PointerToSymbolTable;
+            std::uint32_t NumberOfSymbols;
+            std::uint16_t SizeOfOptionalHeader;
+            std::uint16_t Characteristics;
+        };
+
+        constexpr auto DescribeLayout(const CoffFileHeader*)
+        {
+            return Memory::StructLayout<CoffFileHeader,
+                &CoffFileHeader::Machine,
+                &CoffFileHeader::NumberOfSections,
+                &CoffFileHeader::TimeDateStamp,
+                &CoffFileHeader::PointerToSymbolTable,
+                &CoffFileHeader::NumberOfSymbols,
+                &CoffFileHeader::SizeOfOptionalHeader,
+                &CoffFileHeader::Characteristics>{};
+        }
+
+        // IMAGE_DATA_DIRECTORY
+        struct DataDirectory
+        {
+            std::uint32_t VirtualAddress;
+            std::uint32_t Size;
+
+            bool empty() const { return VirtualAddress == 0 || Size == 0; }
+        };
+
+        constexpr auto DescribeLayout(const DataDirectory*)
+        {
+            return Memory::StructLayout<DataDirectory,
+                &DataDirectory::VirtualAddress,
+                &DataDirectory::Size>{};
+        }
+
+        // Indices of IMAGE_OPTIONAL_HEADER::DataDirectory
+        enum class DataDirectoryIndex
+        {
+            Export,
+            Import,
+            Resource,
+            Exception,
+            // Attribute certificates. Its VirtualAddress is a file offset
+            Security,
+            BaseRelocation,
+            Debug,
+            Architecture,
+            GlobalPtr,
+            Tls,
+            LoadConfig,
+            BoundImport,
+            Iat,
+            DelayImport,
+            ComDescriptor,
+            Reserved,
+        };
+
+        // IMAGE_OPTIONAL_HEADER32 without data directories, as stored in the file
+        struct OptionalHeader32
+        {
+            std::uint16_t Magic;
+            std::uint8_t MajorLinkerVersion;
+            std::uint8_t MinorLinkerVersion;
+            std::uint32_t SizeOfCode;
+            std::uint32_t SizeOfInitializedData;
+            std::uint32_t SizeOfUninitializedData;
+            std::uint32_t AddressOfEntryPoint;
+            std::uint32_t BaseOfCode;
+            std::uint32_t BaseOfData;
+            std::uint32_t ImageBase;
+            std::uint32_t SectionAlignment;
+            std::uint32_t FileAlignment;
+            std::uint16_t MajorOperatingSystemVersion;
+            std::uint16_t MinorOperatingSystemVersion;
+            std::uint16_t MajorImageVersion;
+            std::uint16_t MinorImageVersion;
+            std::uint16_t MajorSubsystemVersion;
+            std::uint16_t MinorSubsystemVersion;
+            std::uint32_t Win32VersionValue;
+            std::uint32_t SizeOfImage;
+            std::uint32_t SizeOfHeaders;
+            std::uint32_t CheckSum;
+            std::uint16_t Subsystem;
+            std::uint16_t DllCharacteristics;
+            std::uint32_t SizeOfStackReserve;
+            std::uint32_t SizeOfStackCommit;
+            std::uint32_t SizeOfHeapReserve;
+            std::uint32_t SizeOfHeapCommit;
+            std::uint32_t LoaderFlags;
+            std::uint32_t NumberOfRvaAndSizes;
+        };
+
+        constexpr auto DescribeLayout(const OptionalHeader32*)
+        {
+            return Memory::StructLayout<OptionalHeader32,
+                &OptionalHeader32::Magic,
+                &OptionalHeader32::MajorLinkerVersion,
+                &OptionalHeader32::MinorLinkerVersion,
+                &OptionalHeader32::SizeOfCode,
+                &OptionalHeader32::SizeOfInitializedData,
+                &OptionalHeader32::SizeOfUninitializedData,
+                &OptionalHeader32::AddressOfEntryPoint,
+                &OptionalHeader32::BaseOfCode,
+                &OptionalHeader32::BaseOfData,
+                &OptionalHeader32::ImageBase,
+                &OptionalHeader32::SectionAlignment,
+                &OptionalHeader32::FileAlignment,
+                &OptionalHeader32::MajorOperatingSystemVersion,
+                &OptionalHeader32::MinorOperatingSystemVersion,
+                &OptionalHeader32::MajorImageVersion,
+                &OptionalHeader32::MinorImageVersion,
+                &OptionalHeader32::MajorSubsystemVersion,
+                &OptionalHeader32::MinorSubsystemVersion,
+                &OptionalHeader32::Win32VersionValue,
+                &OptionalHeader32::SizeOfImage,
+                &OptionalHeader32::SizeOfHeaders,
+                &OptionalHeader32::CheckSum,
+                &OptionalHeader32::Subsystem,
+                &OptionalHeader32::DllCharacteristics,
+                &OptionalHeader32::SizeOfStackReserve,
+                &OptionalHeader32::SizeOfStackCommit,
+                &OptionalHeader32::SizeOfHeapReserve,
+                &OptionalHeader32::SizeOfHeapCommit,
+                &OptionalHeader32::LoaderFlags,
+                &OptionalHeader32::NumberOfRvaAndSizes>{};
+        }
+
+        // IMAGE_OPTIONAL_HEADER64 without data directories, as stored in the file
+        struct OptionalHeader64
+        {
+            std::uint16_t Magic;
+            std::uint8_t MajorLinkerVersion;
+            std::uint8_t MinorLinkerVersion;
+            std::uint32_t SizeOfCode;
+            std::uint32_t SizeOfInitializedData;
+            std::uint32_t SizeOfUninitializedData;
+            std::uint32_t AddressOfEntryPoint;
+            std::uint32_t BaseOfCode;
+            std::uint64_t ImageBase;
+            std::uint32_t SectionAlignment;
+            std::uint32_t FileAlignment;
+            std::uint16_t MajorOperatingSystemVersion;
+            std::uint16_t MinorOperatingSystemVersion;
+            std::uint16_t MajorImageVersion;
+            std::uint16_t MinorImageVersion;
+            std::uint16_t MajorSubsystemVersion;
+            std::uint16_t MinorSubsystemVersion;
+            std::uint32_t Win32VersionValue;
+            std::uint32_t SizeOfImage;
+            std::uint32_t SizeOfHeaders;
+            std::uint32_t CheckSum;
+            std::uint16_t Subsystem;
+            std::uint16_t DllCharacteristics;
+            std::uint64_t SizeOfStackReserve;
+            std::uint64_t SizeOfStackCommit;
+            std::uint64_t SizeOfHeapReserve;
+            std::uint64_t SizeOfHeapCommit;
+            std::uint32_t LoaderFlags;
+            std::uint32_t NumberOfRvaAndSizes;
+        };
+
+        constexpr auto DescribeLayout(const OptionalHeader64*)
+        {
+            return Memory::StructLayout<OptionalHeader64,
+                &OptionalHeader64::Magic,
+                &OptionalHeader64::MajorLinkerVersion,
+                &OptionalHeader64::MinorLinkerVersion,
+                &OptionalHeader64::SizeOfCode,
+                &OptionalHeader64::SizeOfInitializedData,
+                &OptionalHeader64::SizeOfUninitializedData,
+                &OptionalHeader64::AddressOfEntryPoint,
+                &OptionalHeader64::BaseOfCode,
+                &OptionalHeader64::ImageBase,
+                &OptionalHeader64::SectionAlignment,
+                &OptionalHeader64::FileAlignment,
+                &OptionalHeader64::MajorOperatingSystemVersion,
+                &OptionalHeader64::MinorOperatingSystemVersion,
+                &OptionalHeader64::MajorImageVersion,
+                &OptionalHeader64::MinorImageVersion,
+                &OptionalHeader64::MajorSubsystemVersion,
+                &OptionalHeader64::MinorSubsystemVersion,
+                &OptionalHeader64::Win32VersionValue,
+                &OptionalHeader64::SizeOfImage,
+                &OptionalHeader64::SizeOfHeaders,
+                &OptionalHeader64::CheckSum,
+                &OptionalHeader64::Subsystem,
+                &OptionalHeader64::DllCharacteristics,
+                &OptionalHeader64::SizeOfStackReserve,
+                &OptionalHeader64::SizeOfStackCommit,
+                &OptionalHeader64::SizeOfHeapReserve,
+                &OptionalHeader64::SizeOfHeapCommit,
+                &OptionalHeader64::LoaderFlags,
+                &OptionalHeader64::NumberOfRvaAndSizes>{};
+        }
+
+        // PE signature, COFF file header, the largest optional header and all data directories.
+        // Headers are decoded from a single view of this length
+        constexpr std::size_t PE_NT_HEADERS_MAXIMUM_LENGTH
+            = sizeof(std::uint32_t) + sizeof(CoffFileHeader) + sizeof(OptionalHeader64)
+            + IMAGE_NUMBEROF_DIRECTORY_ENTRIES * sizeof(DataDirectory);
+
+        // IMAGE_SECTION_HEADER::Characteristics flags
+        constexpr std::uint32_t IMAGE_SCN_CNT_CODE = 0x00000020;
+        constexpr std::uint32_t IMAGE_SCN_CNT_INITIALIZED_DATA = 0x00000040;
+        constexpr std::uint32_t IMAGE_SCN_CNT_UNINITIALIZED_DATA = 0x00000080;
+        constexpr std::uint32_t IMAGE_SCN_MEM_DISCARDABLE = 0x02000000;
+        constexpr std::uint32_t IMAGE_SCN_MEM_SHARED = 0x10000000;
+        constexpr std::uint32_t IMAGE_SCN_MEM_EXECUTE = 0x20000000;
+        constexpr std::uint32_t IMAGE_SCN_MEM_READ = 0x40000000;
+        constexpr std::uint32_t IMAGE_SCN_MEM_WRITE = 0x80000000;
+
+        constexpr std::size_t IMAGE_SIZEOF_SHORT_NAME = 8;
+
+        // The loader rounds PointerToRawData down to this value, if FileAlignment is not less than it
+        constexpr std::uint32_t SECTION_RAW_DATA_MINIMUM_ALIGNMENT = 0x200;
+
+        // IMAGE_SECTION_HEADER
+        struct SectionHeader
+        {
+            // Not null-terminated, if it is 8 characters long
+            std::uint8_t Name[IMAGE_SIZEOF_SHORT_NAME];
+            // Misc.VirtualSize
+            std::uint32_t VirtualSize;
+            std::uint32_t VirtualAddress;
+            std::uint32_t SizeOfRawData;
+            std::uint32_t PointerToRawData;
+            std::uint32_t PointerToRelocations;
+            std::uint32_t PointerToLinenumbers;
+            std::uint16_t NumberOfRelocations;
+            std::uint16_t NumberOfLinenumbers;
+            std::uint32_t Characteristics;
+
+            std::string_view name() const
+            {
+                const char* str = reinterpret_cast<const char*>(Name);
+                return { str, std::find(str, str + IMAGE_SIZEOF_SHORT_NAME, '\0') };
+            }
+        };
+
+        constexpr auto DescribeLayout(const SectionHeader*)
+        {
+            return Memory::StructLayout<SectionHeader,
+                &SectionHeader::Name,
+                &SectionHeader::VirtualSize,
+                &SectionHeader::VirtualAddress,
+                &SectionHeader::SizeOfRawData,
+                &SectionHeader::PointerToRawData,
+                &SectionHeader::PointerToRelocations,
+                &SectionHeader::PointerToLinenumbers,
+                &SectionHeader::NumberOfRelocations,
+                &SectionHeader::NumberOfLinenumbers,
+                &SectionHeader::Characteristics>{};
+        }
+
+        // Import lookup table entries with this bit set import by ordinal
+        constexpr std::uint32_t IMAGE_ORDINAL_FLAG32 = 0x80000000;
+        constexpr std::uint64_t IMAGE_ORDINAL_FLAG64 = 0x8000000000000000;
+
+        // IMAGE_IMPORT_DESCRIPTOR
+        struct ImportDescriptor
+        {
+            // The import lookup table. Old linkers leave it zero, then FirstThunk is used
+            std::uint32_t OriginalFirstThunk;
+            std::uint32_t TimeDateStamp;
+            std::uint32_t ForwarderChain;
+            std::uint32_t Name;
+            // The import address table
+            std::uint32_t FirstThunk;
+
+            // The loader stops at the first descriptor without a name or an address table
+            bool terminates() const { return Name == 0 || FirstThunk == 0; }
+        };
+
+        constexpr auto DescribeLayout(const ImportDescriptor*)
+        {
+            return Memory::StructLayout<ImportDescriptor,
+                &ImportDescriptor::OriginalFirstThunk,
+                &ImportDescriptor::TimeDateStamp,
+                &ImportDescriptor::ForwarderChain,
+                &ImportDescriptor::Name,
+                &ImportDescriptor::FirstThunk>{};
+        }
+
+        // IMAGE_EXPORT_DIRECTORY
+        struct ExportDirectoryTable
+        {
+            std::uint32_t Characteristics;
+            std::uint32_t TimeDateStamp;
+            std::uint16_t MajorVersion;
+            std::uint16_t MinorVersion;
+            std::uint32_t Name;
+            // The ordinal of the first export address table entry
+            std::uint32_t Base;
+            std::uint32_t NumberOfFunctions;
+            std::uint32_t NumberOfNames;
+            std::uint32_t AddressOfFunctions;
+            // Sorted by names, so names may be binary searched
+            std::uint32_t AddressOfNames;
+            // Unbiased indices into the export address table, parallel to the names
+            std::uint32_t AddressOfNameOrdinals;
+        };
+
+        constexpr auto DescribeLayout(const ExportDirectoryTable*)
+        {
+            return Memory::StructLayout<ExportDirectoryTable,
+                &ExportDirectoryTable::Characteristics,
+                &ExportDirectoryTable::TimeDateStamp,
+                &ExportDirectoryTable::MajorVersion,
+                &ExportDirectoryTable::MinorVersion,
+                &ExportDirectoryTable::Name,
+                &ExportDirectoryTable::Base,
+                &ExportDirectoryTable::NumberOfFunctions,
+                &ExportDirectoryTable::NumberOfNames,
+                &ExportDirectoryTable::AddressOfFunctions,
+                &ExportDirectoryTable::AddressOfNames,
+                &ExportDirectoryTable::AddressOfNameOrdinals>{};
+        }
+
+        // Predefined resource types
+        constexpr std::uint16_t RT_CURSOR = 1;
+        constexpr std::uint16_t RT_BITMAP = 2;
+        constexpr std::uint16_t RT_ICON = 3;
+        constexpr std::uint16_t RT_MENU = 4;
+        constexpr std::uint16_t RT_DIALOG = 5;
+        constexpr std::uint16_t RT_STRING = 6;
+        constexpr std::uint16_t RT_RCDATA = 10;
+        constexpr std::uint16_t RT_GROUP_CURSOR = 12;
+        constexpr std::uint16_t RT_GROUP_ICON = 14;
+        constexpr std::uint16_t RT_VERSION = 16;
+        constexpr std::uint16_t RT_MANIFEST = 24;
+
+        // Set in IMAGE_RESOURCE_DIRECTORY_ENTRY::Name, if the entry is named by a string
+        constexpr std::uint32_t IMAGE_RESOURCE_NAME_IS_STRING = 0x80000000;
+        // Set in IMAGE_RESOURCE_DIRECTORY_ENTRY::OffsetToData, if the entry is a subdirectory
+        constexpr std::uint32_t IMAGE_RESOURCE_DATA_IS_DIRECTORY = 0x80000000;
+
+        // IMAGE_RESOURCE_DIRECTORY. Followed by named entries, then by entries with IDs
+        struct ResourceDirectoryTable
+        {
+            std::uint32_t Characteristics;
+            std::uint32_t TimeDateStamp;
+            std::uint16_t MajorVersion;
+            std::uint16_t MinorVersion;
+            std::uint16_t NumberOfNamedEntries;
+            std::uint16_t NumberOfIdEntries;
+        };
+
+        constexpr auto DescribeLayout(const ResourceDirectoryTable*)
+        {
+            return Memory::StructLayout<ResourceDirectoryTable,
+                &ResourceDirectoryTable::Characteristics,
+                &ResourceDirectoryTable::TimeDateStamp,
+                &ResourceDirectoryTable::MajorVersion,
+                &ResourceDirectoryTable::MinorVersion,
+                &ResourceDirectoryTable::NumberOfNamedEntries,
+                &ResourceDirectoryTable::NumberOfIdEntries>{};
+        }
+
+        // IMAGE_RESOURCE_DIRECTORY_ENTRY. Offsets are relative to the resource directory start
+        struct ResourceDirectoryEntry
+        {
+            // An ID, or an offset of a length-prefixed UTF-16 name
+            std::uint32_t Name;
+            // An offset of a subdirectory or of a data entry
+            std::uint32_t OffsetToData;
+
+            bool isNamed() const { return (Name & IMAGE_RESOURCE_NAME_IS_STRING) != 0; }
+            bool isDirectory() const { return (OffsetToData & IMAGE_RESOURCE_DATA_IS_DIRECTORY) != 0; }
+            std::uint32_t nameOffset() const { return Name & ~IMAGE_RESOURCE_NAME_IS_STRING; }
+            std::uint32_t dataOffset() const { return OffsetToData & ~IMAGE_RESOURCE_DATA_IS_DIRECTORY; }
+        };
+
+        constexpr auto DescribeLayout(const ResourceDirectoryEntry*)
+        {
+            return Memory::StructLayout<ResourceDirectoryEntry,
+                &ResourceDirectoryEntry::Name,
+                &ResourceDirectoryEntry::OffsetToData>{};
+        }
+
+        // IMAGE_RESOURCE_DATA_ENTRY
+        struct ResourceDataEntry
+        {
+            // An RVA, unlike offsets in directories
+            std::uint32_t OffsetToData;
+            std::uint32_t Size;
+            std::uint32_t CodePage;
+            std::uint32_t Reserved;
+        };
+
+        constexpr auto DescribeLayout(const ResourceDataEntry*)
+        {
+            return Memory::StructLayout<ResourceDataEntry,
+                &ResourceDataEntry::OffsetToData,
+                &ResourceDataEntry::Size,
+                &ResourceDataEntry::CodePage,
+                &ResourceDataEntry::Reserved>{};
+        }
+
+        constexpr std::uint32_t VS_FFI_SIGNATURE = 0xFEEF04BD;
+
+        // VS_FIXEDFILEINFO
+        struct FixedFileInfo
+        {
+            std::uint32_t dwSignature;
+            std::uint32_t dwStrucVersion;
+            std::uint32_t dwFileVersionMS;
+            std::uint32_t dwFileVersionLS;
+            std::uint32_t dwProductVersionMS;
+            std::uint32_t dwProductVersionLS;
+            std::uint32_t dwFileFlagsMask;
+            std::uint32_t dwFileFlags;
+            std::uint32_t dwFileOS;
+            std::uint32_t dwFileType;
+            std::uint32_t dwFileSubtype;
+            std::uint32_t dwFileDateMS;
+            std::uint32_t dwFileDateLS;
+        };
+
+        constexpr auto DescribeLayout(const FixedFileInfo*)
+        {
+            return Memory::StructLayout<FixedFileInfo,
+                &FixedFileInfo::dwSignature,
+                &FixedFileInfo::dwStrucVersion,
+                &FixedFileInfo::dwFileVersionMS,
+                &FixedFileInfo::dwFileVersionLS,
+                &FixedFileInfo::dwProductVersionMS,
+                &FixedFileInfo::dwProductVersionLS,
+                &FixedFileInfo::dwFileFlagsMask,
+                &FixedFileInfo::dwFileFlags,
+                &FixedFileInfo::dwFileOS,
+                &FixedFileInfo::dwFileType,
+                &FixedFileInfo::dwFileSubtype,
+                &FixedFileInfo::dwFileDateMS,
+                &FixedFileInfo::dwFileDateLS>{};
+        }
+
+        // Base relocation types, stored in the upper 4 bits of an entry
+        constexpr std::uint16_t IMAGE_REL_BASED_ABSOLUTE = 0;
+        constexpr std::uint16_t IMAGE_REL_BASED_HIGH = 1;
+        constexpr std::uint16_t IMAGE_REL_BASED_LOW = 2;
+        constexpr std::uint16_t IMAGE_REL_BASED_HIGHLOW = 3;
+        // Takes the following entry as the low half of the adjusted value
+        constexpr std::uint16_t IMAGE_REL_BASED_HIGHADJ = 4;
+        constexpr std::uint16_t IMAGE_REL_BASED_DIR64 = 10;
+
+        // Entries address a page of this size
+        constexpr std::uint32_t BASE_RELOCATION_PAGE_SIZE = 0x1000;
+
+        // IMAGE_BASE_RELOCATION. Followed by 16-bit entries up to SizeOfBlock
+        struct BaseRelocationBlock
+        {
+            std::uint32_t VirtualAddress;
+            std::uint32_t SizeOfBlock;
+        };
+
+        constexpr auto DescribeLayout(const BaseRelocationBlock*)
+        {
+            return Memory::StructLayout<BaseRelocationBlock,
+                &BaseRelocationBlock::VirtualAddress,
+                &BaseRelocationBlock::SizeOfBlock>{};
+        }
+
+        // IMAGE_AMD64_RUNTIME_FUNCTION_ENTRY, an entry of the x64 exception directory
+        struct Amd64RuntimeFunctionEntry
+        {
+            std::uint32_t BeginAddress;
+            // Exclusive
+            std::uint32_t EndAddress;
+            // UNWIND_INFO, or another entry sharing it, if the low bit is set
+            std::uint32_t UnwindInfoAddress;
+        };
+
+        constexpr auto DescribeLayout(const Amd64RuntimeFunctionEntry*)
+        {
+            return Memory::StructLayout<Amd64RuntimeFunctionEntry,
+                &Amd64RuntimeFunctionEntry::BeginAddress,
+                &Amd64RuntimeFunctionEntry::EndAddress,
+                &Amd64RuntimeFunctionEntry::UnwindInfoAddress>{};
+        }
+
+        // IMAGE_ARM64_RUNTIME_FUNCTION_ENTRY, an entry of the ARM64 exception directory
+        struct Arm64RuntimeFunctionEntry
+        {
+            std::uint32_t BeginAddress;
+            // An .xdata record RVA, or packed unwind data, if the low two bits are not zero
+            std::uint32_t UnwindData;
+        };
+
+        constexpr auto DescribeLayout(const Arm64RuntimeFunctionEntry*)
+        {
+            return Memory::StructLayout<Arm64RuntimeFunctionEntry,
+                &Arm64RuntimeFunctionEntry::BeginAddress,
+                &Arm64RuntimeFunctionEntry::UnwindData>{};
+        }
+
+        // Flags of x64 UNWIND_INFO
+        constexpr std::uint8_t UNW_FLAG_NHANDLER = 0x0;
+        constexpr std::uint8_t UNW_FLAG_EHANDLER = 0x1;
+        constexpr std::uint8_t UNW_FLAG_UHANDLER = 0x2;
+        // Unwind codes are followed by the entry of the primary function
+        constexpr std::uint8_t UNW_FLAG_CHAININFO = 0x4;
+
+        // The low bit of UnwindInfoAddress, which makes it point to another entry
+        constexpr std::uint32_t RUNTIME_FUNCTION_INDIRECT = 0x1;
+
+        // Types of debug directory entries
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_UNKNOWN = 0;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_COFF = 1;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_CODEVIEW = 2;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_FPO = 3;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_MISC = 4;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_EXCEPTION = 5;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_FIXUP = 6;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_OMAP_TO_SRC = 7;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_OMAP_FROM_SRC = 8;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_BORLAND = 9;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_CLSID = 11;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_VC_FEATURE = 12;
+        // Profile guided optimization data: the signature and the contributions of code sections
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_POGO = 13;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_ILTCG = 14;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_MPX = 15;
+        // A deterministic build. The data, if any, is a length-prefixed hash of the build inputs
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_REPRO = 16;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_EMBEDDED_PORTABLE_PDB = 17;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_PDBCHECKSUM = 19;
+        constexpr std::uint32_t IMAGE_DEBUG_TYPE_EX_DLLCHARACTERISTICS = 20;
+
+        // IMAGE_DEBUG_DIRECTORY
+        struct DebugDirectoryEntry
+        {
+            std::uint32_t Characteristics;
+            std::uint32_t TimeDateStamp;
+            std::uint16_t MajorVersion;
+            std::uint16_t MinorVersion;
+            // IMAGE_DEBUG_TYPE_*
+            std::uint32_t Type;
+            std::uint32_t SizeOfData;
+            // Zero, if the data isn't mapped by the loader
+            std::uint32_t AddressOfRawData;
+            // Zero, if the data isn't in the file
+            std::uint32_t PointerToRawData;
+        };
+
+        constexpr auto DescribeLayout(const DebugDirectoryEntry*)
+        {
+            return Memory::StructLayout<DebugDirectoryEntry,
+                &DebugDirectoryEntry::Characteristics,
+                &DebugDirectoryEntry::TimeDateStamp,
+                &DebugDirectoryEntry::MajorVersion,
+                &DebugDirectoryEntry::MinorVersion,
+                &DebugDirectoryEntry::Type,
+                &DebugDirectoryEntry::SizeOfData,
+                &DebugDirectoryEntry::AddressOfRawData,
+                &DebugDirectoryEntry::PointerToRawData>{};
+        }
+
+        // MinorVersion of CodeView entries referencing portable PDBs, "PM"
+        constexpr std::uint16_t PORTABLE_PDB_CODEVIEW_MINOR_VERSION = 0x504D;
+
+        // First dwords of CodeView records, "RSDS" and "NB10"
+        constexpr std::uint32_t CODEVIEW_RSDS_SIGNATURE = 0x53445352;
+        constexpr std::uint32_t CODEVIEW_NB10_SIGNATURE = 0x3031424E;
+
+        // GUID as stored in files: the first three fields are little endian
+        struct Guid
+        {
+            std::uint32_t Data1;
+            std::uint16_t Data2;
+            std::uint16_t Data3;
+            std::uint8_t Data4[8];
+
+            bool operator==(const Guid&) const = default;
+        };
+
+        constexpr auto DescribeLayout(const Guid*)
+        {
+            return Memory::StructLayout<Guid,
+                &Guid::Data1,
+                &Guid::Data2,
+                &Guid::Data3,
+                &Guid::Data4>{};
+        }
+
+        // CV_INFO_PDB70. Followed by the null-terminated UTF-8 PDB path
+        struct CodeViewRsdsHeader
+        {
+            std::uint32_t Signature;
+            Guid PdbGuid;
+            std::uint32_t Age;
+        };
+
+        constexpr auto DescribeLayout(const CodeViewRsdsHeader*)
+        {
+            return Memory::StructLayout<CodeViewRsdsHeader,
+                &CodeViewRsdsHeader::Signature,
+                &CodeViewRsdsHeader::PdbGuid,
+                &CodeViewRsdsHeader::Age>{};
+        }
+
+        // CV_INFO_PDB20. Followed by the null-terminated PDB path
+        struct CodeViewNb10Header
+        {
+            std::uint32_t Signature;
+            // Always zero
+            std::uint32_t Offset;
+            // A timestamp, which identifies the PDB instead of a GUID
+            std::uint32_t PdbSignature;
+            std::uint32_t Age;
+        };
+
+        constexpr auto DescribeLayout(const CodeViewNb10Header*)
+        {
+            return Memory::StructLayout<CodeViewNb10Header,
+                &CodeViewNb10Header::Signature,
+                &CodeViewNb10Header::Offset,
+                &CodeViewNb10Header::PdbSignature,
+                &CodeViewNb10Header::Age>{};
+        }
+
+        // POGO data signatures. The linker stores them reversed, e.g. "PGU" as "\0UGP"
+        constexpr std::uint32_t POGO_SIGNATURE_LTCG = 0x4C544347;
+        constexpr std::uint32_t POGO_SIGNATURE_PGI = 0x50474900;
+        constexpr std::uint32_t POGO_SIGNATURE_PGO = 0x50474F00;
+        constexpr std::uint32_t POGO_SIGNATURE_PGU = 0x50475500;
+
+        // Flags of the CLR header
+        constexpr std::uint32_t COMIMAGE_FLAGS_ILONLY = 0x00000001;
+        constexpr std::uint32_t COMIMAGE_FLAGS_32BITREQUIRED = 0x00000002;
+        constexpr std::uint32_t COMIMAGE_FLAGS_IL_LIBRARY = 0x00000004;
+        constexpr std::uint32_t COMIMAGE_FLAGS_STRONGNAMESIGNED = 0x00000008;
+        // EntryPointToken is an RVA of a native entry point instead of a method token
+        constexpr std::uint32_t COMIMAGE_FLAGS_NATIVE_ENTRYPOINT = 0x00000010;
+        constexpr std::uint32_t COMIMAGE_FLAGS_TRACKDEBUGDATA = 0x00010000;
+        constexpr std::uint32_t COMIMAGE_FLAGS_32BITPREFERRED = 0x00020000;
+
+        // IMAGE_COR20_HEADER, pointed to by the ComDescriptor directory
+        struct Cor20Header
+        {
+            // The header length
+            std::uint32_t cb;
+            std::uint16_t MajorRuntimeVersion;
+            std::uint16_t MinorRuntimeVersion;
+            // The metadata root, see ClrMetadata
+            DataDirectory MetaData;
+            // COMIMAGE_FLAGS_*
+            std::uint32_t Flags;
+            // A MethodDef or File token, or an RVA if COMIMAGE_FLAGS_NATIVE_ENTRYPOINT is set
+            std::uint32_t EntryPointToken;
+            DataDirectory Resources;
+            DataDirectory StrongNameSignature;
+            DataDirectory CodeManagerTable;
+            DataDirectory VTableFixups;
+            DataDirectory ExportAddressTableJumps;
+            // The ReadyToRun header of precompiled images
+            DataDirectory ManagedNativeHeader;
+        };
+
+        constexpr auto DescribeLayout(const Cor20Header*)
+        {
+            return Memory::StructLayout<Cor20Header,
+                &Cor20Header::cb,
+                &Cor20Header::MajorRuntimeVersion,
+                &Cor20Header::MinorRuntimeVersion,
+                &Cor20Header::MetaData,
+                &Cor20Header::Flags,
+                &Cor20Header::EntryPointToken,
+                &Cor20Header::Resources,
+                &Cor20Header::StrongNameSignature,
+                &Cor20Header::CodeManagerTable,
+                &Cor20Header::VTableFixups,
+                &Cor20Header::ExportAddressTableJumps,
+                &Cor20Header::ManagedNativeHeader>{};
+        }
+
+        // The first dword of the metadata root, "BSJB"
+        constexpr std::uint32_t CLR_METADATA_SIGNATURE = 0x424A5342;
+
+        // An optional header of either PE32 or PE32+ image.
+        // PE32 fields are zero-extended, BaseOfData is zero in PE32+ images
+        struct OptionalHeader
+        {
+            std::uint16_t Magic;
+            std::uint8_t MajorLinkerVersion;
+            std::uint8_t MinorLinkerVersion;
+            std::uint32_t SizeOfCode;
+            std::uint32_t SizeOfInitializedData;
+            std::uint32_t SizeOfUninitializedData;
+            std::uint32_t AddressOfEntryPoint;
+            std::uint32_t BaseOfCode;
+            std::uint32_t BaseOfData;
+            std::uint64_t ImageBase;
+            std::uint32_t SectionAlignment;
+            std::uint32_t FileAlignment;
+            std::uint16_t MajorOperatingSystemVersion;
+            std::uint16_t MinorOperatingSystemVersion;
+            std::uint16_t MajorImageVersion;
+            std::uint16_t MinorImageVersion;
+            std::uint16_t MajorSubsystemVersion;
+            std::uint16_t MinorSubsystemVersion;
+            std::uint32_t Win32VersionValue;
+            std::uint32_t SizeOfImage;
+            std::uint32_t SizeOfHeaders;
+            std::uint32_t CheckSum;
+            std::uint16_t Subsystem;
+            std::uint16_t DllCharacteristics;
+            std::uint64_t SizeOfStackReserve;
+            std::uint64_t SizeOfStackCommit;
+            std::uint64_t SizeOfHeapReserve;
+            std::uint64_t SizeOfHeapCommit;
+            std::uint32_t LoaderFlags;
+            std::uint32_t NumberOfRvaAndSizes;
+
+            bool IsPe32Plus() const { return Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC; }
+        };
+
+        struct PeFileMetadata
+        {
+            PeFileMetadata()
+                : ntHeadersLoc{},
+                coffHeader{},
+                optionalHeader{},
+                dataDirectories{},
+                dataDirectoriesCount{},
+                sectionTableLoc{}
+            {
+            }
+
+            // The signature, the COFF file header and the optional header
+            FileLocation ntHeadersLoc;
+            CoffFileHeader coffHeader;
+            OptionalHeader optionalHeader;
+            // Directories beyond dataDirectoriesCount are zero
+            std::array<DataDirectory, IMAGE_NUMBEROF_DIRECTORY_ENTRIES> dataDirectories;
+            // NumberOfRvaAndSizes limited by the optional header length and IMAGE_NUMBEROF_DIRECTORY_ENTRIES
+            std::uint32_t dataDirectoriesCount;
+            // Follows the optional header. Section headers are read on demand through PeExecutable views
+            FileLocation sectionTableLoc;
+
+            const DataDirectory& dataDirectory(DataDirectoryIndex index) const
+            {
+                return dataDirectories[static_cast<std::size_t>(index)];
+            }
+
+            // File offsets of header fields, e.g. to exclude them from a hash or to patch them
+
+            std::uint64_t optionalHeaderOffset() const
+            {
+                return ntHeadersLoc.AbsoluteOffset + sizeof(std::uint32_t) + sizeof(CoffFileHeader);
+            }
+
+            // CheckSum is at the same offset in PE32 and PE32+ headers
+            std::uint64_t checkSumOffset() const
+            {
+                return optionalHeaderOffset() + offsetof(OptionalHeader32, CheckSum);
+            }
+
+            // Meaningful only for directories below dataDirectoriesCount
+            std::uint64_t dataDirectoryOffset(DataDirectoryIndex index) const
+            {
+                std::size_t fixedPartLength = optionalHeader.IsPe32Plus() ? sizeof(OptionalHeader64) : sizeof(OptionalHeader32);
+                return optionalHeaderOffset() + fixedPartLength + static_cast<std::size_t>(index) * sizeof(DataDirectory);
+            }
+        };
+
         /*class EYESOLPEREADER_API Pe32File
         {
         public:
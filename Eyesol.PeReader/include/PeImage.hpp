@@ -0,0 +1,43 @@
+#if !defined _PE_IMAGE_H_
+#	define _PE_IMAGE_H_
+#	include <span>
+#	include "MemoryMappedIO.hpp"
+#	include "PeHeaders.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	class PeExecutable;
+
+	// The image laid out the way the loader maps it: the headers and the sections at their RVAs,
+	// zero-filled up to their virtual sizes. Intervals aligned in the file the same way as in memory
+	// are mapped copy-on-write page by page, only the misaligned ones are copied.
+	// The memory is private and writable, so the image may be patched, e.g. by ApplyBaseRelocations.
+	// Copies of the object share the memory
+	class EYESOLPEREADER_API PeImage
+	{
+	public:
+		PeImage() noexcept;
+
+		// Returns ErrorCode::BadOptionalHeader if SizeOfImage is zero,
+		// and ErrorCode::OutOfMemory if the image doesn't fit into the address space or its pages couldn't be restored
+		// after a failed attempt to map a section view
+		static Result<PeImage> Create(const PeExecutable& exe);
+
+		// SizeOfImage bytes
+		std::span<unsigned char> data() noexcept { return { _memory.data(), _size }; }
+		std::span<const unsigned char> data() const noexcept { return { _memory.data(), _size }; }
+		std::size_t size() const noexcept { return _size; }
+
+		// File bytes mapped into the image without copying
+		std::uint64_t mappedBytes() const noexcept { return _mappedBytes; }
+		// File bytes copied into the image
+		std::uint64_t copiedBytes() const noexcept { return _copiedBytes; }
+
+	private:
+		MemoryMappedIO::PrivateMemory _memory;
+		std::size_t _size;
+		std::uint64_t _mappedBytes;
+		std::uint64_t _copiedBytes;
+	};
+}
+#endif
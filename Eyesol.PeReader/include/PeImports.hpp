@@ -0,0 +1,144 @@
+#if !defined _PE_IMPORTS_H_
+#	define _PE_IMPORTS_H_
+#	include <iterator>
+#	include <span>
+#	include <string_view>
+#	include "ErrorCodes.hpp"
+#	include "Hashing.hpp"
+#	include "PeHeaders.hpp"
+#	include "StringPool.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	class PeExecutable;
+
+	struct ImportedFunction
+	{
+		// Empty for imports by ordinal. Points into the mapped file
+		std::string_view name;
+		// A hint into the export name table of the module, for imports by name
+		std::uint16_t hint;
+		// The ordinal, for imports by ordinal
+		std::uint16_t ordinal;
+		bool byOrdinal;
+		// The import address table slot, which the loader writes the address to
+		std::uint32_t iatRva;
+	};
+
+	// Entries of an import lookup table, decoded in place.
+	// Iteration stops after the terminating entry or after the first error
+	class EYESOLPEREADER_API ImportedFunctions
+	{
+	public:
+		class EYESOLPEREADER_API Iterator
+		{
+		public:
+			using iterator_concept = std::input_iterator_tag;
+			using value_type = Result<ImportedFunction>;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator() noexcept;
+			explicit Iterator(const ImportedFunctions* owner);
+
+			const Result<ImportedFunction>& operator*() const noexcept { return _current; }
+			const Result<ImportedFunction>* operator->() const noexcept { return &_current; }
+
+			Iterator& operator++();
+			void operator++(int) { ++*this; }
+
+			bool operator==(std::default_sentinel_t) const noexcept { return _done; }
+
+		private:
+			void Load();
+
+			const ImportedFunctions* _owner;
+			std::size_t _index;
+			Result<ImportedFunction> _current;
+			bool _done;
+		};
+
+		ImportedFunctions() noexcept;
+		ImportedFunctions(const PeExecutable& exe, std::uint32_t lookupTableRva, std::uint32_t iatRva);
+
+		Iterator begin() const { return Iterator{ this }; }
+		std::default_sentinel_t end() const noexcept { return {}; }
+
+	private:
+		const PeExecutable* _exe;
+		// From the lookup table up to the end of its section data
+		Result<std::span<const unsigned char>> _thunks;
+		std::uint32_t _iatRva;
+		bool _pe32Plus;
+	};
+
+	class EYESOLPEREADER_API ImportedModule
+	{
+	public:
+		ImportedModule() noexcept;
+		ImportedModule(const PeExecutable& exe, const ImportDescriptor& descriptor, std::string_view name);
+
+		// Interned, so names of all parsed files share storage
+		std::string_view name() const noexcept { return _name; }
+		const ImportDescriptor& descriptor() const noexcept { return _descriptor; }
+
+		// Walks the lookup table, or the address table, if the image has no lookup table
+		ImportedFunctions functions() const;
+
+	private:
+		const PeExecutable* _exe;
+		ImportDescriptor _descriptor;
+		std::string_view _name;
+	};
+
+	// Import descriptors, decoded in place on iteration. Nothing is copied,
+	// except module names added to the string pool for the first time.
+	// The object must not outlive the executable
+	class EYESOLPEREADER_API ImportDirectory
+	{
+	public:
+		class EYESOLPEREADER_API Iterator
+		{
+		public:
+			using iterator_concept = std::input_iterator_tag;
+			using value_type = Result<ImportedModule>;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator() noexcept;
+			explicit Iterator(const ImportDirectory* owner);
+
+			const Result<ImportedModule>& operator*() const noexcept { return _current; }
+			const Result<ImportedModule>* operator->() const noexcept { return &_current; }
+
+			Iterator& operator++();
+			void operator++(int) { ++*this; }
+
+			bool operator==(std::default_sentinel_t) const noexcept { return _done; }
+
+		private:
+			void Load();
+
+			const ImportDirectory* _owner;
+			std::size_t _index;
+			Result<ImportedModule> _current;
+			bool _done;
+		};
+
+		// An empty directory, if the image imports nothing
+		ImportDirectory(const PeExecutable& exe, StringPool& pool);
+
+		Iterator begin() const { return Iterator{ this }; }
+		std::default_sentinel_t end() const noexcept { return {}; }
+
+		// MD5 of "module.function" pairs joined by commas, lowercased and without
+		// .dll, .ocx and .sys extensions. Ordinal imports are named "ord<N>".
+		// Hashed incrementally, the string itself is never built
+		Result<Hashing::Md5::Digest> ImpHash() const;
+
+	private:
+		const PeExecutable* _exe;
+		StringPool* _pool;
+		// From the first descriptor up to the end of its section data
+		Result<std::span<const unsigned char>> _descriptors;
+	};
+}
+#endif
@@ -1,34 +1,195 @@
 #if !defined _PE_PARSER_H_
 #	define _PE_PARSER_H_
+#	include <mutex>
+#	include "Entropy.hpp"
 #	include "MzParser.hpp"
+#	include "PeAuthenticode.hpp"
+#	include "PeChecksum.hpp"
+#	include "PeClr.hpp"
+#	include "PeDebug.hpp"
+#	include "PeExceptions.hpp"
 #	include "PeHeaders.hpp"
+#	include "PeExports.hpp"
+#	include "PeImage.hpp"
+#	include "PeImports.hpp"
+#	include "PeRelocations.hpp"
+#	include "PeResources.hpp"
+#	include "PeVersionInfo.hpp"
+#	include "PeSectionIndex.hpp"
 
 namespace Eyesol::Executables::Pe
 {
-	class PeParseContext;
+	struct PeParseContext : Mz::MzParseContext
+	{
+		PeFileMetadata peMetadata;
+		SectionIndex sectionIndex;
+		// Read once the section index is built
+		std::optional<Cor20Header> clrHeader;
+		virtual ~PeParseContext();
+	};
 
 	class PeExecutable : public Mz::MzExecutable
 	{
+	public:
+		const PeFileMetadata& peMetadata() const
+		{
+			return _peMetadata;
+		}
+
+		const CoffFileHeader& coffHeader() const
+		{
+			return _peMetadata.coffHeader;
+		}
+
+		const OptionalHeader& optionalHeader() const
+		{
+			return _peMetadata.optionalHeader;
+		}
+
+		// A zero directory, if the image doesn't contain it
+		const DataDirectory& dataDirectory(DataDirectoryIndex index) const
+		{
+			return _peMetadata.dataDirectory(index);
+		}
+
+		// Section headers are decoded on access, nothing is copied
+		SectionTable sections() const
+		{
+			const FileLocation& loc = _peMetadata.sectionTableLoc;
+			return file().View<PE_COFF_ENDIANNESS, SectionHeader>(loc.AbsoluteOffset, loc.Length / sizeof(SectionHeader));
+		}
+
+		const SectionIndex& sectionIndex() const
+		{
+			return _sectionIndex;
+		}
+
+		Result<std::uint64_t> RvaToOffset(std::uint32_t rva) const noexcept
+		{
+			return _sectionIndex.RvaToOffset(rva);
+		}
+
+		// Reads the data as the loader maps it. Bytes absent in the file are zeros
+		Result<void> ReadAtRva(std::uint32_t rva, void* buf, std::size_t length) const
+		{
+			return _sectionIndex.ReadAtRva(file(), rva, buf, length);
+		}
+
+		template <Memory::PrimitiveType T>
+		Result<T> ReadAtRva(std::uint32_t rva) const
+		{
+			return _sectionIndex.ReadAtRva<T>(file(), rva);
+		}
+
+		Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> ViewAtRva(std::uint32_t rva, std::size_t length) const
+		{
+			return _sectionIndex.ViewAtRva(file(), rva, length);
+		}
+
+		/* Views below point into section data, which is mapped once and kept while the executable is alive */
+
+		// The whole range must be present in the file
+		Result<std::span<const unsigned char>> BytesAtRva(std::uint32_t rva, std::size_t length) const;
+		// The file data from the RVA up to the end of its section data
+		Result<std::span<const unsigned char>> RawBytesFromRva(std::uint32_t rva) const;
+		// A null-terminated string. Returns ErrorCode::TruncatedData, if the section data ends before the null
+		Result<std::string_view> StringAtRva(std::uint32_t rva) const;
+
+		ImportDirectory imports(StringPool& pool = StringPool::Shared()) const;
+		// Validates the directory tables, so lookups only read them
+		Result<ExportDirectory> exports() const;
+		RelocationDirectory relocations() const;
+		// The runtime function table of x64 and ARM64 images, see ExceptionDirectory
+		Result<ExceptionDirectory> exceptions() const;
+		// Lays the image out in memory, see PeImage
+		Result<PeImage> MapImage() const;
+		ResourceTree resources(std::size_t budget = ResourceTree::DEFAULT_BUDGET) const;
+		// Descends straight to the first RT_VERSION resource, other resources are not decoded
+		Result<VersionInfo> GetVersionInfo() const;
+		// Maps the directory entries only
+		Result<DebugDirectory> debugDirectory() const;
+		// The Authenticode image hash, see ComputeAuthenticodeHash
+		AuthenticodeDigest AuthenticodeHash(Hashing::HashAlgorithm algorithm) const;
+		// The checksum of the file, see ComputePeChecksum. It is computed once, see ChecksumVerification
+		Result<std::uint32_t> actualChecksum() const;
+		// Empty, if CheckSum is zero, i.e. the image isn't checksummed
+		Result<std::optional<bool>> checksumValid() const;
+		// Data appended after the headers and the raw data of every section, e.g. a certificate table
+		// or an installer payload. Empty, if there is none
+		FileLocation overlay() const;
+		// Byte histograms of the raw data of sections in the section table order, limited by the file length.
+		// Packed sections usually have entropies above 7
+		Result<std::vector<Analysis::ByteHistogram>> SectionHistograms() const;
+		Result<Analysis::ByteHistogram> OverlayHistogram() const;
+		// Empty, if the image isn't a .NET assembly or its CLR header cannot be read
+		const std::optional<Cor20Header>& clrHeader() const
+		{
+			return _clrHeader;
+		}
+		// Maps the metadata only, see ClrMetadata
+		Result<ClrMetadata> clrMetadata() const;
+
+		// DotNetAssembly or DotNetMixedAssembly, if the image has a CLR header. Probes report Pe or Pe32Plus,
+		// as the header is found by an RVA, and it is read once sections are known
 		virtual ExecutableObjectFormat format() const override;
 		virtual ExecutableType type() const override;
 		virtual Eyesol::Cpu::ArchType arch() const override;
 
 		virtual uint64_t length() const override;
 
-		virtual bool ContainsDebugInfo() const;
-		virtual std::shared_ptr<DebugInfo> GetDebugInfo() const;
+		// Whether the image references a PDB by a valid CodeView record
+		virtual bool ContainsDebugInfo() const override;
+		// The PdbDebugInfo of the first CodeView entry. Throws, if there is none, see ThrowError
+		virtual std::shared_ptr<DebugInfo> GetDebugInfo() const override;
+
+		// Takes the metadata over from the context
+		void init(MemoryMappedIO::MemoryMappedFile file, PeParseContext&& ctx);
+
+	private:
+		PeFileMetadata _peMetadata;
+		SectionIndex _sectionIndex;
+		std::optional<Cor20Header> _clrHeader;
+
+		// Raw data of an interval of the section index, mapped on the first access
+		Result<std::span<const unsigned char>> intervalData(std::size_t interval) const;
 
-		void init(MemoryMappedIO::MemoryMappedFile file, PeParseContext& ctx);
+		struct IntervalData
+		{
+			std::once_flag mapped;
+			Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> data;
+		};
+
+		// An entry for every interval of the section index, in the index order
+		mutable std::unique_ptr<IntervalData[]> _intervalsData;
+
+		mutable std::once_flag _checksumComputed;
+		mutable Result<std::uint32_t> _actualChecksum;
 	};
 
 	class EYESOLPEREADER_API PeParser : public Mz::MzParser
 	{
+	public:
+		explicit PeParser(ChecksumVerification checksumVerification = ChecksumVerification::Lazy) noexcept;
+
+		ChecksumVerification checksumVerification() const noexcept
+		{
+			return _checksumVerification;
+		}
+
 	protected:
-		virtual bool TryParseTypeAndFormat(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, Mz::MzDosHeader& header, Mz::MzParseContext* ctx) const override;
-		virtual std::shared_ptr<Mz::MzExecutable> ParseExecutable(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, Mz::MzParseContext& ctx) const override;
+		virtual Result<void> TryParseTypeAndFormat(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, Mz::MzDosHeader& header, Mz::MzParseContext* ctx) const override;
+		virtual Result<std::shared_ptr<Mz::MzExecutable>> ParseExecutable(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, Mz::MzParseContext& ctx) const override;
 		virtual std::uint32_t CalculateActualMzDataLength(const MemoryMappedIO::MemoryMappedFile& file, uint32_t precalculatedLength, const Mz::MzParseContext& ctx) const override;
 
 		virtual std::unique_ptr<Mz::MzParseContext> CreateParseContext() const override;
+
+	private:
+		// Decodes the signature, the COFF file header, the optional header and data directories
+		// from a single view at the offset. The view is the probe, if it covers the headers.
+		// Returns ErrorCode::UnknownFormat, if there is no PE signature
+		static Result<void> TryReadNtHeaders(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, std::uint32_t offset, PeFileMetadata& metadata);
+
+		ChecksumVerification _checksumVerification;
 	};
 }
-#endif
\ No newline at end of file
+#endif
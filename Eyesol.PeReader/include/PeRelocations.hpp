@@ -0,0 +1,111 @@
+#if !defined _PE_RELOCATIONS_H_
+#	define _PE_RELOCATIONS_H_
+#	include <iterator>
+#	include <span>
+#	include "ErrorCodes.hpp"
+#	include "PeHeaders.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	class PeExecutable;
+
+	struct BaseRelocation
+	{
+		std::uint32_t rva;
+		// IMAGE_REL_BASED_*
+		std::uint16_t type;
+	};
+
+	// Entries of a single IMAGE_BASE_RELOCATION block in the mapped file
+	class RelocationBlock
+	{
+	public:
+		RelocationBlock() noexcept
+			: _pageRva{},
+			_entries{}
+		{
+		}
+
+		RelocationBlock(std::uint32_t pageRva, std::span<const unsigned char> entries) noexcept
+			: _pageRva{ pageRva },
+			_entries{ entries.first(entries.size() / sizeof(std::uint16_t) * sizeof(std::uint16_t)) }
+		{
+		}
+
+		std::uint32_t pageRva() const noexcept { return _pageRva; }
+		// Including IMAGE_REL_BASED_ABSOLUTE padding
+		std::size_t size() const noexcept { return _entries.size() / sizeof(std::uint16_t); }
+		std::span<const unsigned char> entries() const noexcept { return _entries; }
+
+		std::uint16_t rawEntry(std::size_t index) const noexcept
+		{
+			std::uint16_t entry;
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(_entries.data() + index * sizeof(entry), entry);
+			return entry;
+		}
+
+		BaseRelocation operator[](std::size_t index) const noexcept
+		{
+			std::uint16_t entry = rawEntry(index);
+			return { _pageRva + (entry & 0x0FFF), static_cast<std::uint16_t>(entry >> 12) };
+		}
+
+	private:
+		std::uint32_t _pageRva;
+		std::span<const unsigned char> _entries;
+	};
+
+	// Blocks of the base relocation directory, decoded in place on iteration.
+	// The object must not outlive the executable
+	class EYESOLPEREADER_API RelocationDirectory
+	{
+	public:
+		// Iteration stops after the first error
+		class EYESOLPEREADER_API Iterator
+		{
+		public:
+			using iterator_concept = std::input_iterator_tag;
+			using value_type = Result<RelocationBlock>;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator() noexcept;
+			explicit Iterator(const RelocationDirectory* owner);
+
+			const Result<RelocationBlock>& operator*() const noexcept { return _current; }
+			const Result<RelocationBlock>* operator->() const noexcept { return &_current; }
+
+			Iterator& operator++();
+			void operator++(int) { ++*this; }
+
+			bool operator==(std::default_sentinel_t) const noexcept { return _done; }
+
+		private:
+			void Load();
+
+			const RelocationDirectory* _owner;
+			std::size_t _offset;
+			Result<RelocationBlock> _current;
+			bool _done;
+		};
+
+		// An empty directory, if the image has no relocations
+		explicit RelocationDirectory(const PeExecutable& exe);
+
+		Iterator begin() const { return Iterator{ this }; }
+		std::default_sentinel_t end() const noexcept { return {}; }
+
+	private:
+		// The whole directory, as the loader walks it by its size
+		Result<std::span<const unsigned char>> _data;
+	};
+
+	// Adds the delta to every location of the block in an image laid out by RVAs.
+	// Blocks of only HIGHLOW or only DIR64 entries, which linkers emit, are checked once
+	// and applied by a loop without per-entry branches and bounds checks.
+	// Machine-specific types return ErrorCode::UnsupportedRelocation, targets beyond the image
+	// return ErrorCode::RvaOutOfImage. Entries before a failed one are already applied
+	EYESOLPEREADER_API Result<void> ApplyRelocationBlock(const RelocationBlock& block, std::span<unsigned char> image, std::uint64_t delta);
+	// Rebases the image by the difference of the bases
+	EYESOLPEREADER_API Result<void> ApplyBaseRelocations(const RelocationDirectory& relocations, std::span<unsigned char> image, std::uint64_t oldBase, std::uint64_t newBase);
+}
+#endif
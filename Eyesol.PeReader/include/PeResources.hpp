@@ -0,0 +1,208 @@
+#if !defined _PE_RESOURCES_H_
+#	define _PE_RESOURCES_H_
+#	include <algorithm>
+#	include <array>
+#	include <iterator>
+#	include <memory>
+#	include <span>
+#	include <string>
+#	include <string_view>
+#	include "ErrorCodes.hpp"
+#	include "PeHeaders.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	class PeExecutable;
+	class ResourceTree;
+	class ResourceDirectory;
+
+	// UTF-16LE text in the mapped file. Code units are decoded on access, so the text may be unaligned
+	class EYESOLPEREADER_API Utf16LeView
+	{
+	public:
+		Utf16LeView() noexcept = default;
+
+		explicit Utf16LeView(std::span<const unsigned char> bytes) noexcept
+			: _bytes{ bytes.first(bytes.size() / sizeof(char16_t) * sizeof(char16_t)) }
+		{
+		}
+
+		std::size_t size() const noexcept { return _bytes.size() / sizeof(char16_t); }
+		bool empty() const noexcept { return _bytes.empty(); }
+		std::span<const unsigned char> bytes() const noexcept { return _bytes; }
+
+		char16_t operator[](std::size_t index) const noexcept
+		{
+			char16_t c;
+			Memory::UnalignedRead<std::endian::little>(_bytes.data() + index * sizeof(char16_t), c);
+			return c;
+		}
+
+		bool operator==(std::u16string_view str) const noexcept;
+		// ASCII letters are compared case-insensitively, like resource names are
+		bool EqualsIgnoreCase(std::u16string_view str) const noexcept;
+
+		std::u16string str() const;
+
+	private:
+		std::span<const unsigned char> _bytes;
+	};
+
+	// An ID or a name of a resource directory entry
+	struct ResourceName
+	{
+		// Empty for IDs
+		Utf16LeView name;
+		// Zero for names
+		std::uint32_t id;
+		bool isString;
+	};
+
+	struct ResourceData
+	{
+		ResourceDataEntry entry;
+		// The resource in the mapped file
+		std::span<const unsigned char> bytes;
+	};
+
+	// Offsets of the directories from the root down to a directory, to detect cycles
+	struct ResourcePath
+	{
+		static constexpr std::uint32_t MAXIMUM_DEPTH = 8;
+
+		std::array<std::uint32_t, MAXIMUM_DEPTH> offsets;
+		std::uint32_t depth;
+
+		bool contains(std::uint32_t offset) const noexcept
+		{
+			return std::find(offsets.begin(), offsets.begin() + depth, offset) != offsets.begin() + depth;
+		}
+	};
+
+	// What is left of the budget of a walk, shared by all the directories and entries opened from its root
+	struct ResourceWalkBudget
+	{
+		std::size_t remaining;
+	};
+
+	class EYESOLPEREADER_API ResourceEntry
+	{
+	public:
+		ResourceEntry() noexcept;
+		ResourceEntry(const ResourceTree& tree, const std::shared_ptr<ResourceWalkBudget>& budget, const ResourcePath& parentPath, const ResourceDirectoryEntry& entry, const ResourceName& name) noexcept;
+
+		const ResourceName& name() const noexcept { return _name; }
+		const ResourceDirectoryEntry& entry() const noexcept { return _entry; }
+		bool isDirectory() const noexcept { return _entry.isDirectory(); }
+
+		// Decodes the subdirectory. Returns ErrorCode::BadResourceDirectory for data entries
+		Result<ResourceDirectory> directory() const;
+		// Returns ErrorCode::BadResourceDirectory for subdirectories
+		Result<ResourceData> data() const;
+
+	private:
+		const ResourceTree* _tree;
+		std::shared_ptr<ResourceWalkBudget> _budget;
+		ResourcePath _parentPath;
+		ResourceDirectoryEntry _entry;
+		ResourceName _name;
+	};
+
+	// A single directory table. Entries are decoded on access
+	class EYESOLPEREADER_API ResourceDirectory
+	{
+	public:
+		// Iteration stops after the first error
+		class EYESOLPEREADER_API Iterator
+		{
+		public:
+			using iterator_concept = std::input_iterator_tag;
+			using value_type = Result<ResourceEntry>;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator() noexcept;
+			explicit Iterator(const ResourceDirectory* owner);
+
+			const Result<ResourceEntry>& operator*() const noexcept { return _current; }
+			const Result<ResourceEntry>* operator->() const noexcept { return &_current; }
+
+			Iterator& operator++();
+			void operator++(int) { ++*this; }
+
+			bool operator==(std::default_sentinel_t) const noexcept { return _done; }
+
+		private:
+			void Load();
+
+			const ResourceDirectory* _owner;
+			std::size_t _index;
+			Result<ResourceEntry> _current;
+			bool _done;
+		};
+
+		ResourceDirectory() noexcept;
+		ResourceDirectory(const ResourceTree& tree, const std::shared_ptr<ResourceWalkBudget>& budget, const ResourcePath& path, const ResourceDirectoryTable& table) noexcept;
+
+		const ResourceDirectoryTable& table() const noexcept { return _table; }
+		// The root has depth 1. Types, names and languages are on the first three levels
+		std::uint32_t depth() const noexcept { return _path.depth; }
+		std::size_t size() const noexcept { return static_cast<std::size_t>(_table.NumberOfNamedEntries) + _table.NumberOfIdEntries; }
+		// What is left of the budget of the walk this directory belongs to
+		std::size_t remainingBudget() const noexcept { return _budget != nullptr ? _budget->remaining : 0; }
+
+		Result<ResourceEntry> EntryAt(std::size_t index) const;
+		// A binary search over entries with IDs, which are sorted
+		Result<ResourceEntry> FindEntry(std::uint32_t id) const;
+		// A linear search over named entries
+		Result<ResourceEntry> FindEntry(std::u16string_view name) const;
+
+		Iterator begin() const { return Iterator{ this }; }
+		std::default_sentinel_t end() const noexcept { return {}; }
+
+	private:
+		const ResourceTree* _tree;
+		std::shared_ptr<ResourceWalkBudget> _budget;
+		ResourcePath _path;
+		ResourceDirectoryTable _table;
+	};
+
+	// The resource directory of an image, decoded on demand: a level is decoded only
+	// when it is descended into, so looking up one resource doesn't touch the others.
+	// Every decoded directory and entry is charged to the budget of its walk, so crafted trees,
+	// which share subdirectories to multiply entries, can't make a walk endless.
+	// Every root() call and lookup starts a walk with a budget of its own, so a tree may be shared
+	// by threads, while directories and entries of one walk may not.
+	// Directories and entries must not outlive the tree, and the tree must not outlive the executable
+	class EYESOLPEREADER_API ResourceTree
+	{
+	public:
+		static constexpr std::size_t DEFAULT_BUDGET = 1 << 20;
+
+		explicit ResourceTree(const PeExecutable& exe, std::size_t budget = DEFAULT_BUDGET);
+
+		// Returns ErrorCode::ResourceNotFound, if the image has no resources
+		Result<ResourceDirectory> root() const;
+		// The limit of directories and entries decoded by a single walk
+		std::size_t budget() const noexcept { return _budget; }
+
+		// Descends straight to the resource of the type. The first name
+		// and the first language are taken, as the loader does for neutral lookups
+		Result<ResourceData> FindFirstOfType(std::uint32_t type) const;
+
+	private:
+		friend class ResourceDirectory;
+		friend class ResourceEntry;
+
+		Result<ResourceDirectory> OpenDirectory(const std::shared_ptr<ResourceWalkBudget>& budget, const ResourcePath& parentPath, std::uint32_t offset) const;
+		Result<ResourceEntry> ReadEntry(const std::shared_ptr<ResourceWalkBudget>& budget, const ResourcePath& path, std::size_t index) const;
+		Result<ResourceData> ReadData(std::uint32_t offset) const;
+		Result<ResourceName> ReadName(const ResourceDirectoryEntry& entry) const;
+		static Result<void> Charge(ResourceWalkBudget& budget);
+
+		const PeExecutable* _exe;
+		// From the resource directory up to the end of its section data
+		Result<std::span<const unsigned char>> _data;
+		std::size_t _budget;
+	};
+}
+#endif
@@ -0,0 +1,106 @@
+#if !defined _PE_SECTION_INDEX_H_
+#	define _PE_SECTION_INDEX_H_
+#	include <atomic>
+#	include <vector>
+#	include "PeHeaders.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	// Section headers, decoded on access
+	using SectionTable = MemoryMappedIO::MemoryMappedRange<PE_COFF_ENDIANNESS, SectionHeader>;
+
+	// Where an RVA is located in the file
+	struct RvaLocation
+	{
+		// A file offset of the RVA. Meaningless, if rawLength is zero
+		std::uint64_t fileOffset;
+		// Bytes from the RVA up to the end of the section data in the file
+		std::uint32_t rawLength;
+		// Bytes from the RVA up to the end of the section in memory. Bytes beyond rawLength are zeros
+		std::uint32_t virtualLength;
+		// An index of the section in the section table, or SectionIndex::HEADERS_SECTION
+		std::uint32_t section;
+		// A position of the mapped interval in the index
+		std::uint32_t interval;
+	};
+
+	// Translates RVAs to file offsets the same way, as the loader maps the image.
+	// Sections are sorted by their virtual addresses into flat arrays,
+	// so a lookup is a binary search over contiguous section starts.
+	// The last found section is checked first, as directory walkers hit the same section in a row
+	class EYESOLPEREADER_API SectionIndex
+	{
+	public:
+		// The image headers, mapped below the first section
+		static constexpr std::uint32_t HEADERS_SECTION = ~std::uint32_t{};
+
+		SectionIndex() noexcept;
+		// Overlapping sections are cut at the start of the next one.
+		// Raw data is limited by the virtual size of the section and by the file length
+		SectionIndex(const SectionTable& sections, const OptionalHeader& optionalHeader, std::uint64_t fileLength);
+
+		SectionIndex(const SectionIndex& other);
+		SectionIndex(SectionIndex&& other) noexcept;
+		SectionIndex& operator=(const SectionIndex& other);
+		SectionIndex& operator=(SectionIndex&& other) noexcept;
+
+		// A count of mapped intervals, including the headers
+		std::size_t size() const noexcept { return _starts.size(); }
+
+		// The first RVA of the interval
+		std::uint32_t intervalStart(std::size_t interval) const noexcept
+		{
+			return _starts[interval];
+		}
+
+		// File data of the interval, limited by the virtual size and the file length
+		FileLocation rawData(std::size_t interval) const noexcept
+		{
+			return { _rawOffsets[interval], _rawLengths[interval] };
+		}
+
+		// Returns ErrorCode::RvaOutOfImage, if the RVA is not within the headers or a section
+		Result<RvaLocation> Locate(std::uint32_t rva) const noexcept;
+		// Returns ErrorCode::RvaNotInFile, if the RVA points to zero-filled data
+		Result<std::uint64_t> RvaToOffset(std::uint32_t rva) const noexcept;
+
+		// Copies length bytes of the loaded image. Data absent in the file is zero-filled.
+		// The range may span several adjacent sections
+		Result<void> ReadAtRva(const MemoryMappedIO::MemoryMappedFile& file, std::uint32_t rva, void* buf, std::size_t length) const;
+
+		template <Memory::PrimitiveType T>
+		Result<T> ReadAtRva(const MemoryMappedIO::MemoryMappedFile& file, std::uint32_t rva) const
+		{
+			unsigned char bytes[sizeof(T)];
+			Result<void> status = ReadAtRva(file, rva, bytes, sizeof(T));
+			if (!status)
+			{
+				return Unexpected{ status.error() };
+			}
+			T obj;
+			if constexpr (Memory::DescribedStruct<T>)
+			{
+				Memory::ReadStruct<PE_COFF_ENDIANNESS>(bytes, obj);
+			}
+			else
+			{
+				Memory::UnalignedRead<PE_COFF_ENDIANNESS>(bytes, obj);
+			}
+			return obj;
+		}
+
+		// Returns the file data at the RVA without copying. The whole range must be present in the file
+		Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> ViewAtRva(const MemoryMappedIO::MemoryMappedFile& file, std::uint32_t rva, std::size_t length) const;
+
+	private:
+		// Structure of arrays, sorted by _starts
+		std::vector<std::uint32_t> _starts;
+		std::vector<std::uint64_t> _ends;
+		std::vector<std::uint64_t> _rawOffsets;
+		std::vector<std::uint32_t> _rawLengths;
+		std::vector<std::uint32_t> _sections;
+
+		mutable std::atomic<std::size_t> _lastHit;
+	};
+}
+#endif
@@ -0,0 +1,102 @@
+#if !defined _PE_VERSION_INFO_H_
+#	define _PE_VERSION_INFO_H_
+#	include <optional>
+#	include "PeResources.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	struct VersionString
+	{
+		// A language and a code page as 8 hexadecimal digits, like "040904B0"
+		Utf16LeView table;
+		Utf16LeView key;
+		// Without the null terminator
+		Utf16LeView value;
+	};
+
+	struct VersionTranslation
+	{
+		std::uint16_t language;
+		std::uint16_t codePage;
+	};
+
+	// VS_VERSIONINFO decoded in place. Strings are views of the mapped resource,
+	// so neither iteration nor lookups allocate. The object must not outlive the executable
+	class EYESOLPEREADER_API VersionInfo
+	{
+	public:
+		// Walks strings of every StringTable of every StringFileInfo block in the file order.
+		// Iteration stops after the first error
+		class EYESOLPEREADER_API Iterator
+		{
+		public:
+			using iterator_concept = std::input_iterator_tag;
+			using value_type = Result<VersionString>;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator() noexcept;
+			explicit Iterator(const VersionInfo* owner);
+
+			const Result<VersionString>& operator*() const noexcept { return _current; }
+			const Result<VersionString>* operator->() const noexcept { return &_current; }
+
+			Iterator& operator++();
+			void operator++(int) { ++*this; }
+
+			bool operator==(std::default_sentinel_t) const noexcept { return _done; }
+
+		private:
+			void Load();
+
+			const VersionInfo* _owner;
+			// Positions within VS_VERSIONINFO children, a StringFileInfo block and a StringTable block
+			std::size_t _childOffset;
+			std::size_t _tableOffset;
+			std::size_t _tablesEnd;
+			std::size_t _stringOffset;
+			std::size_t _stringsEnd;
+			Utf16LeView _table;
+			Result<VersionString> _current;
+			bool _done;
+		};
+
+		class Range
+		{
+		public:
+			explicit Range(const VersionInfo* owner) noexcept
+				: _owner{ owner }
+			{
+			}
+
+			Iterator begin() const { return Iterator{ _owner }; }
+			std::default_sentinel_t end() const noexcept { return {}; }
+
+		private:
+			const VersionInfo* _owner;
+		};
+
+		VersionInfo() noexcept;
+
+		// Decodes the VS_VERSIONINFO root, the fixed part and translations. Strings are decoded on iteration
+		static Result<VersionInfo> Parse(std::span<const unsigned char> data);
+
+		// Empty, if the value is absent or has no valid signature
+		const std::optional<FixedFileInfo>& fixedFileInfo() const noexcept { return _fixedFileInfo; }
+
+		Range strings() const noexcept { return Range{ this }; }
+		// The first string with the key in any table. Keys are compared exactly, like VerQueryValue does
+		Result<Utf16LeView> FindString(std::u16string_view key) const;
+
+		// VarFileInfo\Translation entries
+		std::size_t translationsCount() const noexcept { return _translations.size() / sizeof(std::uint32_t); }
+		VersionTranslation translationAt(std::size_t index) const noexcept;
+
+	private:
+		// The VS_VERSIONINFO block
+		std::span<const unsigned char> _data;
+		std::size_t _childrenOffset;
+		std::optional<FixedFileInfo> _fixedFileInfo;
+		std::span<const unsigned char> _translations;
+	};
+}
+#endif
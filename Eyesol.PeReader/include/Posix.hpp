@@ -0,0 +1,82 @@
+#if !defined _POSIX_H_
+#	define _POSIX_H_
+#	if defined __unix__ || defined __APPLE__
+#		include "framework.hpp"
+#		include <unistd.h>
+
+namespace Eyesol::Posix
+{
+	EYESOLPEREADER_API std::string FormatPosixErrorMessage(int code, std::string actionDescription);
+
+	class FileDescriptor
+	{
+		int _fd;
+
+	public:
+		static constexpr int INVALID_DESCRIPTOR = -1;
+
+		FileDescriptor() noexcept
+			: _fd{ INVALID_DESCRIPTOR }
+		{
+		}
+
+		FileDescriptor(int fd) noexcept
+			: _fd{ fd }
+		{
+		}
+
+		FileDescriptor(const FileDescriptor&) = delete;
+		FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+		FileDescriptor(FileDescriptor&& other) noexcept
+			: _fd{ other._fd }
+		{
+			other._fd = INVALID_DESCRIPTOR;
+		}
+
+		FileDescriptor& operator=(FileDescriptor&& other) noexcept
+		{
+			if (this != &other)
+			{
+				closeDescriptor();
+				_fd = other._fd;
+				other._fd = INVALID_DESCRIPTOR;
+			}
+			return *this;
+		}
+
+		~FileDescriptor()
+		{
+			closeDescriptor();
+		}
+
+		int getDescriptor() const { return _fd; }
+
+		// closes an old descriptor and places a new one
+		void put(int fd) noexcept
+		{
+			closeDescriptor();
+			_fd = fd;
+		}
+
+		// returns a descriptor preventing it's closing
+		int release() noexcept
+		{
+			int fd = _fd;
+			_fd = INVALID_DESCRIPTOR;
+			return fd;
+		}
+
+	private:
+		void closeDescriptor() noexcept
+		{
+			if (_fd != INVALID_DESCRIPTOR)
+			{
+				::close(_fd);
+				_fd = INVALID_DESCRIPTOR;
+			}
+		}
+	};
+}
+#	endif
+#endif
@@ -1,12 +1,15 @@
 #if !defined _RUNTIME_H_
 #	define _RUNTIME_H_
 #	include <cstddef>
+#	include "CompilerInfo.hpp"
 
 namespace Eyesol::Runtime
 {
 	std::size_t AllocationGranularity();
 
-	// TODO: implement properly
-	constexpr bool PosixCompatible = false;
+	constexpr bool PosixCompatible
+		= Eyesol::OS::CurrentOS == Eyesol::OS::OSType::Linux
+		|| Eyesol::OS::CurrentOS == Eyesol::OS::OSType::Android
+		|| Eyesol::OS::CurrentOS == Eyesol::OS::OSType::Darwin;
 }
 #endif // _RUNTIME_H_
\ No newline at end of file
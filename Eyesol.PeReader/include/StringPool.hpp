@@ -0,0 +1,39 @@
+#if !defined _STRING_POOL_H_
+#	define _STRING_POOL_H_
+#	include <shared_mutex>
+#	include <string>
+#	include <string_view>
+#	include <unordered_set>
+#	include "framework.hpp"
+
+namespace Eyesol
+{
+	// Keeps a single copy of every string added to it. Views returned by Intern
+	// stay valid while the pool is alive, so equal strings of many files share storage.
+	// Strings already in the pool are found without allocations. Thread-safe
+	class EYESOLPEREADER_API StringPool
+	{
+	public:
+		StringPool() = default;
+		StringPool(const StringPool&) = delete;
+		StringPool& operator=(const StringPool&) = delete;
+
+		std::string_view Intern(std::string_view str);
+		std::size_t size() const;
+
+		// The pool used by parsers, which are not given one explicitly. Never shrinks
+		static StringPool& Shared();
+
+	private:
+		struct Hash
+		{
+			using is_transparent = void;
+			std::size_t operator()(std::string_view str) const noexcept { return std::hash<std::string_view>{}(str); }
+		};
+
+		mutable std::shared_mutex _mutex;
+		// Nodes of unordered containers are never relocated, so views of the elements stay valid
+		std::unordered_set<std::string, Hash, std::equal_to<>> _strings;
+	};
+}
+#endif
@@ -21,9 +21,14 @@
 // использующем данную DLL. Благодаря этому любой другой проект, исходные файлы которого включают данный файл, видит
 // функции EYESOLPEREADER_API как импортированные из DLL, тогда как данная DLL видит символы,
 // определяемые данным макросом, как экспортированные.
-#	ifdef EYESOLPEREADER_EXPORTS
-#		define EYESOLPEREADER_API __declspec(dllexport)
+#	if defined _WIN32
+#		ifdef EYESOLPEREADER_EXPORTS
+#			define EYESOLPEREADER_API __declspec(dllexport)
+#		else
+#			define EYESOLPEREADER_API __declspec(dllimport)
+#		endif
 #	else
-#		define EYESOLPEREADER_API __declspec(dllimport)
+// Shared objects on POSIX systems export symbols with default visibility
+#		define EYESOLPEREADER_API __attribute__((visibility("default")))
 #	endif
 #endif // _FRAMEWORK_H_
\ No newline at end of file
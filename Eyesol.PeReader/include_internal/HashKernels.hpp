@@ -0,0 +1,48 @@
+#if !defined _HASHKERNELS_H_
+#	define _HASHKERNELS_H_
+#	include <cstddef>
+#	include <cstdint>
+#	include "Simd.hpp"
+
+namespace Eyesol::Hashing::Impl
+{
+	// Compresses count consecutive 64-byte blocks into the state
+	using CompressBlocksFunction = void (*)(std::uint32_t* state, const unsigned char* blocks, std::size_t count);
+
+	// Compresses one block of every lane. States of the lanes are interleaved:
+	// word i of lane j is states[i * lanes + j]
+	using CompressLanesFunction = void (*)(std::uint32_t* states, const unsigned char* const* blocks);
+
+	struct LanesKernel
+	{
+		std::size_t lanes;
+		CompressLanesFunction compress;
+	};
+
+	void PortableSha1Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept;
+	void PortableSha256Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept;
+
+	extern const std::uint32_t SHA256_ROUND_CONSTANTS[64];
+
+#	if defined EYESOL_SIMD_X86
+	namespace X86
+	{
+		void ShaNiSha1Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept;
+		void ShaNiSha256Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept;
+
+		constexpr std::size_t AVX2_LANES = 8;
+		void Avx2Sha1Lanes(std::uint32_t* states, const unsigned char* const* blocks) noexcept;
+		void Avx2Sha256Lanes(std::uint32_t* states, const unsigned char* const* blocks) noexcept;
+	}
+#	endif
+
+#	if defined EYESOL_SIMD_NEON && !defined __AARCH64EB__
+#		define EYESOL_SIMD_ARM_CRYPTO
+	namespace Arm
+	{
+		void CryptoSha1Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept;
+		void CryptoSha256Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept;
+	}
+#	endif
+}
+#endif // _HASHKERNELS_H_
@@ -0,0 +1,35 @@
+#if !defined _HISTOGRAMKERNELS_H_
+#	define _HISTOGRAMKERNELS_H_
+#	include <cstddef>
+#	include <cstdint>
+#	include "Simd.hpp"
+
+namespace Eyesol::Analysis::Impl
+{
+	// Adds counts of every byte value of the data to 256 counters
+	using HistogramFunction = void (*)(const unsigned char* data, std::size_t length, std::uint64_t* counts);
+
+	// Bytes are counted into this many tables, so a repeated byte doesn't wait for the previous
+	// increment of the same counter to be stored. Tables are summed into the counters at the end
+	constexpr std::size_t HISTOGRAM_TABLES = 8;
+	// Table counters are 32-bit, so longer data is counted in chunks
+	constexpr std::size_t HISTOGRAM_CHUNK_LENGTH = std::size_t{ 1 } << 30;
+
+	void PortableHistogram(const unsigned char* data, std::size_t length, std::uint64_t* counts) noexcept;
+
+#	if defined EYESOL_SIMD_X86
+	namespace X86
+	{
+		void Sse2Histogram(const unsigned char* data, std::size_t length, std::uint64_t* counts) noexcept;
+		void Avx2Histogram(const unsigned char* data, std::size_t length, std::uint64_t* counts) noexcept;
+	}
+#	endif
+
+#	if defined EYESOL_SIMD_NEON
+	namespace Arm
+	{
+		void NeonHistogram(const unsigned char* data, std::size_t length, std::uint64_t* counts) noexcept;
+	}
+#	endif
+}
+#endif // _HISTOGRAMKERNELS_H_
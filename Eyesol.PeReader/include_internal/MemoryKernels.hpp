@@ -0,0 +1,72 @@
+#if !defined _MEMORYKERNELS_H_
+#	define _MEMORYKERNELS_H_
+#	include <cstddef>
+#	include <cstdint>
+#	include "Simd.hpp"
+
+namespace Eyesol::Memory::Impl
+{
+	// Reverses byte order of count elements. src and dst may be equal, but must not partially overlap
+	using ByteSwapArrayFunction = void (*)(const void* src, void* dst, std::size_t count);
+
+	struct ByteSwapKernels
+	{
+		ByteSwapArrayFunction swap16;
+		ByteSwapArrayFunction swap32;
+		ByteSwapArrayFunction swap64;
+	};
+
+	// Returns a sum of little endian 16-bit words modulo 2^16.
+	// A trailing odd byte is zero-extended
+	using WordSumFunction = std::uint16_t (*)(const void* data, std::size_t length);
+	// Returns a ones' complement sum of little endian 16-bit words.
+	// A trailing odd byte is zero-extended
+	using OnesComplementSumFunction = std::uint16_t (*)(const void* data, std::size_t length);
+
+	// Returns an index of the last dword equal to the pattern, or count if there is none.
+	// Dwords are compared as they are stored in memory
+	using FindLastDwordFunction = std::size_t (*)(const void* data, std::size_t count, std::uint32_t pattern);
+	// XORs count dwords with the key. src and dst may be equal, but must not partially overlap
+	using XorDwordsFunction = void (*)(const void* src, void* dst, std::size_t count, std::uint32_t key);
+
+	extern const ByteSwapKernels PortableByteSwapKernels;
+	// Vector kernels sum their tails with these. A tail starts at an even offset,
+	// so its words are aligned as in the whole data
+	std::uint16_t PortableWordSum(const void* data, std::size_t length) noexcept;
+	std::uint16_t PortableOnesComplementSum(const void* data, std::size_t length) noexcept;
+	std::size_t PortableFindLastDword(const void* data, std::size_t count, std::uint32_t pattern) noexcept;
+	void PortableXorDwords(const void* src, void* dst, std::size_t count, std::uint32_t key) noexcept;
+
+#	if defined EYESOL_SIMD_X86
+	namespace X86
+	{
+		extern const ByteSwapKernels Ssse3ByteSwapKernels;
+		extern const ByteSwapKernels Avx2ByteSwapKernels;
+
+		std::uint16_t Sse2WordSum(const void* data, std::size_t length) noexcept;
+		std::uint16_t Avx2WordSum(const void* data, std::size_t length) noexcept;
+
+		std::uint16_t Sse2OnesComplementSum(const void* data, std::size_t length) noexcept;
+		std::uint16_t Avx2OnesComplementSum(const void* data, std::size_t length) noexcept;
+
+		std::size_t Sse2FindLastDword(const void* data, std::size_t count, std::uint32_t pattern) noexcept;
+		std::size_t Avx2FindLastDword(const void* data, std::size_t count, std::uint32_t pattern) noexcept;
+
+		void Sse2XorDwords(const void* src, void* dst, std::size_t count, std::uint32_t key) noexcept;
+		void Avx2XorDwords(const void* src, void* dst, std::size_t count, std::uint32_t key) noexcept;
+	}
+#	endif
+
+#	if defined EYESOL_SIMD_NEON
+	namespace Arm
+	{
+		extern const ByteSwapKernels NeonByteSwapKernels;
+
+		std::uint16_t NeonWordSum(const void* data, std::size_t length) noexcept;
+		std::uint16_t NeonOnesComplementSum(const void* data, std::size_t length) noexcept;
+		std::size_t NeonFindLastDword(const void* data, std::size_t count, std::uint32_t pattern) noexcept;
+		void NeonXorDwords(const void* src, void* dst, std::size_t count, std::uint32_t key) noexcept;
+	}
+#	endif
+}
+#endif // _MEMORYKERNELS_H_
@@ -0,0 +1,36 @@
+#if !defined _SIMD_H_
+#	define _SIMD_H_
+#	include "CpuFeatures.hpp"
+
+// Instruction sets which may be used by kernels selected at runtime
+#	if defined __x86_64__ || defined _M_X64 || defined __i386__ || defined _M_IX86
+#		define EYESOL_SIMD_X86
+#		if defined _MSC_VER
+#			include <intrin.h>
+#		else
+#			include <immintrin.h>
+#		endif
+#	elif defined __aarch64__ || defined _M_ARM64
+// NEON is a mandatory part of AArch64
+#		define EYESOL_SIMD_ARM
+#		define EYESOL_SIMD_NEON
+#		include <arm_neon.h>
+#	elif defined __arm__ || defined _M_ARM
+// Only features are probed, kernels are not provided
+#		define EYESOL_SIMD_ARM
+#	endif
+
+// GCC and Clang allow intrinsics of an instruction set only in functions
+// compiled for it, while MSVC allows them everywhere
+#	if defined __GNUC__ || defined __clang__
+#		define EYESOL_TARGET(instructionSets) __attribute__((target(instructionSets)))
+#	else
+#		define EYESOL_TARGET(instructionSets)
+#	endif
+
+namespace Eyesol::Cpu::Impl
+{
+	// Queries the CPU and the OS. Implemented per architecture
+	Features ProbeFeatures() noexcept;
+}
+#endif // _SIMD_H_
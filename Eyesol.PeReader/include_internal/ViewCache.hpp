@@ -0,0 +1,69 @@
+#if !defined _VIEWCACHE_H_
+#	define _VIEWCACHE_H_
+#	include <array>
+#	include <atomic>
+#	include <mutex>
+#	include <vector>
+#	include "MemoryMappedIO.hpp"
+
+namespace Eyesol::MemoryMappedIO::Impl
+{
+	// A mapped view of a file. The deleter unmaps it,
+	// so the view stays mapped while any region uses it
+	using MappedView = std::shared_ptr<const unsigned char>;
+
+	// A bounded LRU cache of mapped views, shared by all users of a file.
+	// Lookups are split into independently locked shards,
+	// so threads reading different parts of the file don't contend
+	class ViewCache
+	{
+	public:
+		static constexpr std::size_t SHARDS_COUNT = 8;
+		static constexpr std::size_t DEFAULT_CAPACITY = 64;
+
+		explicit ViewCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+		ViewCache(const ViewCache&) = delete;
+		ViewCache& operator=(const ViewCache&) = delete;
+
+		// Returns a cached view starting at the offset and covering at least length bytes,
+		// or nullptr if there is no such view
+		MappedView Find(std::uint64_t offset, std::size_t length);
+		// Returns a view which is actually cached. If another thread has cached
+		// a suitable view in the meantime, it is returned instead of the new one
+		MappedView Insert(std::uint64_t offset, std::size_t length, MappedView view);
+
+		// Drops the least recently used views if there are more than the new capacity
+		void SetCapacity(std::size_t capacity);
+		ViewCacheStatistics statistics() const noexcept;
+
+	private:
+		struct Entry
+		{
+			std::uint64_t offset;
+			std::size_t length;
+			MappedView view;
+		};
+
+		struct Shard
+		{
+			std::mutex mutex;
+			// The most recently used entry is the last one
+			std::vector<Entry> entries;
+		};
+
+		std::array<Shard, SHARDS_COUNT> _shards;
+		std::size_t _granularity;
+		std::atomic<std::size_t> _capacity;
+		std::atomic<std::uint64_t> _hits;
+		std::atomic<std::uint64_t> _misses;
+		std::atomic<std::uint64_t> _evictions;
+
+		std::size_t ShardIndex(std::uint64_t offset) const noexcept;
+		// Shard capacities sum up to the capacity: the first capacity % SHARDS_COUNT shards hold one entry more
+		std::size_t ShardCapacity(std::size_t shardIndex) const noexcept;
+		// The shard mutex must be locked
+		void Trim(Shard& shard, std::size_t shardCapacity);
+	};
+}
+#endif // _VIEWCACHE_H_
@@ -0,0 +1,76 @@
+// ARM CPU feature detection. User mode code can't read ID registers,
+// so the OS is asked instead
+#include "CpuFeatures.hpp"
+#include "Simd.hpp"
+#if defined EYESOL_SIMD_ARM
+#	if defined _WIN32
+#		include "win32_include.hpp"
+#	elif defined __APPLE__
+#		include <sys/sysctl.h>
+#	elif defined __linux__
+#		include <sys/auxv.h>
+#		include <asm/hwcap.h>
+#	endif
+
+namespace Eyesol::Cpu
+{
+#	if defined __APPLE__
+	namespace
+	{
+		bool SysctlFlag(const char* name) noexcept
+		{
+			int value = 0;
+			std::size_t length = sizeof(value);
+			return ::sysctlbyname(name, &value, &length, nullptr, 0) == 0 && value != 0;
+		}
+	}
+#	endif
+
+	Features Impl::ProbeFeatures() noexcept
+	{
+		Features features;
+		auto add = [&features](bool present, Feature feature)
+			{
+				if (present)
+				{
+					features = features | feature;
+				}
+			};
+#	if defined __aarch64__ || defined _M_ARM64
+		// A part of the base architecture
+		add(true, Feature::Neon);
+#		if defined _WIN32
+		add(::IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE) != 0, Feature::ArmCrc32);
+		bool crypto = ::IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) != 0;
+		add(crypto, Feature::ArmPmull);
+		add(crypto, Feature::ArmSha1);
+		add(crypto, Feature::ArmSha2);
+#		elif defined __APPLE__
+		// Every Apple CPU running 64-bit code has the crypto extension
+		add(SysctlFlag("hw.optional.armv8_crc32"), Feature::ArmCrc32);
+		add(true, Feature::ArmPmull);
+		add(true, Feature::ArmSha1);
+		add(true, Feature::ArmSha2);
+#		elif defined __linux__
+		unsigned long hwcap = ::getauxval(AT_HWCAP);
+		add((hwcap & HWCAP_CRC32) != 0, Feature::ArmCrc32);
+		add((hwcap & HWCAP_PMULL) != 0, Feature::ArmPmull);
+		add((hwcap & HWCAP_SHA1) != 0, Feature::ArmSha1);
+		add((hwcap & HWCAP_SHA2) != 0, Feature::ArmSha2);
+#		endif
+#	else
+#		if defined _WIN32
+		add(::IsProcessorFeaturePresent(PF_ARM_NEON_INSTRUCTIONS_AVAILABLE) != 0, Feature::Neon);
+#		elif defined __linux__
+		add((::getauxval(AT_HWCAP) & HWCAP_NEON) != 0, Feature::Neon);
+		unsigned long hwcap2 = ::getauxval(AT_HWCAP2);
+		add((hwcap2 & HWCAP2_CRC32) != 0, Feature::ArmCrc32);
+		add((hwcap2 & HWCAP2_PMULL) != 0, Feature::ArmPmull);
+		add((hwcap2 & HWCAP2_SHA1) != 0, Feature::ArmSha1);
+		add((hwcap2 & HWCAP2_SHA2) != 0, Feature::ArmSha2);
+#		endif
+#	endif
+		return features;
+	}
+}
+#endif
@@ -0,0 +1,107 @@
+// x86 CPU feature detection with CPUID
+#include "CpuFeatures.hpp"
+#include "Simd.hpp"
+#if defined EYESOL_SIMD_X86
+
+namespace Eyesol::Cpu
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		struct CpuidResult
+		{
+			std::uint32_t eax;
+			std::uint32_t ebx;
+			std::uint32_t ecx;
+			std::uint32_t edx;
+		};
+
+		CpuidResult Cpuid(std::uint32_t leaf, std::uint32_t subleaf) noexcept
+		{
+#	if defined _MSC_VER
+			int registers[4];
+			__cpuidex(registers, static_cast<int>(leaf), static_cast<int>(subleaf));
+			return CpuidResult{
+				static_cast<std::uint32_t>(registers[0]),
+				static_cast<std::uint32_t>(registers[1]),
+				static_cast<std::uint32_t>(registers[2]),
+				static_cast<std::uint32_t>(registers[3])
+			};
+#	else
+			CpuidResult result;
+			__asm__ __volatile__("cpuid"
+				: "=a"(result.eax), "=b"(result.ebx), "=c"(result.ecx), "=d"(result.edx)
+				: "a"(leaf), "c"(subleaf));
+			return result;
+#	endif
+		}
+
+		// XCR0 shows which register states the OS saves on context switches
+		std::uint64_t ReadXcr0() noexcept
+		{
+#	if defined _MSC_VER
+			return _xgetbv(0);
+#	else
+			std::uint32_t low;
+			std::uint32_t high;
+			__asm__ __volatile__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+			return (static_cast<std::uint64_t>(high) << 32) | low;
+#	endif
+		}
+
+		constexpr bool IsSet(std::uint32_t reg, unsigned bit) noexcept
+		{
+			return (reg >> bit & 1U) != 0;
+		}
+
+		// XMM and YMM states
+		constexpr std::uint64_t AVX_STATE = 0x6;
+		// Plus opmask and ZMM states
+		constexpr std::uint64_t AVX512_STATE = 0xE6;
+	}
+	#pragma endregion
+
+	Features Impl::ProbeFeatures() noexcept
+	{
+		Features features;
+		std::uint32_t maxLeaf = Cpuid(0, 0).eax;
+		if (maxLeaf < 1)
+		{
+			return features;
+		}
+		CpuidResult leaf1 = Cpuid(1, 0);
+		auto add = [&features](bool present, Feature feature)
+			{
+				if (present)
+				{
+					features = features | feature;
+				}
+			};
+		add(IsSet(leaf1.edx, 26), Feature::Sse2);
+		add(IsSet(leaf1.ecx, 1), Feature::Pclmul);
+		add(IsSet(leaf1.ecx, 9), Feature::Ssse3);
+		add(IsSet(leaf1.ecx, 19), Feature::Sse41);
+		add(IsSet(leaf1.ecx, 20), Feature::Sse42);
+		add(IsSet(leaf1.ecx, 23), Feature::Popcnt);
+
+		// AVX registers are usable only if the OS preserves them
+		bool osxsave = IsSet(leaf1.ecx, 27);
+		std::uint64_t xcr0 = osxsave ? ReadXcr0() : 0;
+		bool avxState = (xcr0 & AVX_STATE) == AVX_STATE;
+		bool avx512State = (xcr0 & AVX512_STATE) == AVX512_STATE;
+		add(avxState && IsSet(leaf1.ecx, 28), Feature::Avx);
+
+		if (maxLeaf >= 7)
+		{
+			CpuidResult leaf7 = Cpuid(7, 0);
+			add(avxState && IsSet(leaf7.ebx, 5), Feature::Avx2);
+			add(IsSet(leaf7.ebx, 8), Feature::Bmi2);
+			add(avx512State && IsSet(leaf7.ebx, 16), Feature::Avx512F);
+			add(IsSet(leaf7.ebx, 29), Feature::Sha);
+			add(avx512State && IsSet(leaf7.ebx, 30), Feature::Avx512Bw);
+			add(avx512State && IsSet(leaf7.ebx, 31), Feature::Avx512Vl);
+		}
+		return features;
+	}
+}
+#endif
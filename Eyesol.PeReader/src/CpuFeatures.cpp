@@ -0,0 +1,93 @@
+#include "CpuFeatures.hpp"
+#include "Simd.hpp"
+
+namespace Eyesol::Cpu
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		std::atomic<std::uint32_t> allowedFeatures{ ~std::uint32_t{} };
+		std::atomic<std::uint32_t> featuresGeneration{};
+
+		struct FeatureName
+		{
+			Feature feature;
+			const char* name;
+		};
+
+		constexpr FeatureName FEATURE_NAMES[] =
+		{
+			{ Feature::Sse2, "sse2" },
+			{ Feature::Ssse3, "ssse3" },
+			{ Feature::Sse41, "sse4.1" },
+			{ Feature::Sse42, "sse4.2" },
+			{ Feature::Popcnt, "popcnt" },
+			{ Feature::Pclmul, "pclmul" },
+			{ Feature::Avx, "avx" },
+			{ Feature::Avx2, "avx2" },
+			{ Feature::Bmi2, "bmi2" },
+			{ Feature::Avx512F, "avx512f" },
+			{ Feature::Avx512Bw, "avx512bw" },
+			{ Feature::Avx512Vl, "avx512vl" },
+			{ Feature::Sha, "sha" },
+			{ Feature::Neon, "neon" },
+			{ Feature::ArmCrc32, "crc32" },
+			{ Feature::ArmPmull, "pmull" },
+			{ Feature::ArmSha1, "sha1" },
+			{ Feature::ArmSha2, "sha2" },
+		};
+	}
+	#pragma endregion
+
+#if !defined EYESOL_SIMD_X86 && !defined EYESOL_SIMD_ARM
+	Features Impl::ProbeFeatures() noexcept
+	{
+		// Only portable kernels are available
+		return Features{};
+	}
+#endif
+
+	Features Features::Detected() noexcept
+	{
+		static const Features detected = Impl::ProbeFeatures();
+		return detected;
+	}
+
+	Features Features::Current() noexcept
+	{
+		return Detected() & FromBits(allowedFeatures.load(std::memory_order_relaxed));
+	}
+
+	std::string Features::ToString() const
+	{
+		std::string result;
+		for (auto&& [feature, name] : FEATURE_NAMES)
+		{
+			if (Has(feature))
+			{
+				if (!result.empty())
+				{
+					result += ' ';
+				}
+				result += name;
+			}
+		}
+		return result;
+	}
+
+	void SetAllowedFeatures(Features allowed) noexcept
+	{
+		allowedFeatures.store(allowed.bits(), std::memory_order_relaxed);
+		featuresGeneration.fetch_add(1, std::memory_order_release);
+	}
+
+	Features GetAllowedFeatures() noexcept
+	{
+		return Features::FromBits(allowedFeatures.load(std::memory_order_relaxed));
+	}
+
+	std::uint32_t Impl::FeaturesGeneration() noexcept
+	{
+		return featuresGeneration.load(std::memory_order_acquire);
+	}
+}
@@ -0,0 +1,63 @@
+// AArch64 NEON histogram kernels
+#include <algorithm>
+#include "HistogramKernels.hpp"
+#if defined EYESOL_SIMD_NEON
+
+namespace Eyesol::Analysis::Impl::Arm
+{
+	#pragma region nameless namespace (kernels)
+	namespace
+	{
+		using Tables = std::uint32_t[HISTOGRAM_TABLES][256];
+
+		// Eight bytes of a lane go to eight tables
+		inline void CountLane(Tables& tables, std::uint64_t lane) noexcept
+		{
+			for (std::size_t i = 0; i < HISTOGRAM_TABLES; i++)
+			{
+				tables[i][static_cast<unsigned char>(lane >> (i * 8))]++;
+			}
+		}
+	}
+	#pragma endregion
+
+	// Blocks of a single repeated byte, e.g. zero padding of sections, are added at once.
+	// Other blocks are split into 64-bit lanes, and their bytes are counted by scalar increments
+	void NeonHistogram(const unsigned char* data, std::size_t length, std::uint64_t* counts) noexcept
+	{
+		while (length != 0)
+		{
+			std::size_t chunk = std::min(length, HISTOGRAM_CHUNK_LENGTH);
+			Tables tables{};
+			std::size_t i = 0;
+			for (; i + 16 <= chunk; i += 16)
+			{
+				uint8x16_t vector = vld1q_u8(data + i);
+				if (vminvq_u8(vceqq_u8(vector, vdupq_laneq_u8(vector, 0))) == 0xFF)
+				{
+					tables[0][data[i]] += 16;
+					continue;
+				}
+				uint64x2_t lanes = vreinterpretq_u64_u8(vector);
+				CountLane(tables, vgetq_lane_u64(lanes, 0));
+				CountLane(tables, vgetq_lane_u64(lanes, 1));
+			}
+			for (; i < chunk; i++)
+			{
+				tables[0][data[i]]++;
+			}
+			for (std::size_t value = 0; value < 256; value++)
+			{
+				std::uint64_t sum = 0;
+				for (std::size_t table = 0; table < HISTOGRAM_TABLES; table++)
+				{
+					sum += tables[table][value];
+				}
+				counts[value] += sum;
+			}
+			data += chunk;
+			length -= chunk;
+		}
+	}
+}
+#endif
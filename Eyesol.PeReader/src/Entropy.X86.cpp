@@ -0,0 +1,109 @@
+// x86 SSE2 and AVX2 histogram kernels. Every kernel is compiled for its own
+// instruction set, so the rest of the library still runs on any x86 CPU
+#include <algorithm>
+#include <cstring>
+#include "HistogramKernels.hpp"
+#if defined EYESOL_SIMD_X86
+
+namespace Eyesol::Analysis::Impl::X86
+{
+	#pragma region nameless namespace (kernels)
+	namespace
+	{
+		using Tables = std::uint32_t[HISTOGRAM_TABLES][256];
+
+		// Eight bytes of a lane go to eight tables
+		inline void CountLane(Tables& tables, std::uint64_t lane) noexcept
+		{
+			for (std::size_t i = 0; i < HISTOGRAM_TABLES; i++)
+			{
+				tables[i][static_cast<unsigned char>(lane >> (i * 8))]++;
+			}
+		}
+
+		void MergeTables(const Tables& tables, std::uint64_t* counts) noexcept
+		{
+			for (std::size_t value = 0; value < 256; value++)
+			{
+				std::uint64_t sum = 0;
+				for (std::size_t table = 0; table < HISTOGRAM_TABLES; table++)
+				{
+					sum += tables[table][value];
+				}
+				counts[value] += sum;
+			}
+		}
+
+		// Blocks of a single repeated byte, e.g. zero padding of sections, are added at once.
+		// Other blocks are split into 64-bit lanes, and their bytes are counted by scalar increments
+		template <std::size_t BlockLength, typename CountBlock>
+		void CountChunks(const unsigned char* data, std::size_t length, std::uint64_t* counts, CountBlock countBlock) noexcept
+		{
+			while (length != 0)
+			{
+				std::size_t chunk = std::min(length, HISTOGRAM_CHUNK_LENGTH);
+				Tables tables{};
+				std::size_t i = 0;
+				for (; i + BlockLength <= chunk; i += BlockLength)
+				{
+					countBlock(tables, data + i);
+				}
+				for (; i < chunk; i++)
+				{
+					tables[0][data[i]]++;
+				}
+				MergeTables(tables, counts);
+				data += chunk;
+				length -= chunk;
+			}
+		}
+
+		EYESOL_TARGET("sse2")
+		void Sse2CountBlock(Tables& tables, const unsigned char* block) noexcept
+		{
+			__m128i vector = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+			__m128i first = _mm_set1_epi8(static_cast<char>(block[0]));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(vector, first)) == 0xFFFF)
+			{
+				tables[0][block[0]] += 16;
+				return;
+			}
+			std::uint64_t lanes[2];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), vector);
+			CountLane(tables, lanes[0]);
+			CountLane(tables, lanes[1]);
+		}
+
+		EYESOL_TARGET("avx2")
+		void Avx2CountBlock(Tables& tables, const unsigned char* block) noexcept
+		{
+			__m256i vector = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+			__m256i first = _mm256_set1_epi8(static_cast<char>(block[0]));
+			if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(vector, first)) == -1)
+			{
+				tables[0][block[0]] += 32;
+				return;
+			}
+			std::uint64_t lanes[4];
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), vector);
+			CountLane(tables, lanes[0]);
+			CountLane(tables, lanes[1]);
+			CountLane(tables, lanes[2]);
+			CountLane(tables, lanes[3]);
+		}
+	}
+	#pragma endregion
+
+	EYESOL_TARGET("sse2")
+	void Sse2Histogram(const unsigned char* data, std::size_t length, std::uint64_t* counts) noexcept
+	{
+		CountChunks<16>(data, length, counts, Sse2CountBlock);
+	}
+
+	EYESOL_TARGET("avx2")
+	void Avx2Histogram(const unsigned char* data, std::size_t length, std::uint64_t* counts) noexcept
+	{
+		CountChunks<32>(data, length, counts, Avx2CountBlock);
+	}
+}
+#endif
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "CpuFeatures.hpp"
+#include "Entropy.hpp"
+#include "HistogramKernels.hpp"
+#include "Runtime.hpp"
+
+namespace Eyesol::Analysis
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		// Clearing and merging kernel tables costs more than counting shorter data into a single one
+		constexpr std::size_t SHORT_DATA_LENGTH = 1024;
+		// Longer windows don't have their x * log2(x) terms tabulated
+		constexpr std::size_t MAXIMUM_TABULATED_WINDOW_LENGTH = 64 * 1024;
+
+		const Cpu::DispatchTable<Impl::HistogramFunction>& HistogramTable()
+		{
+			static const Cpu::DispatchTable<Impl::HistogramFunction> table
+			{
+#if defined EYESOL_SIMD_X86
+				{ Cpu::Feature::Avx2, Impl::X86::Avx2Histogram, "avx2" },
+				{ Cpu::Feature::Sse2, Impl::X86::Sse2Histogram, "sse2" },
+#elif defined EYESOL_SIMD_NEON
+				{ Cpu::Feature::Neon, Impl::Arm::NeonHistogram, "neon" },
+#endif
+				{ {}, Impl::PortableHistogram, "portable" }
+			};
+			return table;
+		}
+
+		double EntropyTerm(std::uint64_t count) noexcept
+		{
+			return count != 0 ? static_cast<double>(count) * std::log2(static_cast<double>(count)) : 0.0;
+		}
+
+		// Calls the function with the part of every region within the range,
+		// starting from the region that MemoryMappedFileIterator maps around the offset
+		template <typename Function>
+		Result<void> ForEachRegion(const MemoryMappedIO::MemoryMappedFile& file, std::uint64_t offset, std::uint64_t length, Function function)
+		{
+			std::uint64_t fileLength = file.length();
+			if (offset > fileLength || length > fileLength - offset)
+			{
+				return Unexpected{ ErrorCode::TruncatedData };
+			}
+			if (length == 0)
+			{
+				return {};
+			}
+			std::uint64_t end = offset + length;
+			// Iterators start at region boundaries only
+			std::size_t granularity = Runtime::AllocationGranularity();
+			MemoryMappedIO::MemoryMappedFileIterator it{ file, offset / granularity * granularity };
+			for (; it != file.end() && it.getBaseAddress() < end; ++it)
+			{
+				MemoryMappedIO::MemoryMappedFileRegion region = *it;
+				std::uint64_t from = std::max(offset, region.offset());
+				std::uint64_t to = std::min(end, region.offset() + region.length());
+				function(std::span<const unsigned char>{ region.data() + (from - region.offset()), static_cast<std::size_t>(to - from) });
+			}
+			return {};
+		}
+	}
+	#pragma endregion
+
+	namespace Impl
+	{
+		// Bytes of a 64-bit word go to separate tables
+		void PortableHistogram(const unsigned char* data, std::size_t length, std::uint64_t* counts) noexcept
+		{
+			while (length != 0)
+			{
+				std::size_t chunk = std::min(length, HISTOGRAM_CHUNK_LENGTH);
+				std::uint32_t tables[HISTOGRAM_TABLES][256]{};
+				std::size_t i = 0;
+				for (; i + HISTOGRAM_TABLES <= chunk; i += HISTOGRAM_TABLES)
+				{
+					for (std::size_t table = 0; table < HISTOGRAM_TABLES; table++)
+					{
+						tables[table][data[i + table]]++;
+					}
+				}
+				for (; i < chunk; i++)
+				{
+					tables[0][data[i]]++;
+				}
+				for (std::size_t value = 0; value < 256; value++)
+				{
+					std::uint64_t sum = 0;
+					for (std::size_t table = 0; table < HISTOGRAM_TABLES; table++)
+					{
+						sum += tables[table][value];
+					}
+					counts[value] += sum;
+				}
+				data += chunk;
+				length -= chunk;
+			}
+		}
+	}
+
+	#pragma region ByteHistogram
+	ByteHistogram::ByteHistogram() noexcept
+		: _counts{},
+		_total{}
+	{
+	}
+
+	void ByteHistogram::Add(std::span<const unsigned char> data) noexcept
+	{
+		if (data.size() < SHORT_DATA_LENGTH)
+		{
+			for (unsigned char value : data)
+			{
+				_counts[value]++;
+			}
+		}
+		else
+		{
+			(*HistogramTable())(data.data(), data.size(), _counts.data());
+		}
+		_total += data.size();
+	}
+
+	ByteHistogram& ByteHistogram::operator+=(const ByteHistogram& other) noexcept
+	{
+		for (std::size_t value = 0; value < HISTOGRAM_BINS; value++)
+		{
+			_counts[value] += other._counts[value];
+		}
+		_total += other._total;
+		return *this;
+	}
+
+	ByteHistogram& ByteHistogram::operator-=(const ByteHistogram& other) noexcept
+	{
+		for (std::size_t value = 0; value < HISTOGRAM_BINS; value++)
+		{
+			_counts[value] -= other._counts[value];
+		}
+		_total -= other._total;
+		return *this;
+	}
+
+	void ByteHistogram::Reset() noexcept
+	{
+		_counts = {};
+		_total = 0;
+	}
+
+	// H = -sum(p * log2(p)) = log2(total) - sum(count * log2(count)) / total
+	double ByteHistogram::entropy() const noexcept
+	{
+		if (_total == 0)
+		{
+			return 0.0;
+		}
+		double terms = 0.0;
+		for (std::uint64_t count : _counts)
+		{
+			terms += EntropyTerm(count);
+		}
+		double total = static_cast<double>(_total);
+		// Rounding may make the entropy of a single value slightly negative
+		return std::max(0.0, std::log2(total) - terms / total);
+	}
+	#pragma endregion
+
+	#pragma region SlidingEntropy
+	SlidingEntropy::SlidingEntropy(std::size_t step, std::size_t windowSteps)
+		: _step{ step },
+		_stepHistograms{},
+		_nextStep{},
+		_completedSteps{},
+		_window{},
+		_entropyTerms{},
+		_entropies{}
+	{
+		if (step == 0 || windowSteps == 0)
+		{
+			throw std::invalid_argument{ "A sliding window must have a non-zero step and length" };
+		}
+		_stepHistograms.resize(windowSteps);
+		std::size_t length = windowLength();
+		if (length <= MAXIMUM_TABULATED_WINDOW_LENGTH)
+		{
+			_entropyTerms.resize(length + 1);
+			for (std::size_t count = 0; count <= length; count++)
+			{
+				_entropyTerms[count] = EntropyTerm(count);
+			}
+		}
+	}
+
+	void SlidingEntropy::Update(std::span<const unsigned char> data)
+	{
+		while (!data.empty())
+		{
+			ByteHistogram& current = _stepHistograms[_nextStep];
+			std::size_t length = std::min<std::size_t>(data.size(), _step - current.total());
+			current.Add(data.first(length));
+			data = data.subspan(length);
+			if (current.total() == _step)
+			{
+				CompleteStep();
+			}
+		}
+	}
+
+	void SlidingEntropy::CompleteStep()
+	{
+		_window += _stepHistograms[_nextStep];
+		_completedSteps++;
+		_nextStep = (_nextStep + 1) % _stepHistograms.size();
+		if (_completedSteps < _stepHistograms.size())
+		{
+			return;
+		}
+		if (_entropyTerms.empty())
+		{
+			_entropies.push_back(_window.entropy());
+		}
+		else
+		{
+			double terms = 0.0;
+			for (std::uint64_t count : _window.counts())
+			{
+				terms += _entropyTerms[count];
+			}
+			double total = static_cast<double>(_window.total());
+			_entropies.push_back(std::max(0.0, std::log2(total) - terms / total));
+		}
+		// The oldest step leaves the window, and its histogram is reused for the next one
+		_window -= _stepHistograms[_nextStep];
+		_stepHistograms[_nextStep].Reset();
+	}
+	#pragma endregion
+
+	Result<ByteHistogram> ComputeHistogram(const MemoryMappedIO::MemoryMappedFile& file, std::uint64_t offset, std::uint64_t length)
+	{
+		ByteHistogram histogram;
+		Result<void> status = ForEachRegion(file, offset, length, [&histogram](std::span<const unsigned char> data)
+			{
+				histogram.Add(data);
+			});
+		if (!status)
+		{
+			return Unexpected{ status.error() };
+		}
+		return histogram;
+	}
+
+	Result<ByteHistogram> ComputeHistogram(const MemoryMappedIO::MemoryMappedFile& file)
+	{
+		return ComputeHistogram(file, 0, file.length());
+	}
+
+	Result<std::vector<double>> ComputeSlidingEntropy(const MemoryMappedIO::MemoryMappedFile& file, std::uint64_t offset, std::uint64_t length, std::size_t step, std::size_t windowSteps)
+	{
+		SlidingEntropy sliding{ step, windowSteps };
+		Result<void> status = ForEachRegion(file, offset, length, [&sliding](std::span<const unsigned char> data)
+			{
+				sliding.Update(data);
+			});
+		if (!status)
+		{
+			return Unexpected{ status.error() };
+		}
+		return sliding.entropies();
+	}
+}
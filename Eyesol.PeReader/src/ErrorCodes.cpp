@@ -0,0 +1,149 @@
+#include "ErrorCodes.hpp"
+#include "Exceptions.hpp"
+
+namespace Eyesol
+{
+	ErrorCategory CategoryOf(ErrorCode code) noexcept
+	{
+		switch (code)
+		{
+		case ErrorCode::OffsetOutOfRange:
+		case ErrorCode::TruncatedData:
+		case ErrorCode::LengthOverflow:
+		case ErrorCode::MisalignedOffset:
+		case ErrorCode::DosRelocationsOutOfFile:
+		case ErrorCode::RvaOutOfImage:
+		case ErrorCode::RvaNotInFile:
+		case ErrorCode::ExportNotFound:
+		case ErrorCode::ResourceNotFound:
+		case ErrorCode::DebugInfoNotFound:
+		case ErrorCode::TokenOutOfRange:
+		case ErrorCode::FunctionNotFound:
+			return ErrorCategory::Bounds;
+		case ErrorCode::BadDosHeader:
+		case ErrorCode::BadRichHeader:
+		case ErrorCode::BadOptionalHeader:
+		case ErrorCode::BadImportDirectory:
+		case ErrorCode::BadExportDirectory:
+		case ErrorCode::BadResourceDirectory:
+		case ErrorCode::ResourceLimitExceeded:
+		case ErrorCode::BadVersionInfo:
+		case ErrorCode::BadRelocationDirectory:
+		case ErrorCode::BadDebugDirectory:
+		case ErrorCode::BadClrMetadata:
+		case ErrorCode::BadExceptionDirectory:
+			return ErrorCategory::Format;
+		case ErrorCode::UnknownFormat:
+		case ErrorCode::NotImplemented:
+		case ErrorCode::UnsupportedRelocation:
+			return ErrorCategory::Unsupported;
+		default:
+			return ErrorCategory::Internal;
+		}
+	}
+
+	const char* ToString(ErrorCode code) noexcept
+	{
+		switch (code)
+		{
+		case ErrorCode::OffsetOutOfRange:
+			return "File offset is out of range";
+		case ErrorCode::TruncatedData:
+			return "Data doesn't fit into the file";
+		case ErrorCode::LengthOverflow:
+			return "Length is too long";
+		case ErrorCode::MisalignedOffset:
+			return "File offset is not aligned";
+		case ErrorCode::DosRelocationsOutOfFile:
+			return "DOS relocations don't fit into the file";
+		case ErrorCode::RvaOutOfImage:
+			return "RVA is outside of the image";
+		case ErrorCode::RvaNotInFile:
+			return "RVA points to uninitialized data";
+		case ErrorCode::ExportNotFound:
+			return "Export not found";
+		case ErrorCode::ResourceNotFound:
+			return "Resource not found";
+		case ErrorCode::DebugInfoNotFound:
+			return "Debug information not found";
+		case ErrorCode::TokenOutOfRange:
+			return "Metadata token is out of range";
+		case ErrorCode::FunctionNotFound:
+			return "No function contains the address";
+		case ErrorCode::BadDosHeader:
+			return "File is not DOS EXE file";
+		case ErrorCode::BadRichHeader:
+			return "Rich header is malformed";
+		case ErrorCode::BadOptionalHeader:
+			return "PE optional header is malformed";
+		case ErrorCode::BadImportDirectory:
+			return "Import directory is malformed";
+		case ErrorCode::BadExportDirectory:
+			return "Export directory is malformed";
+		case ErrorCode::BadResourceDirectory:
+			return "Resource directory is malformed";
+		case ErrorCode::ResourceLimitExceeded:
+			return "Resource tree is cyclic or too large";
+		case ErrorCode::BadVersionInfo:
+			return "Version information is malformed";
+		case ErrorCode::BadRelocationDirectory:
+			return "Base relocation directory is malformed";
+		case ErrorCode::BadDebugDirectory:
+			return "Debug directory is malformed";
+		case ErrorCode::BadClrMetadata:
+			return "CLR metadata is malformed";
+		case ErrorCode::BadExceptionDirectory:
+			return "Exception directory is malformed";
+		case ErrorCode::UnknownFormat:
+			return "Unknown executable format";
+		case ErrorCode::NotImplemented:
+			return "Function not implemented";
+		case ErrorCode::UnsupportedRelocation:
+			return "Base relocation type is not supported";
+		case ErrorCode::EmptyObject:
+			return "object is empty";
+		case ErrorCode::OutOfMemory:
+			return "Memory cannot be allocated";
+		case ErrorCode::UnclassifiedException:
+			return "Parser has thrown an exception";
+		default:
+			return "Unknown error";
+		}
+	}
+
+	const char* ToString(ErrorCategory category) noexcept
+	{
+		switch (category)
+		{
+		case ErrorCategory::Bounds:
+			return "bounds";
+		case ErrorCategory::Format:
+			return "format";
+		case ErrorCategory::Unsupported:
+			return "unsupported";
+		case ErrorCategory::Internal:
+			return "internal";
+		default:
+			return "unknown";
+		}
+	}
+
+	std::exception_ptr MakeExceptionPtr(ErrorCode code)
+	{
+		// The exception is not thrown, as unwinding is what error codes avoid
+		if (code == ErrorCode::NotImplemented)
+		{
+			return std::make_exception_ptr(NotImplementedException{});
+		}
+		if (CategoryOf(code) == ErrorCategory::Bounds)
+		{
+			return std::make_exception_ptr(std::out_of_range{ ToString(code) });
+		}
+		return std::make_exception_ptr(std::runtime_error{ ToString(code) });
+	}
+
+	void ThrowError(ErrorCode code)
+	{
+		std::rethrow_exception(MakeExceptionPtr(code));
+	}
+}
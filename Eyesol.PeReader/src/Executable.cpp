@@ -1,8 +1,88 @@
-#include "Executable.hpp"
+﻿#include "Executable.hpp"
 #include "Exceptions.hpp"
 
 namespace Eyesol::Executables
 {
+	#pragma region ExecutableProbe
+	ExecutableProbe::ExecutableProbe(const Eyesol::MemoryMappedIO::MemoryMappedFile& file)
+		: _magic{ ExecutableMagic::Unknown }
+	{
+		if (file.empty())
+		{
+			return;
+		}
+		// The same view, as the first Read of the file maps, so it is shared through the view cache
+		std::size_t probeLength;
+		MemoryMappedIO::Impl::CalculateMapRegionParameters(0, file.length(), nullptr, &probeLength, nullptr);
+		_region = file.MapRegion(0, probeLength);
+		_bytes = { _region.data(), _region.length() };
+		_magic = DetectMagic(_bytes);
+	}
+
+	ExecutableMagic ExecutableProbe::DetectMagic(std::span<const unsigned char> bytes) noexcept
+	{
+		auto startsWith = [bytes](std::string_view magic)
+			{
+				return bytes.size() >= magic.size() && std::memcmp(bytes.data(), magic.data(), magic.size()) == 0;
+			};
+		if (startsWith("MZ"))
+		{
+			return ExecutableMagic::Mz;
+		}
+		if (startsWith("\x7F" "ELF"))
+		{
+			return ExecutableMagic::Elf;
+		}
+		if (startsWith("!<arch>\n"))
+		{
+			return ExecutableMagic::UnixArchive;
+		}
+		if (startsWith("PK"))
+		{
+			return ExecutableMagic::Zip;
+		}
+		if (bytes.size() < sizeof(std::uint32_t))
+		{
+			return ExecutableMagic::Unknown;
+		}
+		std::uint32_t magic;
+		Memory::UnalignedRead<std::endian::big>(bytes.data(), magic);
+		switch (magic)
+		{
+		case 0xFEEDFACEU:
+		case 0xFEEDFACFU:
+		case 0xCEFAEDFEU:
+		case 0xCFFAEDFEU:
+			return ExecutableMagic::MachO;
+		case 0xCAFEBABFU:
+			return ExecutableMagic::MachOFat;
+		case 0xCAFEBABEU:
+		{
+			// Java class files continue with a version, at least 45,
+			// while fat binaries hold only a few architectures
+			constexpr std::uint32_t JAVA_CLASS_MINIMUM_MAJOR_VERSION = 45;
+			if (bytes.size() < 2 * sizeof(std::uint32_t))
+			{
+				return ExecutableMagic::Unknown;
+			}
+			std::uint32_t next;
+			Memory::UnalignedRead<std::endian::big>(bytes.data() + sizeof(std::uint32_t), next);
+			return next < JAVA_CLASS_MINIMUM_MAJOR_VERSION ? ExecutableMagic::MachOFat : ExecutableMagic::JavaClass;
+		}
+		default:
+			return ExecutableMagic::Unknown;
+		}
+	}
+	#pragma endregion
+
+	ExecutableParseContext::~ExecutableParseContext()
+	{
+	}
+
+	DebugInfo::~DebugInfo() noexcept
+	{
+	}
+
 	Executable::~Executable() noexcept
 	{
 	}
@@ -26,6 +106,52 @@ namespace Eyesol::Executables
 		return false;
 	}
 
+	std::vector<ExecutableMagic> ExecutableParser::SupportedMagics() const
+	{
+		return {};
+	}
+
+	Result<void> ExecutableParser::ProbeType(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& /*probe*/, std::unique_ptr<ExecutableParseContext>* /*ctx*/, ExecutableObjectFormat* format, ExecutableType* type) const
+	{
+		// Parsers unaware of probes read the file themselves
+		if (!IsTypeSupported(file, format, type))
+		{
+			return Unexpected{ ErrorCode::UnknownFormat };
+		}
+		return {};
+	}
+
+	Result<std::shared_ptr<Executable>> ExecutableParser::TryParseProbed(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& /*probe*/, std::unique_ptr<ExecutableParseContext> /*ctx*/) const
+	{
+		std::exception_ptr excPtr;
+		std::shared_ptr<Executable> exe = TryParse(file, &excPtr);
+		if (exe != nullptr)
+		{
+			return exe;
+		}
+		// The exception is not rethrown to be classified, it would defeat the purpose
+		return Unexpected{ excPtr != nullptr ? ErrorCode::UnclassifiedException : ErrorCode::UnknownFormat };
+	}
+
+	Result<std::shared_ptr<Executable>> ExecutableParser::TryParseNoThrow(const Eyesol::MemoryMappedIO::MemoryMappedFile& file) const
+	{
+		ExecutableProbe probe{ file };
+		return TryParseProbed(file, probe, nullptr);
+	}
+
+	std::shared_ptr<Executable> ExecutableParser::FromResult(Result<std::shared_ptr<Executable>> result, std::exception_ptr* excPtr)
+	{
+		if (result)
+		{
+			return std::move(*result);
+		}
+		if (result.error() != ErrorCode::UnknownFormat && excPtr != nullptr)
+		{
+			*excPtr = MakeExceptionPtr(result.error());
+		}
+		return nullptr;
+	}
+
 
 	CompoundExecutableParser::CompoundExecutableParser(std::vector<std::shared_ptr<ExecutableParser>> orderedParsers)
 		: _orderedParsers{ std::move(orderedParsers) }
@@ -37,6 +163,17 @@ namespace Eyesol::Executables
 			namesSet.insert(namesRef.begin(), namesRef.end());
 		}
 		std::copy(namesSet.begin(), namesSet.end(), std::back_inserter(_supportedFormatNames));
+		for (auto&& parser : _orderedParsers)
+		{
+			std::vector<ExecutableMagic> magics = parser->SupportedMagics();
+			for (std::size_t i = 0; i < EXECUTABLE_MAGICS_COUNT; i++)
+			{
+				if (magics.empty() || std::find(magics.begin(), magics.end(), static_cast<ExecutableMagic>(i)) != magics.end())
+				{
+					_parsersByMagic[i].push_back(parser.get());
+				}
+			}
+		}
 	}
 
 	const std::vector<std::string>& CompoundExecutableParser::SupportedFormatNames() const noexcept
@@ -46,30 +183,72 @@ namespace Eyesol::Executables
 
 	bool CompoundExecutableParser::IsTypeSupported(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, ExecutableObjectFormat* format, ExecutableType* type) const
 	{
-		auto parserPtr = FindSuitableParser(file, format, type);
-		return parserPtr != nullptr;
+		ExecutableProbe probe{ file };
+		return ProbeType(file, probe, nullptr, format, type).has_value();
 	}
 
 	std::shared_ptr<Executable> CompoundExecutableParser::TryParse(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::exception_ptr* excPtr) const
 	{
-		auto parserPtr = FindSuitableParser(file, nullptr, nullptr);
-		if (parserPtr == nullptr)
+		// The beginning of the file is read once for all parsers
+		return FromResult(TryParseNoThrow(file), excPtr);
+	}
+
+	std::vector<ExecutableMagic> CompoundExecutableParser::SupportedMagics() const
+	{
+		std::vector<ExecutableMagic> magics;
+		for (std::size_t i = 0; i < EXECUTABLE_MAGICS_COUNT; i++)
+		{
+			if (!_parsersByMagic[i].empty())
+			{
+				magics.push_back(static_cast<ExecutableMagic>(i));
+			}
+		}
+		return magics;
+	}
+
+	Result<void> CompoundExecutableParser::ProbeType(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext>* ctx, ExecutableObjectFormat* format, ExecutableType* type) const
+	{
+		Result<const ExecutableParser*> parser = FindSuitableParser(file, probe, ctx, format, type);
+		if (!parser)
+		{
+			return Unexpected{ parser.error() };
+		}
+		return {};
+	}
+
+	Result<std::shared_ptr<Executable>> CompoundExecutableParser::TryParseProbed(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext> ctx) const
+	{
+		// A context of the compound parser itself is never created, so it is replaced by the suitable parser's one
+		Result<const ExecutableParser*> parser = FindSuitableParser(file, probe, &ctx, nullptr, nullptr);
+		if (!parser)
 		{
-			return nullptr;
+			return Unexpected{ parser.error() };
 		}
-		return (*parserPtr)->TryParse(file, excPtr);
+		return (*parser)->TryParseProbed(file, probe, std::move(ctx));
 	}
 
-	const std::shared_ptr<ExecutableParser>* CompoundExecutableParser::FindSuitableParser(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, ExecutableObjectFormat* format, ExecutableType* type) const
+	Result<const ExecutableParser*> CompoundExecutableParser::FindSuitableParser(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext>* ctx, ExecutableObjectFormat* format, ExecutableType* type) const
 	{
-		for (auto&& parserPtr : _orderedParsers)
+		// A malformed file of a known format is more informative, than rejections of the other parsers
+		ErrorCode error = ErrorCode::UnknownFormat;
+		// Only parsers of the detected magic, and the ones accepting any file, are probed
+		for (const ExecutableParser* parser : _parsersByMagic[static_cast<std::size_t>(probe.magic())])
 		{
-			if (parserPtr->IsTypeSupported(file, format, type))
+			Result<void> status = parser->ProbeType(file, probe, ctx, format, type);
+			if (status)
 			{
-				return &parserPtr;
+				return parser;
+			}
+			if (error == ErrorCode::UnknownFormat)
+			{
+				error = status.error();
+			}
+			if (ctx != nullptr)
+			{
+				ctx->reset();
 			}
 		}
-		return nullptr;
+		return Unexpected{ error };
 	}
 
 	namespace
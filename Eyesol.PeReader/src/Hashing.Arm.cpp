@@ -0,0 +1,105 @@
+// AArch64 SHA-1 and SHA-256 kernels using the ARMv8 cryptography extension
+#include "HashKernels.hpp"
+#if defined EYESOL_SIMD_ARM_CRYPTO
+
+// GCC and Clang allow the instructions only in functions compiled for them
+#	if defined __GNUC__ || defined __clang__
+#		define EYESOL_TARGET_CRYPTO EYESOL_TARGET("arch=armv8-a+crypto")
+#	else
+#		define EYESOL_TARGET_CRYPTO
+#	endif
+
+namespace Eyesol::Hashing::Impl::Arm
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		constexpr std::size_t BLOCK_LENGTH = 64;
+
+		// Message words are big endian
+		uint32x4_t LoadWords(const unsigned char* data) noexcept
+		{
+			return vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data)));
+		}
+	}
+	#pragma endregion
+
+	EYESOL_TARGET_CRYPTO
+	void CryptoSha1Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept
+	{
+		constexpr std::uint32_t ROUND_CONSTANTS[4] = { 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6 };
+		uint32x4_t abcd = vld1q_u32(state);
+		std::uint32_t e0 = state[4];
+		for (; count != 0; count--, blocks += BLOCK_LENGTH)
+		{
+			uint32x4_t savedAbcd = abcd;
+			std::uint32_t e = e0;
+			uint32x4_t w[4];
+			for (int i = 0; i < 4; i++)
+			{
+				w[i] = LoadWords(blocks + i * 16);
+			}
+			// Every group of 4 rounds uses w[g % 4], and then replaces it with the words of group g + 4
+			for (int g = 0; g < 20; g++)
+			{
+				uint32x4_t message = vaddq_u32(w[g % 4], vdupq_n_u32(ROUND_CONSTANTS[g / 5]));
+				std::uint32_t nextE = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+				switch (g / 5)
+				{
+				case 0:
+					abcd = vsha1cq_u32(abcd, e, message);
+					break;
+				case 2:
+					abcd = vsha1mq_u32(abcd, e, message);
+					break;
+				default:
+					abcd = vsha1pq_u32(abcd, e, message);
+					break;
+				}
+				e = nextE;
+				if (g < 16)
+				{
+					w[g % 4] = vsha1su1q_u32(vsha1su0q_u32(w[g % 4], w[(g + 1) % 4], w[(g + 2) % 4]), w[(g + 3) % 4]);
+				}
+			}
+			abcd = vaddq_u32(abcd, savedAbcd);
+			e0 += e;
+		}
+		vst1q_u32(state, abcd);
+		state[4] = e0;
+	}
+
+	EYESOL_TARGET_CRYPTO
+	void CryptoSha256Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept
+	{
+		uint32x4_t abcd = vld1q_u32(state);
+		uint32x4_t efgh = vld1q_u32(state + 4);
+		for (; count != 0; count--, blocks += BLOCK_LENGTH)
+		{
+			uint32x4_t savedAbcd = abcd;
+			uint32x4_t savedEfgh = efgh;
+			uint32x4_t w[4];
+			for (int i = 0; i < 4; i++)
+			{
+				w[i] = LoadWords(blocks + i * 16);
+			}
+			// Every group of 4 rounds uses w[g % 4], and then replaces it with the words of group g + 4
+			for (int g = 0; g < 16; g++)
+			{
+				uint32x4_t message = vaddq_u32(w[g % 4], vld1q_u32(SHA256_ROUND_CONSTANTS + g * 4));
+				uint32x4_t previousAbcd = abcd;
+				abcd = vsha256hq_u32(abcd, efgh, message);
+				efgh = vsha256h2q_u32(efgh, previousAbcd, message);
+				if (g < 12)
+				{
+					w[g % 4] = vsha256su1q_u32(vsha256su0q_u32(w[g % 4], w[(g + 1) % 4]), w[(g + 2) % 4], w[(g + 3) % 4]);
+				}
+			}
+			abcd = vaddq_u32(abcd, savedAbcd);
+			efgh = vaddq_u32(efgh, savedEfgh);
+		}
+		vst1q_u32(state, abcd);
+		vst1q_u32(state + 4, efgh);
+	}
+}
+#endif
@@ -0,0 +1,272 @@
+// x86 SHA-NI and AVX2 hashing kernels. Every kernel is compiled for its own
+// instruction set, so the rest of the library still runs on any x86 CPU
+#include "HashKernels.hpp"
+#if defined EYESOL_SIMD_X86
+
+namespace Eyesol::Hashing::Impl::X86
+{
+	#pragma region nameless namespace (kernels)
+	namespace
+	{
+		constexpr std::size_t BLOCK_LENGTH = 64;
+
+		// SHA-1 rounds of group G of 4 rounds. Groups are unrolled by the recursion,
+		// so the round function is an immediate operand and message words stay in registers
+		template <int G>
+		EYESOL_TARGET("sha,sse4.1")
+		void Sha1Group(__m128i& abcd, __m128i& e, __m128i& previousAbcd, __m128i (&w)[4]) noexcept
+		{
+			if constexpr (G == 0)
+			{
+				e = _mm_add_epi32(e, w[0]);
+			}
+			else
+			{
+				e = _mm_sha1nexte_epu32(previousAbcd, w[G % 4]);
+			}
+			previousAbcd = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e, G / 5);
+			if constexpr (G < 16)
+			{
+				// The words of group G + 4 replace the ones just used
+				__m128i next = _mm_xor_si128(_mm_sha1msg1_epu32(w[G % 4], w[(G + 1) % 4]), w[(G + 2) % 4]);
+				w[G % 4] = _mm_sha1msg2_epu32(next, w[(G + 3) % 4]);
+			}
+			if constexpr (G < 19)
+			{
+				Sha1Group<G + 1>(abcd, e, previousAbcd, w);
+			}
+		}
+
+		// SHA-256 rounds of group G of 4 rounds, unrolled the same way
+		template <int G>
+		EYESOL_TARGET("sha,sse4.1")
+		void Sha256Group(__m128i& abef, __m128i& cdgh, __m128i (&w)[4]) noexcept
+		{
+			__m128i message = _mm_add_epi32(w[G % 4], _mm_loadu_si128(reinterpret_cast<const __m128i*>(SHA256_ROUND_CONSTANTS + G * 4)));
+			cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+			abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message, 0x0E));
+			if constexpr (G < 12)
+			{
+				__m128i next = _mm_add_epi32(_mm_sha256msg1_epu32(w[G % 4], w[(G + 1) % 4]), _mm_alignr_epi8(w[(G + 3) % 4], w[(G + 2) % 4], 4));
+				w[G % 4] = _mm_sha256msg2_epu32(next, w[(G + 3) % 4]);
+			}
+			if constexpr (G < 15)
+			{
+				Sha256Group<G + 1>(abef, cdgh, w);
+			}
+		}
+
+		// Rotates every 32-bit element
+		template <int Count>
+		EYESOL_TARGET("avx2")
+		__m256i Rotr(__m256i x) noexcept
+		{
+			return _mm256_or_si256(_mm256_srli_epi32(x, Count), _mm256_slli_epi32(x, 32 - Count));
+		}
+
+		template <int Count>
+		EYESOL_TARGET("avx2")
+		__m256i Rotl(__m256i x) noexcept
+		{
+			return Rotr<32 - Count>(x);
+		}
+
+		// Loads 8 big endian dwords at the offset of every lane's block, so word i of lane j
+		// is element j of words[i]. Rows are transposed by unpacks and cross-lane permutes
+		EYESOL_TARGET("avx2")
+		void LoadTransposed(const unsigned char* const* blocks, std::size_t offset, __m256i* words) noexcept
+		{
+			const __m256i byteSwap = _mm256_setr_epi8(
+				3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+				3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+			__m256i rows[AVX2_LANES];
+			for (std::size_t lane = 0; lane < AVX2_LANES; lane++)
+			{
+				rows[lane] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks[lane] + offset)), byteSwap);
+			}
+			__m256i pairs[AVX2_LANES];
+			for (std::size_t i = 0; i < AVX2_LANES; i += 2)
+			{
+				pairs[i] = _mm256_unpacklo_epi32(rows[i], rows[i + 1]);
+				pairs[i + 1] = _mm256_unpackhi_epi32(rows[i], rows[i + 1]);
+			}
+			// quads[0..3] hold words (0, 4), (1, 5), (2, 6), (3, 7) of lanes 0-3, quads[4..7] - of lanes 4-7
+			__m256i quads[AVX2_LANES];
+			for (std::size_t half = 0; half < 2; half++)
+			{
+				const __m256i* p = pairs + half * 4;
+				__m256i* q = quads + half * 4;
+				q[0] = _mm256_unpacklo_epi64(p[0], p[2]);
+				q[1] = _mm256_unpackhi_epi64(p[0], p[2]);
+				q[2] = _mm256_unpacklo_epi64(p[1], p[3]);
+				q[3] = _mm256_unpackhi_epi64(p[1], p[3]);
+			}
+			for (std::size_t i = 0; i < 4; i++)
+			{
+				words[i] = _mm256_permute2x128_si256(quads[i], quads[i + 4], 0x20);
+				words[i + 4] = _mm256_permute2x128_si256(quads[i], quads[i + 4], 0x31);
+			}
+		}
+	}
+	#pragma endregion
+
+	#pragma region SHA-NI
+	EYESOL_TARGET("sha,sse4.1")
+	void ShaNiSha1Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept
+	{
+		const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+		// The instructions keep A in the highest element
+		__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+		__m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+		for (; count != 0; count--, blocks += BLOCK_LENGTH)
+		{
+			__m128i savedAbcd = abcd;
+			__m128i savedE = e0;
+			__m128i e = e0;
+			__m128i previousAbcd = abcd;
+			__m128i w[4];
+			for (int i = 0; i < 4; i++)
+			{
+				w[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + i * 16)), byteSwap);
+			}
+			Sha1Group<0>(abcd, e, previousAbcd, w);
+			e0 = _mm_sha1nexte_epu32(previousAbcd, savedE);
+			abcd = _mm_add_epi32(abcd, savedAbcd);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+		state[4] = static_cast<std::uint32_t>(_mm_extract_epi32(e0, 3));
+	}
+
+	EYESOL_TARGET("sha,sse4.1")
+	void ShaNiSha256Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept
+	{
+		const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+		// The instructions take the state as ABEF and CDGH vectors
+		__m128i cdab = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+		__m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+		__m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+		__m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+		for (; count != 0; count--, blocks += BLOCK_LENGTH)
+		{
+			__m128i savedAbef = abef;
+			__m128i savedCdgh = cdgh;
+			__m128i w[4];
+			for (int i = 0; i < 4; i++)
+			{
+				w[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + i * 16)), byteSwap);
+			}
+			Sha256Group<0>(abef, cdgh, w);
+			abef = _mm_add_epi32(abef, savedAbef);
+			cdgh = _mm_add_epi32(cdgh, savedCdgh);
+		}
+		__m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+		__m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+	}
+	#pragma endregion
+
+	#pragma region AVX2 lanes
+	EYESOL_TARGET("avx2")
+	void Avx2Sha1Lanes(std::uint32_t* states, const unsigned char* const* blocks) noexcept
+	{
+		__m256i w[16];
+		LoadTransposed(blocks, 0, w);
+		LoadTransposed(blocks, 32, w + 8);
+		__m256i* state = reinterpret_cast<__m256i*>(states);
+		__m256i a = _mm256_loadu_si256(state);
+		__m256i b = _mm256_loadu_si256(state + 1);
+		__m256i c = _mm256_loadu_si256(state + 2);
+		__m256i d = _mm256_loadu_si256(state + 3);
+		__m256i e = _mm256_loadu_si256(state + 4);
+		for (int t = 0; t < 80; t++)
+		{
+			if (t >= 16)
+			{
+				__m256i x = _mm256_xor_si256(_mm256_xor_si256(w[(t - 3) & 15], w[(t - 8) & 15]), _mm256_xor_si256(w[(t - 14) & 15], w[t & 15]));
+				w[t & 15] = Rotl<1>(x);
+			}
+			__m256i f;
+			std::uint32_t k;
+			if (t < 20)
+			{
+				f = _mm256_xor_si256(d, _mm256_and_si256(b, _mm256_xor_si256(c, d)));
+				k = 0x5a827999;
+			}
+			else if (t < 40)
+			{
+				f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+				k = 0x6ed9eba1;
+			}
+			else if (t < 60)
+			{
+				f = _mm256_or_si256(_mm256_and_si256(b, c), _mm256_and_si256(d, _mm256_or_si256(b, c)));
+				k = 0x8f1bbcdc;
+			}
+			else
+			{
+				f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+				k = 0xca62c1d6;
+			}
+			__m256i temp = _mm256_add_epi32(_mm256_add_epi32(Rotl<5>(a), f), _mm256_add_epi32(_mm256_add_epi32(e, w[t & 15]), _mm256_set1_epi32(static_cast<int>(k))));
+			e = d;
+			d = c;
+			c = Rotl<30>(b);
+			b = a;
+			a = temp;
+		}
+		_mm256_storeu_si256(state, _mm256_add_epi32(_mm256_loadu_si256(state), a));
+		_mm256_storeu_si256(state + 1, _mm256_add_epi32(_mm256_loadu_si256(state + 1), b));
+		_mm256_storeu_si256(state + 2, _mm256_add_epi32(_mm256_loadu_si256(state + 2), c));
+		_mm256_storeu_si256(state + 3, _mm256_add_epi32(_mm256_loadu_si256(state + 3), d));
+		_mm256_storeu_si256(state + 4, _mm256_add_epi32(_mm256_loadu_si256(state + 4), e));
+	}
+
+	EYESOL_TARGET("avx2")
+	void Avx2Sha256Lanes(std::uint32_t* states, const unsigned char* const* blocks) noexcept
+	{
+		__m256i w[16];
+		LoadTransposed(blocks, 0, w);
+		LoadTransposed(blocks, 32, w + 8);
+		__m256i* state = reinterpret_cast<__m256i*>(states);
+		__m256i v[8];
+		for (int i = 0; i < 8; i++)
+		{
+			v[i] = _mm256_loadu_si256(state + i);
+		}
+		__m256i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+		for (int t = 0; t < 64; t++)
+		{
+			if (t >= 16)
+			{
+				__m256i w15 = w[(t - 15) & 15];
+				__m256i w2 = w[(t - 2) & 15];
+				__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(Rotr<7>(w15), Rotr<18>(w15)), _mm256_srli_epi32(w15, 3));
+				__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(Rotr<17>(w2), Rotr<19>(w2)), _mm256_srli_epi32(w2, 10));
+				w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0), _mm256_add_epi32(w[(t - 7) & 15], s1));
+			}
+			__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(Rotr<6>(e), Rotr<11>(e)), Rotr<25>(e));
+			__m256i ch = _mm256_xor_si256(g, _mm256_and_si256(e, _mm256_xor_si256(f, g)));
+			__m256i k = _mm256_set1_epi32(static_cast<int>(SHA256_ROUND_CONSTANTS[t]));
+			__m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(h, s1), _mm256_add_epi32(ch, k)), w[t & 15]);
+			__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(Rotr<2>(a), Rotr<13>(a)), Rotr<22>(a));
+			__m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+			h = g;
+			g = f;
+			f = e;
+			e = _mm256_add_epi32(d, temp1);
+			d = c;
+			c = b;
+			b = a;
+			a = _mm256_add_epi32(temp1, _mm256_add_epi32(s0, maj));
+		}
+		__m256i result[8] = { a, b, c, d, e, f, g, h };
+		for (int i = 0; i < 8; i++)
+		{
+			_mm256_storeu_si256(state + i, _mm256_add_epi32(v[i], result[i]));
+		}
+	}
+	#pragma endregion
+}
+#endif
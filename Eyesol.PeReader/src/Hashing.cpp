@@ -0,0 +1,670 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include "CpuFeatures.hpp"
+#include "Hashing.hpp"
+#include "HashKernels.hpp"
+#include "Memory.hpp"
+
+namespace Eyesol::Hashing
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		// Per-round shift amounts and sine-derived constants (RFC 1321)
+		constexpr std::uint32_t MD5_SHIFTS[64] =
+		{
+			7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+			5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+			4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+			6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+		};
+
+		constexpr std::uint32_t MD5_CONSTANTS[64] =
+		{
+			0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+			0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+			0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+			0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+			0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+			0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+			0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+			0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+		};
+
+		constexpr std::uint32_t SHA1_INITIAL_STATE[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+		constexpr std::uint32_t SHA256_INITIAL_STATE[8] =
+		{
+			0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+		};
+
+		constexpr std::size_t SHA_BLOCK_LENGTH = 64;
+
+		// Message padding: 0x80, zeros and the big endian bit length, which ends the last block.
+		// Returns the padding length, either up to a block or up to two blocks
+		std::size_t MakeShaPadding(std::uint64_t messageLength, unsigned char (&padding)[SHA_BLOCK_LENGTH * 2]) noexcept
+		{
+			std::size_t buffered = static_cast<std::size_t>(messageLength % SHA_BLOCK_LENGTH);
+			std::size_t paddingLength = (buffered < SHA_BLOCK_LENGTH - 8 ? SHA_BLOCK_LENGTH : SHA_BLOCK_LENGTH * 2) - buffered;
+			std::memset(padding, 0, paddingLength);
+			padding[0] = 0x80;
+			Memory::UnalignedWrite<std::endian::big>(padding + paddingLength - 8, messageLength * 8);
+			return paddingLength;
+		}
+
+		// Completes a buffered partial block, then compresses whole blocks of the data in place
+		void UpdateBuffered(std::uint32_t* state, unsigned char* buffer, std::uint64_t& length, std::span<const unsigned char> data, Impl::CompressBlocksFunction compress) noexcept
+		{
+			std::size_t buffered = static_cast<std::size_t>(length % SHA_BLOCK_LENGTH);
+			length += data.size();
+			const unsigned char* ptr = data.data();
+			std::size_t remaining = data.size();
+			if (buffered != 0)
+			{
+				std::size_t toCopy = std::min(remaining, SHA_BLOCK_LENGTH - buffered);
+				std::memcpy(buffer + buffered, ptr, toCopy);
+				ptr += toCopy;
+				remaining -= toCopy;
+				if (buffered + toCopy < SHA_BLOCK_LENGTH)
+				{
+					return;
+				}
+				compress(state, buffer, 1);
+			}
+			std::size_t blocks = remaining / SHA_BLOCK_LENGTH;
+			if (blocks != 0)
+			{
+				compress(state, ptr, blocks);
+				ptr += blocks * SHA_BLOCK_LENGTH;
+				remaining -= blocks * SHA_BLOCK_LENGTH;
+			}
+			if (remaining != 0)
+			{
+				std::memcpy(buffer, ptr, remaining);
+			}
+		}
+
+		template <std::size_t Words>
+		std::array<std::uint8_t, Words * sizeof(std::uint32_t)> ShaDigest(const std::uint32_t* state) noexcept
+		{
+			std::array<std::uint8_t, Words * sizeof(std::uint32_t)> digest;
+			for (std::size_t i = 0; i < Words; i++)
+			{
+				Memory::UnalignedWrite<std::endian::big>(digest.data() + i * sizeof(std::uint32_t), state[i]);
+			}
+			return digest;
+		}
+
+		// Adapts a kernel compressing blocks of a single message to the multi-buffer interface
+		template <Impl::CompressBlocksFunction Compress>
+		void SingleLane(std::uint32_t* states, const unsigned char* const* blocks)
+		{
+			Compress(states, blocks[0], 1);
+		}
+
+		// A function-local static is safe to use during static initialization of other files
+		const Cpu::DispatchTable<Impl::CompressBlocksFunction>& Sha1BlocksTable()
+		{
+			static const Cpu::DispatchTable<Impl::CompressBlocksFunction> table
+			{
+#if defined EYESOL_SIMD_X86
+				{ { Cpu::Feature::Sha, Cpu::Feature::Ssse3, Cpu::Feature::Sse41 }, Impl::X86::ShaNiSha1Blocks, "sha" },
+#elif defined EYESOL_SIMD_ARM_CRYPTO
+				{ Cpu::Feature::ArmSha1, Impl::Arm::CryptoSha1Blocks, "sha1" },
+#endif
+				{ {}, Impl::PortableSha1Blocks, "portable" }
+			};
+			return table;
+		}
+
+		const Cpu::DispatchTable<Impl::CompressBlocksFunction>& Sha256BlocksTable()
+		{
+			static const Cpu::DispatchTable<Impl::CompressBlocksFunction> table
+			{
+#if defined EYESOL_SIMD_X86
+				{ { Cpu::Feature::Sha, Cpu::Feature::Ssse3, Cpu::Feature::Sse41 }, Impl::X86::ShaNiSha256Blocks, "sha" },
+#elif defined EYESOL_SIMD_ARM_CRYPTO
+				{ Cpu::Feature::ArmSha2, Impl::Arm::CryptoSha256Blocks, "sha2" },
+#endif
+				{ {}, Impl::PortableSha256Blocks, "portable" }
+			};
+			return table;
+		}
+
+		// Dedicated instructions are about as fast as 8 AVX2 lanes, and need no other messages
+		// to fill the lanes, so AVX2 is only used without them
+		const Cpu::DispatchTable<Impl::LanesKernel>& Sha1LanesTable()
+		{
+			static const Cpu::DispatchTable<Impl::LanesKernel> table
+			{
+#if defined EYESOL_SIMD_X86
+				{ { Cpu::Feature::Sha, Cpu::Feature::Ssse3, Cpu::Feature::Sse41 }, { 1, SingleLane<Impl::X86::ShaNiSha1Blocks> }, "sha" },
+				{ Cpu::Feature::Avx2, { Impl::X86::AVX2_LANES, Impl::X86::Avx2Sha1Lanes }, "avx2" },
+#elif defined EYESOL_SIMD_ARM_CRYPTO
+				{ Cpu::Feature::ArmSha1, { 1, SingleLane<Impl::Arm::CryptoSha1Blocks> }, "sha1" },
+#endif
+				{ {}, { 1, SingleLane<Impl::PortableSha1Blocks> }, "portable" }
+			};
+			return table;
+		}
+
+		const Cpu::DispatchTable<Impl::LanesKernel>& Sha256LanesTable()
+		{
+			static const Cpu::DispatchTable<Impl::LanesKernel> table
+			{
+#if defined EYESOL_SIMD_X86
+				{ { Cpu::Feature::Sha, Cpu::Feature::Ssse3, Cpu::Feature::Sse41 }, { 1, SingleLane<Impl::X86::ShaNiSha256Blocks> }, "sha" },
+				{ Cpu::Feature::Avx2, { Impl::X86::AVX2_LANES, Impl::X86::Avx2Sha256Lanes }, "avx2" },
+#elif defined EYESOL_SIMD_ARM_CRYPTO
+				{ Cpu::Feature::ArmSha2, { 1, SingleLane<Impl::Arm::CryptoSha256Blocks> }, "sha2" },
+#endif
+				{ {}, { 1, SingleLane<Impl::PortableSha256Blocks> }, "portable" }
+			};
+			return table;
+		}
+
+		// A message being hashed in a lane of MultiBufferHasher
+		class Lane
+		{
+		public:
+			static constexpr std::size_t NO_MESSAGE = ~std::size_t{};
+
+			Lane() noexcept
+				: _message{ NO_MESSAGE },
+				_reader{},
+				_piece{},
+				_length{},
+				_buffered{},
+				_padded{},
+				_paddedBlocks{},
+				_ended{},
+				_buffer{}
+			{
+			}
+
+			std::size_t message() const noexcept { return _message; }
+
+			void Start(std::size_t message, MultiBufferHasher::Reader* reader) noexcept
+			{
+				*this = Lane{};
+				_message = message;
+				_reader = reader;
+			}
+
+			void Stop() noexcept
+			{
+				_message = NO_MESSAGE;
+			}
+
+			// Returns nullptr after the last padded block
+			Result<const unsigned char*> NextBlock()
+			{
+				if (_padded != _paddedBlocks)
+				{
+					return _buffer + SHA_BLOCK_LENGTH * _padded++;
+				}
+				if (_paddedBlocks != 0)
+				{
+					return nullptr;
+				}
+				while (true)
+				{
+					// Whole blocks are hashed in place, only blocks crossing pieces are copied
+					if (_buffered == 0 && _piece.size() >= SHA_BLOCK_LENGTH)
+					{
+						const unsigned char* block = _piece.data();
+						_piece = _piece.subspan(SHA_BLOCK_LENGTH);
+						_length += SHA_BLOCK_LENGTH;
+						return block;
+					}
+					if (!_piece.empty())
+					{
+						std::size_t toCopy = std::min(_piece.size(), SHA_BLOCK_LENGTH - _buffered);
+						std::memcpy(_buffer + _buffered, _piece.data(), toCopy);
+						_piece = _piece.subspan(toCopy);
+						_buffered += toCopy;
+						_length += toCopy;
+						if (_buffered == SHA_BLOCK_LENGTH)
+						{
+							_buffered = 0;
+							return _buffer;
+						}
+						continue;
+					}
+					if (!_ended)
+					{
+						Result<std::span<const unsigned char>> piece = (*_reader)();
+						if (!piece)
+						{
+							return Unexpected{ piece.error() };
+						}
+						_piece = *piece;
+						_ended = _piece.empty();
+						continue;
+					}
+					unsigned char padding[SHA_BLOCK_LENGTH * 2];
+					std::size_t paddingLength = MakeShaPadding(_length, padding);
+					std::memcpy(_buffer + _buffered, padding, paddingLength);
+					_paddedBlocks = (_buffered + paddingLength) / SHA_BLOCK_LENGTH;
+					_padded = 1;
+					return _buffer;
+				}
+			}
+
+		private:
+			std::size_t _message;
+			MultiBufferHasher::Reader* _reader;
+			// The rest of the last piece read
+			std::span<const unsigned char> _piece;
+			std::uint64_t _length;
+			std::size_t _buffered;
+			// Padded blocks returned and their total count
+			std::size_t _padded;
+			std::size_t _paddedBlocks;
+			bool _ended;
+			// A block crossing pieces, or the padded last blocks
+			unsigned char _buffer[SHA_BLOCK_LENGTH * 2];
+		};
+	}
+	#pragma endregion
+
+	#pragma region Portable SHA kernels
+	namespace Impl
+	{
+		const std::uint32_t SHA256_ROUND_CONSTANTS[64] =
+		{
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+			0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+			0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+			0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+			0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+			0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+			0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+		};
+
+		void PortableSha1Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept
+		{
+			for (; count != 0; count--, blocks += SHA_BLOCK_LENGTH)
+			{
+				std::uint32_t w[80];
+				for (std::size_t t = 0; t < 16; t++)
+				{
+					Memory::UnalignedRead<std::endian::big>(blocks + t * sizeof(std::uint32_t), w[t]);
+				}
+				for (std::size_t t = 16; t < 80; t++)
+				{
+					w[t] = std::rotl(w[t - 3] ^ w[t - 8] ^ w[t - 14] ^ w[t - 16], 1);
+				}
+				std::uint32_t a = state[0];
+				std::uint32_t b = state[1];
+				std::uint32_t c = state[2];
+				std::uint32_t d = state[3];
+				std::uint32_t e = state[4];
+				for (std::size_t t = 0; t < 80; t++)
+				{
+					std::uint32_t f;
+					std::uint32_t k;
+					if (t < 20)
+					{
+						f = (b & c) | (~b & d);
+						k = 0x5a827999;
+					}
+					else if (t < 40)
+					{
+						f = b ^ c ^ d;
+						k = 0x6ed9eba1;
+					}
+					else if (t < 60)
+					{
+						f = (b & c) | (b & d) | (c & d);
+						k = 0x8f1bbcdc;
+					}
+					else
+					{
+						f = b ^ c ^ d;
+						k = 0xca62c1d6;
+					}
+					std::uint32_t temp = std::rotl(a, 5) + f + e + k + w[t];
+					e = d;
+					d = c;
+					c = std::rotl(b, 30);
+					b = a;
+					a = temp;
+				}
+				state[0] += a;
+				state[1] += b;
+				state[2] += c;
+				state[3] += d;
+				state[4] += e;
+			}
+		}
+
+		void PortableSha256Blocks(std::uint32_t* state, const unsigned char* blocks, std::size_t count) noexcept
+		{
+			for (; count != 0; count--, blocks += SHA_BLOCK_LENGTH)
+			{
+				std::uint32_t w[64];
+				for (std::size_t t = 0; t < 16; t++)
+				{
+					Memory::UnalignedRead<std::endian::big>(blocks + t * sizeof(std::uint32_t), w[t]);
+				}
+				for (std::size_t t = 16; t < 64; t++)
+				{
+					std::uint32_t s0 = std::rotr(w[t - 15], 7) ^ std::rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+					std::uint32_t s1 = std::rotr(w[t - 2], 17) ^ std::rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+					w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+				}
+				std::uint32_t a = state[0];
+				std::uint32_t b = state[1];
+				std::uint32_t c = state[2];
+				std::uint32_t d = state[3];
+				std::uint32_t e = state[4];
+				std::uint32_t f = state[5];
+				std::uint32_t g = state[6];
+				std::uint32_t h = state[7];
+				for (std::size_t t = 0; t < 64; t++)
+				{
+					std::uint32_t s1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+					std::uint32_t ch = (e & f) ^ (~e & g);
+					std::uint32_t temp1 = h + s1 + ch + SHA256_ROUND_CONSTANTS[t] + w[t];
+					std::uint32_t s0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+					std::uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+					std::uint32_t temp2 = s0 + maj;
+					h = g;
+					g = f;
+					f = e;
+					e = d + temp1;
+					d = c;
+					c = b;
+					b = a;
+					a = temp1 + temp2;
+				}
+				state[0] += a;
+				state[1] += b;
+				state[2] += c;
+				state[3] += d;
+				state[4] += e;
+				state[5] += f;
+				state[6] += g;
+				state[7] += h;
+			}
+		}
+	}
+	#pragma endregion
+
+	Md5::Md5() noexcept
+	{
+		Reset();
+	}
+
+	void Md5::Reset() noexcept
+	{
+		_state = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+		_length = 0;
+	}
+
+	void Md5::Update(std::span<const unsigned char> data) noexcept
+	{
+		std::size_t buffered = static_cast<std::size_t>(_length % BLOCK_LENGTH);
+		_length += data.size();
+		const unsigned char* ptr = data.data();
+		std::size_t remaining = data.size();
+		if (buffered != 0)
+		{
+			std::size_t toCopy = std::min(remaining, BLOCK_LENGTH - buffered);
+			std::memcpy(_buffer.data() + buffered, ptr, toCopy);
+			ptr += toCopy;
+			remaining -= toCopy;
+			if (buffered + toCopy < BLOCK_LENGTH)
+			{
+				return;
+			}
+			ProcessBlock(_buffer.data());
+		}
+		// Whole blocks are hashed in place
+		for (; remaining >= BLOCK_LENGTH; ptr += BLOCK_LENGTH, remaining -= BLOCK_LENGTH)
+		{
+			ProcessBlock(ptr);
+		}
+		if (remaining != 0)
+		{
+			std::memcpy(_buffer.data(), ptr, remaining);
+		}
+	}
+
+	void Md5::Update(std::string_view str) noexcept
+	{
+		Update({ reinterpret_cast<const unsigned char*>(str.data()), str.size() });
+	}
+
+	Md5::Digest Md5::Final() noexcept
+	{
+		std::uint64_t messageBits = _length * 8;
+		unsigned char padding[BLOCK_LENGTH * 2] = { 0x80 };
+		std::size_t buffered = static_cast<std::size_t>(_length % BLOCK_LENGTH);
+		// The padding leaves room for the message length in the last 8 bytes of a block
+		std::size_t paddingLength = (buffered < BLOCK_LENGTH - 8 ? BLOCK_LENGTH : BLOCK_LENGTH * 2) - buffered - 8;
+		Update({ padding, paddingLength });
+		unsigned char lengthBytes[8];
+		Memory::UnalignedWrite<std::endian::little>(lengthBytes, messageBits);
+		Update({ lengthBytes, sizeof(lengthBytes) });
+
+		Digest digest;
+		for (std::size_t i = 0; i < _state.size(); i++)
+		{
+			Memory::UnalignedWrite<std::endian::little>(digest.data() + i * sizeof(std::uint32_t), _state[i]);
+		}
+		return digest;
+	}
+
+	void Md5::ProcessBlock(const unsigned char* block) noexcept
+	{
+		std::uint32_t m[16];
+		for (std::size_t i = 0; i < 16; i++)
+		{
+			Memory::UnalignedRead<std::endian::little>(block + i * sizeof(std::uint32_t), m[i]);
+		}
+		std::uint32_t a = _state[0];
+		std::uint32_t b = _state[1];
+		std::uint32_t c = _state[2];
+		std::uint32_t d = _state[3];
+		for (std::uint32_t i = 0; i < 64; i++)
+		{
+			std::uint32_t f;
+			std::uint32_t g;
+			switch (i / 16)
+			{
+			case 0:
+				f = (b & c) | (~b & d);
+				g = i;
+				break;
+			case 1:
+				f = (d & b) | (~d & c);
+				g = (5 * i + 1) % 16;
+				break;
+			case 2:
+				f = b ^ c ^ d;
+				g = (3 * i + 5) % 16;
+				break;
+			default:
+				f = c ^ (b | ~d);
+				g = (7 * i) % 16;
+				break;
+			}
+			std::uint32_t rotated = std::rotl(a + f + MD5_CONSTANTS[i] + m[g], static_cast<int>(MD5_SHIFTS[i]));
+			a = d;
+			d = c;
+			c = b;
+			b += rotated;
+		}
+		_state[0] += a;
+		_state[1] += b;
+		_state[2] += c;
+		_state[3] += d;
+	}
+
+	std::size_t DigestLength(HashAlgorithm algorithm) noexcept
+	{
+		return algorithm == HashAlgorithm::Sha1 ? Sha1::DIGEST_LENGTH : Sha256::DIGEST_LENGTH;
+	}
+
+	#pragma region Sha1
+	Sha1::Sha1() noexcept
+	{
+		Reset();
+	}
+
+	void Sha1::Reset() noexcept
+	{
+		std::copy(std::begin(SHA1_INITIAL_STATE), std::end(SHA1_INITIAL_STATE), _state.begin());
+		_length = 0;
+	}
+
+	void Sha1::Update(std::span<const unsigned char> data) noexcept
+	{
+		UpdateBuffered(_state.data(), _buffer.data(), _length, data, *Sha1BlocksTable());
+	}
+
+	void Sha1::Update(std::string_view str) noexcept
+	{
+		Update({ reinterpret_cast<const unsigned char*>(str.data()), str.size() });
+	}
+
+	Sha1::Digest Sha1::Final() noexcept
+	{
+		unsigned char padding[SHA_BLOCK_LENGTH * 2];
+		std::size_t paddingLength = MakeShaPadding(_length, padding);
+		Update({ padding, paddingLength });
+		return ShaDigest<5>(_state.data());
+	}
+	#pragma endregion
+
+	#pragma region Sha256
+	Sha256::Sha256() noexcept
+	{
+		Reset();
+	}
+
+	void Sha256::Reset() noexcept
+	{
+		std::copy(std::begin(SHA256_INITIAL_STATE), std::end(SHA256_INITIAL_STATE), _state.begin());
+		_length = 0;
+	}
+
+	void Sha256::Update(std::span<const unsigned char> data) noexcept
+	{
+		UpdateBuffered(_state.data(), _buffer.data(), _length, data, *Sha256BlocksTable());
+	}
+
+	void Sha256::Update(std::string_view str) noexcept
+	{
+		Update({ reinterpret_cast<const unsigned char*>(str.data()), str.size() });
+	}
+
+	Sha256::Digest Sha256::Final() noexcept
+	{
+		unsigned char padding[SHA_BLOCK_LENGTH * 2];
+		std::size_t paddingLength = MakeShaPadding(_length, padding);
+		Update({ padding, paddingLength });
+		return ShaDigest<8>(_state.data());
+	}
+	#pragma endregion
+
+	#pragma region MultiBufferHasher
+	MultiBufferHasher::MultiBufferHasher(HashAlgorithm algorithm) noexcept
+		: _algorithm{ algorithm }
+	{
+	}
+
+	std::size_t MultiBufferHasher::lanes() const noexcept
+	{
+		return _algorithm == HashAlgorithm::Sha1 ? Sha1LanesTable()->lanes : Sha256LanesTable()->lanes;
+	}
+
+	std::vector<MultiBufferHasher::Digest> MultiBufferHasher::Hash(std::span<Reader> readers) const
+	{
+		const Impl::LanesKernel& kernel = _algorithm == HashAlgorithm::Sha1 ? *Sha1LanesTable() : *Sha256LanesTable();
+		const std::uint32_t* initialState = _algorithm == HashAlgorithm::Sha1 ? SHA1_INITIAL_STATE : SHA256_INITIAL_STATE;
+		std::size_t words = DigestLength(_algorithm) / sizeof(std::uint32_t);
+		std::size_t lanesCount = kernel.lanes;
+		// Idle lanes compress this block, and their states are ignored
+		static constexpr unsigned char IDLE_BLOCK[SHA_BLOCK_LENGTH]{};
+
+		std::vector<Digest> digests(readers.size(), Unexpected{ ErrorCode::EmptyObject });
+		std::vector<Lane> lanes(lanesCount);
+		std::vector<std::uint32_t> states(words * lanesCount);
+		std::vector<const unsigned char*> blocks(lanesCount, IDLE_BLOCK);
+		std::size_t nextMessage = 0;
+		auto startNext = [&](std::size_t lane)
+			{
+				if (nextMessage == readers.size())
+				{
+					lanes[lane].Stop();
+					return;
+				}
+				lanes[lane].Start(nextMessage, &readers[nextMessage]);
+				nextMessage++;
+				for (std::size_t i = 0; i < words; i++)
+				{
+					states[i * lanesCount + lane] = initialState[i];
+				}
+			};
+		for (std::size_t lane = 0; lane < lanesCount; lane++)
+		{
+			startNext(lane);
+		}
+		while (true)
+		{
+			bool active = false;
+			for (std::size_t lane = 0; lane < lanesCount; lane++)
+			{
+				blocks[lane] = IDLE_BLOCK;
+				while (lanes[lane].message() != Lane::NO_MESSAGE)
+				{
+					std::size_t message = lanes[lane].message();
+					Result<const unsigned char*> block = lanes[lane].NextBlock();
+					if (!block)
+					{
+						digests[message] = Unexpected{ block.error() };
+						startNext(lane);
+						continue;
+					}
+					if (*block == nullptr)
+					{
+						std::vector<std::uint8_t> digest(words * sizeof(std::uint32_t));
+						for (std::size_t i = 0; i < words; i++)
+						{
+							Memory::UnalignedWrite<std::endian::big>(digest.data() + i * sizeof(std::uint32_t), states[i * lanesCount + lane]);
+						}
+						digests[message] = std::move(digest);
+						startNext(lane);
+						continue;
+					}
+					blocks[lane] = *block;
+					active = true;
+					break;
+				}
+			}
+			if (!active)
+			{
+				break;
+			}
+			kernel.compress(states.data(), blocks.data());
+		}
+		return digests;
+	}
+	#pragma endregion
+
+	std::string ToHexString(std::span<const std::uint8_t> digest)
+	{
+		constexpr char DIGITS[] = "0123456789abcdef";
+		std::string str(digest.size() * 2, '\0');
+		for (std::size_t i = 0; i < digest.size(); i++)
+		{
+			str[i * 2] = DIGITS[digest[i] >> 4];
+			str[i * 2 + 1] = DIGITS[digest[i] & 0xF];
+		}
+		return str;
+	}
+}
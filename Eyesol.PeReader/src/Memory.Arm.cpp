@@ -0,0 +1,125 @@
+// AArch64 NEON memory kernels
+#include "Memory.hpp"
+#include "MemoryKernels.hpp"
+#if defined EYESOL_SIMD_NEON
+
+namespace Eyesol::Memory::Impl::Arm
+{
+	#pragma region nameless namespace (kernels)
+	namespace
+	{
+		template <std::unsigned_integral T>
+		uint8x16_t ReverseElements(uint8x16_t vector) noexcept
+		{
+			if constexpr (sizeof(T) == 2)
+			{
+				return vrev16q_u8(vector);
+			}
+			else if constexpr (sizeof(T) == 4)
+			{
+				return vrev32q_u8(vector);
+			}
+			else
+			{
+				return vrev64q_u8(vector);
+			}
+		}
+
+		template <std::unsigned_integral T>
+		void NeonByteSwap(const void* src, void* dst, std::size_t count)
+		{
+			constexpr std::size_t VECTOR_ELEMENTS = 16 / sizeof(T);
+			const unsigned char* srcBytes = static_cast<const unsigned char*>(src);
+			unsigned char* dstBytes = static_cast<unsigned char*>(dst);
+			std::size_t i = 0;
+			for (; i + VECTOR_ELEMENTS <= count; i += VECTOR_ELEMENTS)
+			{
+				// vld1q/vst1q don't require alignment
+				uint8x16_t vector = vld1q_u8(srcBytes + i * sizeof(T));
+				vst1q_u8(dstBytes + i * sizeof(T), ReverseElements<T>(vector));
+			}
+			for (; i < count; i++)
+			{
+				T element;
+				std::memcpy(&element, srcBytes + i * sizeof(T), sizeof(T));
+				element = ByteSwap(element);
+				std::memcpy(dstBytes + i * sizeof(T), &element, sizeof(T));
+			}
+		}
+	}
+	#pragma endregion
+
+	// Lanes wrap around independently, and the sum of lanes modulo 2^16 is the sum of words
+	std::uint16_t NeonWordSum(const void* data, std::size_t length) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		uint16x8_t sum0 = vdupq_n_u16(0);
+		uint16x8_t sum1 = vdupq_n_u16(0);
+		std::size_t i = 0;
+		for (; i + 32 <= length; i += 32)
+		{
+			sum0 = vaddq_u16(sum0, vreinterpretq_u16_u8(vld1q_u8(bytes + i)));
+			sum1 = vaddq_u16(sum1, vreinterpretq_u16_u8(vld1q_u8(bytes + i + 16)));
+		}
+		std::uint16_t sum = vaddvq_u16(vaddq_u16(sum0, sum1));
+		return static_cast<std::uint16_t>(sum + PortableWordSum(bytes + i, length - i));
+	}
+
+	// A dword is a word plus the next one multiplied by 2^16, which is 1 in ones' complement arithmetic,
+	// so pairs of dwords are summed into 64-bit lanes, and carries are folded once at the end
+	std::uint16_t NeonOnesComplementSum(const void* data, std::size_t length) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		uint64x2_t sum0 = vdupq_n_u64(0);
+		uint64x2_t sum1 = vdupq_n_u64(0);
+		std::size_t i = 0;
+		for (; i + 32 <= length; i += 32)
+		{
+			sum0 = vpadalq_u32(sum0, vreinterpretq_u32_u8(vld1q_u8(bytes + i)));
+			sum1 = vpadalq_u32(sum1, vreinterpretq_u32_u8(vld1q_u8(bytes + i + 16)));
+		}
+		std::uint64_t sum = vaddvq_u64(vaddq_u64(sum0, sum1));
+		return FoldCarries(sum + PortableOnesComplementSum(bytes + i, length - i));
+	}
+
+	// Blocks are scanned from the end, so the first match is the last dword
+	std::size_t NeonFindLastDword(const void* data, std::size_t count, std::uint32_t pattern) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		const uint32x4_t patternVector = vdupq_n_u32(pattern);
+		std::size_t i = count;
+		for (; i >= 4; i -= 4)
+		{
+			const unsigned char* blockPtr = bytes + (i - 4) * sizeof(std::uint32_t);
+			uint32x4_t matches = vceqq_u32(vreinterpretq_u32_u8(vld1q_u8(blockPtr)), patternVector);
+			if (vmaxvq_u32(matches) != 0)
+			{
+				return i - 4 + PortableFindLastDword(blockPtr, 4, pattern);
+			}
+		}
+		std::size_t index = PortableFindLastDword(bytes, i, pattern);
+		return index != i ? index : count;
+	}
+
+	void NeonXorDwords(const void* src, void* dst, std::size_t count, std::uint32_t key) noexcept
+	{
+		const unsigned char* srcBytes = static_cast<const unsigned char*>(src);
+		unsigned char* dstBytes = static_cast<unsigned char*>(dst);
+		const uint8x16_t keyVector = vreinterpretq_u8_u32(vdupq_n_u32(key));
+		std::size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			uint8x16_t block = vld1q_u8(srcBytes + i * sizeof(std::uint32_t));
+			vst1q_u8(dstBytes + i * sizeof(std::uint32_t), veorq_u8(block, keyVector));
+		}
+		PortableXorDwords(srcBytes + i * sizeof(std::uint32_t), dstBytes + i * sizeof(std::uint32_t), count - i, key);
+	}
+
+	const ByteSwapKernels NeonByteSwapKernels
+	{
+		NeonByteSwap<std::uint16_t>,
+		NeonByteSwap<std::uint32_t>,
+		NeonByteSwap<std::uint64_t>
+	};
+}
+#endif
@@ -0,0 +1,250 @@
+// x86 SSE2, SSSE3 and AVX2 memory kernels. Every kernel is compiled for its own
+// instruction set, so the rest of the library still runs on any x86 CPU
+#include <array>
+#include <bit>
+#include "Memory.hpp"
+#include "MemoryKernels.hpp"
+#if defined EYESOL_SIMD_X86
+
+namespace Eyesol::Memory::Impl::X86
+{
+	#pragma region nameless namespace (kernels)
+	namespace
+	{
+		// PSHUFB masks reversing bytes of every element in a 16-byte lane
+		template <std::size_t ElementSize>
+		constexpr std::array<char, 16> SHUFFLE_MASK = [] {
+			std::array<char, 16> mask{};
+			for (std::size_t i = 0; i < mask.size(); i++)
+			{
+				mask[i] = static_cast<char>(i - i % ElementSize + ElementSize - 1 - i % ElementSize);
+			}
+			return mask;
+		}();
+
+		template <std::unsigned_integral T>
+		void ScalarTail(const unsigned char* src, unsigned char* dst, std::size_t count) noexcept
+		{
+			for (std::size_t i = 0; i < count; i++)
+			{
+				T element;
+				std::memcpy(&element, src + i * sizeof(T), sizeof(T));
+				element = ByteSwap(element);
+				std::memcpy(dst + i * sizeof(T), &element, sizeof(T));
+			}
+		}
+
+		template <std::unsigned_integral T>
+		EYESOL_TARGET("ssse3")
+		void Ssse3ByteSwap(const void* src, void* dst, std::size_t count)
+		{
+			constexpr std::size_t VECTOR_ELEMENTS = 16 / sizeof(T);
+			const unsigned char* srcBytes = static_cast<const unsigned char*>(src);
+			unsigned char* dstBytes = static_cast<unsigned char*>(dst);
+			const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(SHUFFLE_MASK<sizeof(T)>.data()));
+			std::size_t i = 0;
+			for (; i + VECTOR_ELEMENTS <= count; i += VECTOR_ELEMENTS)
+			{
+				__m128i vector = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcBytes + i * sizeof(T)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dstBytes + i * sizeof(T)), _mm_shuffle_epi8(vector, mask));
+			}
+			ScalarTail<T>(srcBytes + i * sizeof(T), dstBytes + i * sizeof(T), count - i);
+		}
+
+		template <std::unsigned_integral T>
+		EYESOL_TARGET("avx2")
+		void Avx2ByteSwap(const void* src, void* dst, std::size_t count)
+		{
+			constexpr std::size_t VECTOR_ELEMENTS = 32 / sizeof(T);
+			const unsigned char* srcBytes = static_cast<const unsigned char*>(src);
+			unsigned char* dstBytes = static_cast<unsigned char*>(dst);
+			// VPSHUFB shuffles each 128-bit lane independently, so the lane mask is duplicated
+			const __m256i mask = _mm256_broadcastsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(SHUFFLE_MASK<sizeof(T)>.data())));
+			std::size_t i = 0;
+			for (; i + VECTOR_ELEMENTS <= count; i += VECTOR_ELEMENTS)
+			{
+				__m256i vector = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcBytes + i * sizeof(T)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dstBytes + i * sizeof(T)), _mm256_shuffle_epi8(vector, mask));
+			}
+			// Less than a single AVX2 vector remains
+			Ssse3ByteSwap<T>(srcBytes + i * sizeof(T), dstBytes + i * sizeof(T), count - i);
+		}
+
+		// Sums 16-bit lanes of a vector modulo 2^16
+		EYESOL_TARGET("sse2")
+		std::uint16_t HorizontalSum(__m128i vector) noexcept
+		{
+			vector = _mm_add_epi16(vector, _mm_srli_si128(vector, 8));
+			vector = _mm_add_epi16(vector, _mm_srli_si128(vector, 4));
+			vector = _mm_add_epi16(vector, _mm_srli_si128(vector, 2));
+			return static_cast<std::uint16_t>(_mm_cvtsi128_si32(vector));
+		}
+	}
+	#pragma endregion
+
+	// Lanes wrap around independently, and the sum of lanes modulo 2^16 is the sum of words.
+	// Two accumulators hide the latency of additions
+	EYESOL_TARGET("sse2")
+	std::uint16_t Sse2WordSum(const void* data, std::size_t length) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		__m128i sum0 = _mm_setzero_si128();
+		__m128i sum1 = _mm_setzero_si128();
+		std::size_t i = 0;
+		for (; i + 32 <= length; i += 32)
+		{
+			sum0 = _mm_add_epi16(sum0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i)));
+			sum1 = _mm_add_epi16(sum1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 16)));
+		}
+		std::uint16_t sum = HorizontalSum(_mm_add_epi16(sum0, sum1));
+		return static_cast<std::uint16_t>(sum + PortableWordSum(bytes + i, length - i));
+	}
+
+	EYESOL_TARGET("avx2")
+	std::uint16_t Avx2WordSum(const void* data, std::size_t length) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		__m256i sum0 = _mm256_setzero_si256();
+		__m256i sum1 = _mm256_setzero_si256();
+		std::size_t i = 0;
+		for (; i + 64 <= length; i += 64)
+		{
+			sum0 = _mm256_add_epi16(sum0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i)));
+			sum1 = _mm256_add_epi16(sum1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i + 32)));
+		}
+		__m256i sum = _mm256_add_epi16(sum0, sum1);
+		std::uint16_t vectorSum = HorizontalSum(_mm_add_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+		// Less than 64 bytes remain
+		return static_cast<std::uint16_t>(vectorSum + Sse2WordSum(bytes + i, length - i));
+	}
+
+	// A dword is a word plus the next one multiplied by 2^16, which is 1 in ones' complement arithmetic,
+	// so dwords are summed into 64-bit lanes, and carries are folded once at the end.
+	// A lane gains less than 2^32 per vector, so it can't overflow
+	EYESOL_TARGET("sse2")
+	std::uint16_t Sse2OnesComplementSum(const void* data, std::size_t length) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		const __m128i lowDwords = _mm_set_epi32(0, -1, 0, -1);
+		__m128i sum0 = _mm_setzero_si128();
+		__m128i sum1 = _mm_setzero_si128();
+		std::size_t i = 0;
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i vector = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+			sum0 = _mm_add_epi64(sum0, _mm_and_si128(vector, lowDwords));
+			sum1 = _mm_add_epi64(sum1, _mm_srli_epi64(vector, 32));
+		}
+		std::uint64_t lanes[2];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(sum0, sum1));
+		return FoldCarries(lanes[0] + lanes[1] + PortableOnesComplementSum(bytes + i, length - i));
+	}
+
+	EYESOL_TARGET("avx2")
+	std::uint16_t Avx2OnesComplementSum(const void* data, std::size_t length) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i sum0 = _mm256_setzero_si256();
+		__m256i sum1 = _mm256_setzero_si256();
+		std::size_t i = 0;
+		for (; i + 32 <= length; i += 32)
+		{
+			__m256i vector = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+			sum0 = _mm256_add_epi64(sum0, _mm256_blend_epi32(vector, zero, 0xAA));
+			sum1 = _mm256_add_epi64(sum1, _mm256_srli_epi64(vector, 32));
+		}
+		__m256i sum = _mm256_add_epi64(sum0, sum1);
+		std::uint64_t lanes[2];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+		// Less than 32 bytes remain
+		return FoldCarries(lanes[0] + lanes[1] + Sse2OnesComplementSum(bytes + i, length - i));
+	}
+
+	// Blocks are scanned from the end, so the first match is the last dword
+	EYESOL_TARGET("sse2")
+	std::size_t Sse2FindLastDword(const void* data, std::size_t count, std::uint32_t pattern) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		const __m128i patternVector = _mm_set1_epi32(static_cast<int>(pattern));
+		std::size_t i = count;
+		for (; i >= 4; i -= 4)
+		{
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + (i - 4) * sizeof(std::uint32_t)));
+			int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, patternVector)));
+			if (mask != 0)
+			{
+				// The highest set bit is the last matching lane
+				return i - 4 + static_cast<std::size_t>(std::bit_width(static_cast<unsigned>(mask)) - 1);
+			}
+		}
+		std::size_t index = PortableFindLastDword(bytes, i, pattern);
+		return index != i ? index : count;
+	}
+
+	EYESOL_TARGET("avx2")
+	std::size_t Avx2FindLastDword(const void* data, std::size_t count, std::uint32_t pattern) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		const __m256i patternVector = _mm256_set1_epi32(static_cast<int>(pattern));
+		std::size_t i = count;
+		for (; i >= 8; i -= 8)
+		{
+			__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + (i - 8) * sizeof(std::uint32_t)));
+			int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, patternVector)));
+			if (mask != 0)
+			{
+				return i - 8 + static_cast<std::size_t>(std::bit_width(static_cast<unsigned>(mask)) - 1);
+			}
+		}
+		// Less than 8 dwords remain at the beginning
+		std::size_t index = Sse2FindLastDword(bytes, i, pattern);
+		return index != i ? index : count;
+	}
+
+	EYESOL_TARGET("sse2")
+	void Sse2XorDwords(const void* src, void* dst, std::size_t count, std::uint32_t key) noexcept
+	{
+		const unsigned char* srcBytes = static_cast<const unsigned char*>(src);
+		unsigned char* dstBytes = static_cast<unsigned char*>(dst);
+		const __m128i keyVector = _mm_set1_epi32(static_cast<int>(key));
+		std::size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcBytes + i * sizeof(std::uint32_t)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dstBytes + i * sizeof(std::uint32_t)), _mm_xor_si128(block, keyVector));
+		}
+		PortableXorDwords(srcBytes + i * sizeof(std::uint32_t), dstBytes + i * sizeof(std::uint32_t), count - i, key);
+	}
+
+	EYESOL_TARGET("avx2")
+	void Avx2XorDwords(const void* src, void* dst, std::size_t count, std::uint32_t key) noexcept
+	{
+		const unsigned char* srcBytes = static_cast<const unsigned char*>(src);
+		unsigned char* dstBytes = static_cast<unsigned char*>(dst);
+		const __m256i keyVector = _mm256_set1_epi32(static_cast<int>(key));
+		std::size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcBytes + i * sizeof(std::uint32_t)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dstBytes + i * sizeof(std::uint32_t)), _mm256_xor_si256(block, keyVector));
+		}
+		Sse2XorDwords(srcBytes + i * sizeof(std::uint32_t), dstBytes + i * sizeof(std::uint32_t), count - i, key);
+	}
+
+	const ByteSwapKernels Ssse3ByteSwapKernels
+	{
+		Ssse3ByteSwap<std::uint16_t>,
+		Ssse3ByteSwap<std::uint32_t>,
+		Ssse3ByteSwap<std::uint64_t>
+	};
+
+	const ByteSwapKernels Avx2ByteSwapKernels
+	{
+		Avx2ByteSwap<std::uint16_t>,
+		Avx2ByteSwap<std::uint32_t>,
+		Avx2ByteSwap<std::uint64_t>
+	};
+}
+#endif
@@ -0,0 +1,219 @@
+#include "Memory.hpp"
+#include "MemoryKernels.hpp"
+
+namespace Eyesol::Memory::Impl
+{
+	#pragma region Portable kernels
+	namespace
+	{
+		template <std::unsigned_integral T>
+		void PortableByteSwap(const void* src, void* dst, std::size_t count)
+		{
+			const unsigned char* srcBytes = static_cast<const unsigned char*>(src);
+			unsigned char* dstBytes = static_cast<unsigned char*>(dst);
+			for (std::size_t i = 0; i < count; i++)
+			{
+				T element;
+				std::memcpy(&element, srcBytes + i * sizeof(T), sizeof(T));
+				element = ByteSwap(element);
+				std::memcpy(dstBytes + i * sizeof(T), &element, sizeof(T));
+			}
+		}
+	}
+
+	const ByteSwapKernels PortableByteSwapKernels
+	{
+		PortableByteSwap<std::uint16_t>,
+		PortableByteSwap<std::uint32_t>,
+		PortableByteSwap<std::uint64_t>
+	};
+
+	std::uint16_t PortableWordSum(const void* data, std::size_t length) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		// Reduction modulo 2^16 may be postponed, since 2^16 divides 2^32
+		std::uint32_t sum{};
+		std::size_t i = 0;
+		for (; i + 1 < length; i += 2)
+		{
+			sum += static_cast<std::uint32_t>(bytes[i]) | static_cast<std::uint32_t>(bytes[i + 1]) << 8;
+		}
+		if (i < length)
+		{
+			sum += bytes[i];
+		}
+		return static_cast<std::uint16_t>(sum);
+	}
+
+	std::uint16_t PortableOnesComplementSum(const void* data, std::size_t length) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		// Folding may be postponed, since 2^16 is 1 in ones' complement arithmetic
+		std::uint64_t sum{};
+		std::size_t i = 0;
+		for (; i + 1 < length; i += 2)
+		{
+			sum += static_cast<std::uint32_t>(bytes[i]) | static_cast<std::uint32_t>(bytes[i + 1]) << 8;
+		}
+		if (i < length)
+		{
+			sum += bytes[i];
+		}
+		return FoldCarries(sum);
+	}
+
+	std::size_t PortableFindLastDword(const void* data, std::size_t count, std::uint32_t pattern) noexcept
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (std::size_t i = count; i-- != 0;)
+		{
+			std::uint32_t dword;
+			std::memcpy(&dword, bytes + i * sizeof(dword), sizeof(dword));
+			if (dword == pattern)
+			{
+				return i;
+			}
+		}
+		return count;
+	}
+
+	void PortableXorDwords(const void* src, void* dst, std::size_t count, std::uint32_t key) noexcept
+	{
+		const unsigned char* srcBytes = static_cast<const unsigned char*>(src);
+		unsigned char* dstBytes = static_cast<unsigned char*>(dst);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			std::uint32_t dword;
+			std::memcpy(&dword, srcBytes + i * sizeof(dword), sizeof(dword));
+			dword ^= key;
+			std::memcpy(dstBytes + i * sizeof(dword), &dword, sizeof(dword));
+		}
+	}
+	#pragma endregion
+
+	#pragma region Dispatch
+	namespace
+	{
+		// A function-local static is safe to use during static initialization of other files
+		const Cpu::DispatchTable<const ByteSwapKernels*>& ByteSwapKernelsTable()
+		{
+			static const Cpu::DispatchTable<const ByteSwapKernels*> table
+			{
+#if defined EYESOL_SIMD_X86
+				{ Cpu::Feature::Avx2, &X86::Avx2ByteSwapKernels, "avx2" },
+				{ Cpu::Feature::Ssse3, &X86::Ssse3ByteSwapKernels, "ssse3" },
+#elif defined EYESOL_SIMD_NEON
+				{ Cpu::Feature::Neon, &Arm::NeonByteSwapKernels, "neon" },
+#endif
+				{ {}, &PortableByteSwapKernels, "portable" }
+			};
+			return table;
+		}
+
+		const Cpu::DispatchTable<WordSumFunction>& WordSumTable()
+		{
+			static const Cpu::DispatchTable<WordSumFunction> table
+			{
+#if defined EYESOL_SIMD_X86
+				{ Cpu::Feature::Avx2, X86::Avx2WordSum, "avx2" },
+				{ Cpu::Feature::Sse2, X86::Sse2WordSum, "sse2" },
+#elif defined EYESOL_SIMD_NEON && !defined __AARCH64EB__
+				{ Cpu::Feature::Neon, Arm::NeonWordSum, "neon" },
+#endif
+				{ {}, PortableWordSum, "portable" }
+			};
+			return table;
+		}
+
+		const Cpu::DispatchTable<OnesComplementSumFunction>& OnesComplementSumTable()
+		{
+			static const Cpu::DispatchTable<OnesComplementSumFunction> table
+			{
+#if defined EYESOL_SIMD_X86
+				{ Cpu::Feature::Avx2, X86::Avx2OnesComplementSum, "avx2" },
+				{ Cpu::Feature::Sse2, X86::Sse2OnesComplementSum, "sse2" },
+#elif defined EYESOL_SIMD_NEON && !defined __AARCH64EB__
+				{ Cpu::Feature::Neon, Arm::NeonOnesComplementSum, "neon" },
+#endif
+				{ {}, PortableOnesComplementSum, "portable" }
+			};
+			return table;
+		}
+
+		const Cpu::DispatchTable<FindLastDwordFunction>& FindLastDwordTable()
+		{
+			static const Cpu::DispatchTable<FindLastDwordFunction> table
+			{
+#if defined EYESOL_SIMD_X86
+				{ Cpu::Feature::Avx2, X86::Avx2FindLastDword, "avx2" },
+				{ Cpu::Feature::Sse2, X86::Sse2FindLastDword, "sse2" },
+#elif defined EYESOL_SIMD_NEON
+				{ Cpu::Feature::Neon, Arm::NeonFindLastDword, "neon" },
+#endif
+				{ {}, PortableFindLastDword, "portable" }
+			};
+			return table;
+		}
+
+		const Cpu::DispatchTable<XorDwordsFunction>& XorDwordsTable()
+		{
+			static const Cpu::DispatchTable<XorDwordsFunction> table
+			{
+#if defined EYESOL_SIMD_X86
+				{ Cpu::Feature::Avx2, X86::Avx2XorDwords, "avx2" },
+				{ Cpu::Feature::Sse2, X86::Sse2XorDwords, "sse2" },
+#elif defined EYESOL_SIMD_NEON
+				{ Cpu::Feature::Neon, Arm::NeonXorDwords, "neon" },
+#endif
+				{ {}, PortableXorDwords, "portable" }
+			};
+			return table;
+		}
+	}
+
+	void ByteSwapArray(const void* src, void* dst, std::size_t count, std::size_t elementSize)
+	{
+		const ByteSwapKernels& kernels = **ByteSwapKernelsTable();
+		switch (elementSize)
+		{
+		case 1:
+			if (src != dst)
+			{
+				std::memmove(dst, src, count);
+			}
+			break;
+		case 2:
+			kernels.swap16(src, dst, count);
+			break;
+		case 4:
+			kernels.swap32(src, dst, count);
+			break;
+		case 8:
+			kernels.swap64(src, dst, count);
+			break;
+		default:
+			throw std::invalid_argument{ "Unsupported element size: " + std::to_string(elementSize) };
+		}
+	}
+
+	std::uint16_t LittleEndianWordSum(const void* data, std::size_t length) noexcept
+	{
+		return (*WordSumTable())(data, length);
+	}
+
+	std::uint16_t LittleEndianOnesComplementSum(const void* data, std::size_t length) noexcept
+	{
+		return (*OnesComplementSumTable())(data, length);
+	}
+
+	std::size_t FindLastDword(const void* data, std::size_t count, std::uint32_t pattern) noexcept
+	{
+		return (*FindLastDwordTable())(data, count, pattern);
+	}
+
+	void XorDwords(const void* src, void* dst, std::size_t count, std::uint32_t key) noexcept
+	{
+		(*XorDwordsTable())(src, dst, count, key);
+	}
+	#pragma endregion
+}
@@ -0,0 +1,318 @@
+// POSIX-specific MemoryMappedIO implementation
+#if defined __unix__ || defined __APPLE__
+#	include <cerrno>
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include "MemoryMappedIO.hpp"
+#	include "Runtime.hpp"
+#	include "Strings.hpp"
+#	include "Posix.hpp"
+#	include "ViewCache.hpp"
+
+using namespace Eyesol::Posix;
+
+namespace Eyesol::MemoryMappedIO
+{
+	#pragma region nameless namespace (POSIX-specific functionality)
+	namespace
+	{
+		// Returns a maximum view length allowed at the offset
+		std::uint64_t CheckViewBounds(std::uint64_t offset, std::size_t length, std::uint64_t totalFileLength)
+		{
+			// Maximum offset is totalFileLength - 1,
+			// which produces maximum a one byte region
+			if (offset >= totalFileLength)
+			{
+				throw std::out_of_range{ std::string("File offset is too long: " + std::to_string(offset) + ". Maximum ")
+					+ std::to_string(totalFileLength - 1) + " is allowed" };
+			}
+			std::uint64_t maximumLength = totalFileLength - offset;
+			if (maximumLength > std::numeric_limits<std::size_t>::max())
+			{
+				maximumLength = std::numeric_limits<std::size_t>::max();
+			}
+			if (length > maximumLength)
+			{
+				throw std::out_of_range{ "Map view length requested is too long: " + std::to_string(length) + ". Maximum "
+					+ std::to_string(maximumLength) + " is allowed with requested offset " + std::to_string(offset) };
+			}
+			return maximumLength;
+		}
+
+		// Maps a read-only view of the file. The view is unmapped
+		// when the last reference to it is released
+		Impl::MappedView CreateMapView(int fd, std::uint64_t offset, std::size_t length, std::uint64_t totalFileLength)
+		{
+			auto allocGranularity = Eyesol::Runtime::AllocationGranularity();
+			if (offset % allocGranularity != 0)
+			{
+				throw std::out_of_range{ "Invalid offset granularity. " + std::to_string(allocGranularity) + " is required" };
+			}
+			std::uint64_t maximumLength = CheckViewBounds(offset, length, totalFileLength);
+			if (offset > static_cast<std::uint64_t>(std::numeric_limits<off_t>::max()))
+			{
+				throw std::out_of_range{ "File offset is not representable by off_t: " + std::to_string(offset) };
+			}
+			// Like MapViewOfFile, a zero length maps the view up to the end of the file
+			std::size_t mappedLength = length != 0 ? length : static_cast<std::size_t>(maximumLength);
+			void* baseAddress =
+				::mmap(
+					nullptr, // address hint
+					mappedLength,
+					PROT_READ,
+					MAP_PRIVATE,
+					fd,
+					static_cast<off_t>(offset)
+				);
+			if (baseAddress == MAP_FAILED)
+			{
+				throw std::runtime_error{ FormatPosixErrorMessage(errno, "creating a file map view") };
+			}
+			auto unmap = [mappedLength](const unsigned char* view)
+				{
+					::munmap(const_cast<unsigned char*>(view), mappedLength);
+				};
+			// shared_ptr calls the deleter itself if its control block cannot be allocated
+			return Impl::MappedView{ reinterpret_cast<const unsigned char*>(baseAddress), unmap };
+		}
+	}
+	#pragma endregion
+
+	#pragma region POSIX-specific Impl::MemoryMappedFileImpl
+	class Impl::MemoryMappedFileImpl
+	{
+	public:
+		int _fd;
+		std::uint64_t _fileLength;
+		std::string _path;
+		// A view of the whole file. nullptr in the windowed mode
+		Impl::MappedView _wholeFileView;
+		// Views mapped in the windowed mode
+		mutable Impl::ViewCache _viewCache;
+
+		MemoryMappedFileImpl(std::string path, int fd, std::uint64_t fileLength)
+			: _fd{ fd },
+			_fileLength{ fileLength },
+			_path{ std::move(path) }
+		{
+		}
+
+		~MemoryMappedFileImpl()
+		{
+			// Views must be unmapped before the file is closed
+			_wholeFileView = nullptr;
+			_viewCache.SetCapacity(0);
+			::close(_fd);
+			_fd = FileDescriptor::INVALID_DESCRIPTOR;
+		}
+	};
+	#pragma endregion
+
+	#pragma region POSIX-specific Impl::MemoryMappedFileRegionImpl
+	class Impl::MemoryMappedFileRegionImpl
+	{
+	public:
+		// Holds file descriptor opened
+		std::shared_ptr<Impl::MemoryMappedFileImpl> _impl;
+		// Points to the region start. May share a bigger view
+		Impl::MappedView _view;
+		// An offset of the view in the file
+		std::uint64_t _offset;
+		// A length of the view
+		std::uint64_t _length;
+
+		MemoryMappedFileRegionImpl(const std::shared_ptr<Impl::MemoryMappedFileImpl>& fileHandle, Impl::MappedView view, std::uint64_t offset, std::uint64_t length) noexcept
+			: _impl{ fileHandle },
+			_view{ std::move(view) },
+			_offset{ offset },
+			_length{ length }
+		{
+		}
+
+		const unsigned char* begin() const { return _view.get(); }
+		const unsigned char* end() const { return _view.get() + _length; }
+	};
+	#pragma endregion
+
+	#pragma region POSIX-specific Impl namespace implementation
+	namespace Impl
+	{
+		std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::wstring path, std::uint64_t& fileLength, MappingMode mode)
+		{
+			return OpenFile(wstring_to_utf8string(path), fileLength, mode);
+		}
+
+		std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::u16string path, std::uint64_t& fileLength, MappingMode mode)
+		{
+			return OpenFile(u16string_to_wstring(path), fileLength, mode);
+		}
+
+		std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::string path, std::uint64_t& fileLength, MappingMode mode)
+		{
+			FileDescriptor openedFile;
+			{
+				int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+				if (fd == FileDescriptor::INVALID_DESCRIPTOR)
+				{
+					throw std::runtime_error{ FormatPosixErrorMessage(errno, "opening a file") };
+				}
+				openedFile = fd;
+			}
+
+			std::uint64_t fileSize;
+			{
+				struct stat fileStat{};
+				if (::fstat(openedFile.getDescriptor(), &fileStat) != 0)
+				{
+					throw std::runtime_error{ FormatPosixErrorMessage(errno, "determining a file size") };
+				}
+				if (!S_ISREG(fileStat.st_mode))
+				{
+					throw std::runtime_error{ "File is not a regular file" };
+				}
+				if (fileStat.st_size < 0)
+				{
+					throw std::runtime_error{ "File size is less than zero" };
+				}
+				fileSize = static_cast<std::uint64_t>(fileStat.st_size);
+			}
+			fileLength = fileSize;
+			// Construct a handle to return (don't release the descriptor yet,
+			// in case of make_shared throwing an exception)
+			auto ptr = std::make_shared<MemoryMappedFileImpl>(
+				std::move(path),
+				openedFile.getDescriptor(),
+				fileSize);
+			// Prevent the descriptor from being untimely closed by the temporary holder
+			openedFile.release();
+			if (fileSize != 0 && ResolveMappingMode(mode, fileSize) == MappingMode::WholeFile)
+			{
+				try
+				{
+					if (fileSize > std::numeric_limits<std::size_t>::max())
+					{
+						throw std::out_of_range{ "File is too long to be mapped as a single view" };
+					}
+					ptr->_wholeFileView = CreateMapView(ptr->_fd, 0, static_cast<std::size_t>(fileSize), fileSize);
+				}
+				catch (const std::exception&)
+				{
+					// The automatic policy falls back to the windowed mode,
+					// e.g. when the address space is exhausted
+					if (mode != MappingMode::Auto)
+					{
+						throw;
+					}
+				}
+			}
+			return ptr;
+		}
+
+		std::uint64_t GetFileLength(const MemoryMappedFileImpl& file)
+		{
+			return file._fileLength;
+		}
+
+		std::string GetFilePath(const MemoryMappedFileImpl& file)
+		{
+			return file._path;
+		}
+
+		const unsigned char* GetWholeFileView(const MemoryMappedFileImpl& file)
+		{
+			return file._wholeFileView.get();
+		}
+
+		ViewCache& GetViewCache(const MemoryMappedFileImpl& file)
+		{
+			return file._viewCache;
+		}
+
+		const std::shared_ptr<MemoryMappedFileImpl>& get_impl(const MemoryMappedFileRegionImpl& regionHandle)
+		{
+			return regionHandle._impl;
+		}
+
+		void GetRegionOffsetAndLength(const MemoryMappedFileRegionImpl& region, std::uint64_t& offset, std::uint64_t& length)
+		{
+			offset = region._offset;
+			length = region._length;
+		}
+
+		std::shared_ptr<MemoryMappedFileRegionImpl> MapRegion(const std::shared_ptr<Impl::MemoryMappedFileImpl>& fileHandle, std::uint64_t offset, std::uint64_t length)
+		{
+			if (length > std::numeric_limits<std::size_t>::max())
+			{
+				throw std::out_of_range{ "Map view length is not representable by size_t: " + std::to_string(length) };
+			}
+			const Impl::MappedView& wholeFileView = fileHandle->_wholeFileView;
+			if (wholeFileView != nullptr)
+			{
+				// No new view is needed, just point into the existing one
+				CheckViewBounds(offset, static_cast<std::size_t>(length), fileHandle->_fileLength);
+				return std::make_shared<MemoryMappedFileRegionImpl>(fileHandle, Impl::MappedView{ wholeFileView, wholeFileView.get() + offset }, offset, length);
+			}
+			auto& viewCache = fileHandle->_viewCache;
+			Impl::MappedView view = viewCache.Find(offset, static_cast<std::size_t>(length));
+			if (view == nullptr)
+			{
+				view = viewCache.Insert(
+					offset,
+					static_cast<std::size_t>(length),
+					CreateMapView(fileHandle->_fd, offset, static_cast<std::size_t>(length), fileHandle->_fileLength));
+			}
+			return std::make_shared<MemoryMappedFileRegionImpl>(fileHandle, std::move(view), offset, length);
+		}
+
+		const unsigned char* RegionBegin(const Impl::MemoryMappedFileRegionImpl& region)
+		{
+			return region.begin();
+		}
+
+		const unsigned char* RegionEnd(const MemoryMappedFileRegionImpl& region)
+		{
+			return region.end();
+		}
+
+		PrivatePages AllocatePrivatePages(std::size_t length)
+		{
+			// Pages are not reserved in the swap, as most of them are usually replaced by file views or never touched
+			void* baseAddress = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (baseAddress == MAP_FAILED)
+			{
+				return nullptr;
+			}
+			// File views mapped into the pages are unmapped together with them
+			auto unmap = [length](unsigned char* pages)
+				{
+					::munmap(pages, length);
+				};
+			return PrivatePages{ static_cast<unsigned char*>(baseAddress), unmap };
+		}
+
+		Result<bool> MapFilePagesAt(const MemoryMappedFileImpl& file, const PrivatePages& pages, std::size_t pagesOffset, std::uint64_t offset, std::size_t length)
+		{
+			unsigned char* address = pages.get() + pagesOffset;
+			if (offset > static_cast<std::uint64_t>(std::numeric_limits<off_t>::max()))
+			{
+				return false;
+			}
+			void* mapped = ::mmap(address, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, file._fd, static_cast<off_t>(offset));
+			if (mapped != MAP_FAILED)
+			{
+				return true;
+			}
+			// A failed MAP_FIXED may have unmapped the old pages, so zero-filled ones are restored for the caller to copy into
+			void* restored = ::mmap(address, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+			if (restored == MAP_FAILED)
+			{
+				// The range is a hole in the memory now, nothing may be copied into it
+				return Unexpected{ ErrorCode::OutOfMemory };
+			}
+			return false;
+		}
+	}
+	#pragma endregion
+}
+#endif
@@ -1,11 +1,26 @@
 // Windows-specific MemoryMappedIO implementation
 #if defined _WIN32
+#	include <iterator>
+#	include <map>
+#	include <mutex>
 #	include "MemoryMappedIO.hpp"
 #	include "Runtime.hpp"
 #	include "Windows.hpp"
+#	include "ViewCache.hpp"
 
 using namespace Eyesol::Windows;
 
+// Placeholder flags of Windows 10 1803+, missing in older SDKs
+#	if !defined MEM_RESERVE_PLACEHOLDER
+#		define MEM_RESERVE_PLACEHOLDER 0x00040000
+#	endif
+#	if !defined MEM_REPLACE_PLACEHOLDER
+#		define MEM_REPLACE_PLACEHOLDER 0x00004000
+#	endif
+#	if !defined MEM_PRESERVE_PLACEHOLDER
+#		define MEM_PRESERVE_PLACEHOLDER 0x00000002
+#	endif
+
 namespace Eyesol::MemoryMappedIO
 {
 	#pragma region nameless namespace (Windows-specific functionality)
@@ -14,13 +29,8 @@ namespace Eyesol::MemoryMappedIO
 		// Windows limits
 		constexpr std::uint16_t MAX_LONG_PATH_LENGTH = 32767;
 
-		void* CreateMapViewOfFile(HANDLE fileMapping, std::uint64_t offset, std::size_t length, std::uint64_t totalFileLength)
+		void CheckViewBounds(std::uint64_t offset, std::size_t length, std::uint64_t totalFileLength)
 		{
-			auto allocGranularity = Eyesol::Runtime::AllocationGranularity();
-			if (offset % allocGranularity != 0)
-			{
-				throw std::out_of_range{ "Invalid offset granularity. " + std::to_string(allocGranularity) + " is required" };
-			}
 			// Maximum offset is totalFileLength - 1,
 			// which produces maximum a one byte region
 			if (offset >= totalFileLength)
@@ -38,6 +48,18 @@ namespace Eyesol::MemoryMappedIO
 				throw std::out_of_range{ "Map view length requested is too long: " + std::to_string(length) + ". Maximum "
 					+ std::to_string(maximumLength) + " is allowed with requested offset " + std::to_string(offset) };
 			}
+		}
+
+		// Maps a read-only view of the file. The view is unmapped
+		// when the last reference to it is released
+		Impl::MappedView CreateMapViewOfFile(HANDLE fileMapping, std::uint64_t offset, std::size_t length, std::uint64_t totalFileLength)
+		{
+			auto allocGranularity = Eyesol::Runtime::AllocationGranularity();
+			if (offset % allocGranularity != 0)
+			{
+				throw std::out_of_range{ "Invalid offset granularity. " + std::to_string(allocGranularity) + " is required" };
+			}
+			CheckViewBounds(offset, length, totalFileLength);
 			ULARGE_INTEGER unsignedOffset{ .QuadPart = static_cast<std::uint64_t>(offset) };
 			void* baseAddress =
 				::MapViewOfFile(
@@ -51,8 +73,188 @@ namespace Eyesol::MemoryMappedIO
 			{
 				throw std::runtime_error{ FormatWindowsErrorMessage(::GetLastError(), "creating a file map view") };
 			}
-			return baseAddress;
+			auto unmap = [](const unsigned char* view)
+				{
+					::UnmapViewOfFile(view);
+				};
+			// shared_ptr calls the deleter itself if its control block cannot be allocated
+			return Impl::MappedView{ reinterpret_cast<const unsigned char*>(baseAddress), unmap };
 		}
+
+		// Only views mapped by VirtualAlloc2 and MapViewOfFile3 may replace placeholders.
+		// They are resolved at runtime, as the library doesn't require Windows 10 1803
+		using VirtualAlloc2Function = PVOID(WINAPI*)(HANDLE process, PVOID baseAddress, SIZE_T size, ULONG allocationType,
+			ULONG pageProtection, void* extendedParameters, ULONG parameterCount);
+		using MapViewOfFile3Function = PVOID(WINAPI*)(HANDLE fileMapping, HANDLE process, PVOID baseAddress, ULONG64 offset,
+			SIZE_T viewSize, ULONG allocationType, ULONG pageProtection, void* extendedParameters, ULONG parameterCount);
+
+		struct PlaceholderApi
+		{
+			VirtualAlloc2Function VirtualAlloc2;
+			MapViewOfFile3Function MapViewOfFile3;
+		};
+
+		// Both functions are null if any of them is missing
+		const PlaceholderApi& GetPlaceholderApi()
+		{
+			static const PlaceholderApi api = []()
+				{
+					PlaceholderApi result{};
+					HMODULE kernelBase = ::GetModuleHandleW(L"kernelbase.dll");
+					if (kernelBase != nullptr)
+					{
+						result.VirtualAlloc2 = reinterpret_cast<VirtualAlloc2Function>(::GetProcAddress(kernelBase, "VirtualAlloc2"));
+						result.MapViewOfFile3 = reinterpret_cast<MapViewOfFile3Function>(::GetProcAddress(kernelBase, "MapViewOfFile3"));
+					}
+					if (result.VirtualAlloc2 == nullptr || result.MapViewOfFile3 == nullptr)
+					{
+						result = {};
+					}
+					return result;
+				}();
+			return api;
+		}
+
+		// Private pages reserved as a placeholder. File views are mapped by splitting the placeholder,
+		// so the pages consist of parts, each one being a private allocation, a view or a placeholder
+		class PlaceholderPages
+		{
+		public:
+			enum class PartType
+			{
+				Placeholder,
+				Private,
+				View
+			};
+
+			struct Part
+			{
+				std::size_t Length;
+				PartType Type;
+			};
+
+			PlaceholderPages(unsigned char* base, std::size_t length)
+				: _base{ base },
+				_parts{ { 0, Part{ length, PartType::Placeholder } } }
+			{
+			}
+
+			PlaceholderPages(const PlaceholderPages&) = delete;
+			PlaceholderPages& operator=(const PlaceholderPages&) = delete;
+
+			~PlaceholderPages()
+			{
+				Release();
+			}
+
+			// Replaces a placeholder part with committed zero-filled pages
+			bool Commit(std::size_t offset)
+			{
+				Part& part = _parts.at(offset);
+				void* address = GetPlaceholderApi().VirtualAlloc2(::GetCurrentProcess(), _base + offset, part.Length,
+					MEM_RESERVE | MEM_COMMIT | MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+				if (address == nullptr)
+				{
+					return false;
+				}
+				part.Type = PartType::Private;
+				return true;
+			}
+
+			Result<bool> MapFile(HANDLE fileMapping, std::size_t offset, std::uint64_t fileOffset, std::size_t length)
+			{
+				std::lock_guard lock{ _mutex };
+				// The first part starts at zero, so every offset is within a part
+				auto found = std::prev(_parts.upper_bound(offset));
+				std::size_t partOffset = found->first;
+				Part part = found->second;
+				if (part.Type != PartType::Private || offset + length > partOffset + part.Length)
+				{
+					return false;
+				}
+				// A private allocation may only return to a placeholder as a whole, losing its content
+				if (!::VirtualFree(_base + partOffset, part.Length, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER))
+				{
+					return false;
+				}
+				found->second.Type = PartType::Placeholder;
+				// The placeholder is split around the range
+				bool split = true;
+				std::size_t prefix = offset - partOffset;
+				if (prefix != 0)
+				{
+					split = ::VirtualFree(_base + partOffset, prefix, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER) != FALSE;
+					if (split)
+					{
+						found->second.Length = prefix;
+						_parts.emplace(offset, Part{ part.Length - prefix, PartType::Placeholder });
+					}
+				}
+				std::size_t suffix = partOffset + part.Length - (offset + length);
+				if (split && suffix != 0)
+				{
+					split = ::VirtualFree(_base + offset, length, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER) != FALSE;
+					if (split)
+					{
+						_parts.at(offset).Length = length;
+						_parts.emplace(offset + length, Part{ suffix, PartType::Placeholder });
+					}
+				}
+				bool mapped = false;
+				if (split)
+				{
+					void* view = GetPlaceholderApi().MapViewOfFile3(fileMapping, ::GetCurrentProcess(), _base + offset, fileOffset, length,
+						MEM_REPLACE_PLACEHOLDER, PAGE_WRITECOPY, nullptr, 0);
+					if (view != nullptr)
+					{
+						_parts.at(offset).Type = PartType::View;
+						mapped = true;
+					}
+				}
+				// Placeholders left around the view, or instead of it, become private pages again
+				for (auto it = _parts.find(partOffset); it != _parts.end() && it->first < partOffset + part.Length; ++it)
+				{
+					if (it->second.Type == PartType::Placeholder && !Commit(it->first))
+					{
+						return Unexpected{ ErrorCode::OutOfMemory };
+					}
+				}
+				return mapped;
+			}
+
+			void Release() noexcept
+			{
+				for (const auto& [offset, part] : _parts)
+				{
+					if (part.Type == PartType::View)
+					{
+						::UnmapViewOfFile(_base + offset);
+					}
+					else
+					{
+						::VirtualFree(_base + offset, 0, MEM_RELEASE);
+					}
+				}
+				_parts.clear();
+			}
+
+		private:
+			std::mutex _mutex;
+			unsigned char* _base;
+			// Parts by their offsets
+			std::map<std::size_t, Part> _parts;
+		};
+
+		// The deleter of private pages reserved as a placeholder, which also keeps their layout
+		struct PlaceholderPagesRelease
+		{
+			std::shared_ptr<PlaceholderPages> Pages;
+
+			void operator()(unsigned char*) const noexcept
+			{
+				Pages->Release();
+			}
+		};
 	}
 	#pragma endregion
 
@@ -64,9 +266,13 @@ namespace Eyesol::MemoryMappedIO
 		HANDLE _fileMappingObjectHandle;
 		std::uint64_t _fileLength;
 		std::wstring _path;
+		// A view of the whole file. nullptr in the windowed mode
+		Impl::MappedView _wholeFileView;
+		// Views mapped in the windowed mode
+		mutable Impl::ViewCache _viewCache;
 
 		// TODO: create a custom iterator
-		MemoryMappedFileImpl(std::wstring path, HANDLE fileHandle, HANDLE fileMappingObjectHandle, std::uint64_t fileLength) noexcept
+		MemoryMappedFileImpl(std::wstring path, HANDLE fileHandle, HANDLE fileMappingObjectHandle, std::uint64_t fileLength)
 			: _fileHandle{ fileHandle },
 			_fileMappingObjectHandle{ fileMappingObjectHandle },
 			_fileLength{ fileLength },
@@ -76,6 +282,9 @@ namespace Eyesol::MemoryMappedIO
 
 		~MemoryMappedFileImpl()
 		{
+			// Views must be unmapped before the handles are closed
+			_wholeFileView = nullptr;
+			_viewCache.SetCapacity(0);
 			BOOL ok = ::CloseHandle(_fileMappingObjectHandle);
 			ok = ::CloseHandle(_fileHandle);
 			_fileMappingObjectHandle = INVALID_HANDLE_VALUE;
@@ -90,44 +299,40 @@ namespace Eyesol::MemoryMappedIO
 	public:
 		// Holds file handles opened
 		std::shared_ptr<Impl::MemoryMappedFileImpl> _impl;
-		unsigned char* _mapViewBaseAddress;
+		// Points to the region start. May share a bigger view
+		Impl::MappedView _view;
 		// An offset of the view in the file
 		std::uint64_t _offset;
 		// A length of the view
 		std::uint64_t _length;
 
-		MemoryMappedFileRegionImpl(const std::shared_ptr<Impl::MemoryMappedFileImpl>& fileHandle, void* regionStart, std::uint64_t offset, std::uint64_t length)
+		MemoryMappedFileRegionImpl(const std::shared_ptr<Impl::MemoryMappedFileImpl>& fileHandle, Impl::MappedView view, std::uint64_t offset, std::uint64_t length) noexcept
 			: _impl{ fileHandle },
-			_mapViewBaseAddress{ reinterpret_cast<unsigned char*>(regionStart) },
+			_view{ std::move(view) },
 			_offset{ offset },
 			_length{ length }
 		{
 		}
 
-		~MemoryMappedFileRegionImpl()
-		{
-			::UnmapViewOfFile(_mapViewBaseAddress);
-		}
-
-		const unsigned char* begin() const { return _mapViewBaseAddress; }
-		const unsigned char* end() const { return _mapViewBaseAddress + _length; }
+		const unsigned char* begin() const { return _view.get(); }
+		const unsigned char* end() const { return _view.get() + _length; }
 	};
 	#pragma endregion
 
 	#pragma region Windows-specific Impl namespace implementation
 	namespace Impl
 	{
-		std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::string path, std::uint64_t& fileLength)
+		std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::string path, std::uint64_t& fileLength, MappingMode mode)
 		{
-			return OpenFile(utf8string_to_wstring(path), fileLength);
+			return OpenFile(utf8string_to_wstring(path), fileLength, mode);
 		}
 
-		std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::u16string path, std::uint64_t& fileLength)
+		std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::u16string path, std::uint64_t& fileLength, MappingMode mode)
 		{
-			return OpenFile(u16string_to_wstring(path), fileLength);
+			return OpenFile(u16string_to_wstring(path), fileLength, mode);
 		}
 
-		std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::wstring path, std::uint64_t& fileLength)
+		std::shared_ptr<MemoryMappedFileImpl> OpenFile(::std::wstring path, std::uint64_t& fileLength, MappingMode mode)
 		{
 			if (path.length() > MAX_LONG_PATH_LENGTH)
 			{
@@ -201,6 +406,35 @@ namespace Eyesol::MemoryMappedIO
 			// Prevent handles from being untimely closed by the temporary handle holders
 			openedFile.release();
 			fileMappingObject.release();
+			if (fileSize != 0 && ResolveMappingMode(mode, fileSize) == MappingMode::WholeFile)
+			{
+				if (fileSize > std::numeric_limits<std::size_t>::max())
+				{
+					if (mode != MappingMode::Auto)
+					{
+						throw std::out_of_range{ "File is too long to be mapped as a single view" };
+					}
+				}
+				else
+				{
+					// A zero length maps the view up to the end of the file
+					void* view = ::MapViewOfFile(ptr->_fileMappingObjectHandle, FILE_MAP_READ, 0, 0, 0);
+					if (view != nullptr)
+					{
+						auto unmap = [](const unsigned char* view)
+							{
+								::UnmapViewOfFile(view);
+							};
+						ptr->_wholeFileView = Impl::MappedView{ reinterpret_cast<const unsigned char*>(view), unmap };
+					}
+					// The automatic policy falls back to the windowed mode,
+					// e.g. when the address space is exhausted
+					else if (mode != MappingMode::Auto)
+					{
+						throw std::runtime_error{ FormatWindowsErrorMessage(::GetLastError(), "creating a whole file map view") };
+					}
+				}
+			}
 			return std::move(ptr);
 		}
 
@@ -214,6 +448,16 @@ namespace Eyesol::MemoryMappedIO
 			return wstring_to_utf8string(file._path);
 		}
 
+		const unsigned char* GetWholeFileView(const MemoryMappedFileImpl& file)
+		{
+			return file._wholeFileView.get();
+		}
+
+		ViewCache& GetViewCache(const MemoryMappedFileImpl& file)
+		{
+			return file._viewCache;
+		}
+
 		const std::shared_ptr<MemoryMappedFileImpl>& get_impl(const MemoryMappedFileRegionImpl& regionHandle)
 		{
 			return regionHandle._impl;
@@ -227,12 +471,27 @@ namespace Eyesol::MemoryMappedIO
 
 		std::shared_ptr<MemoryMappedFileRegionImpl> MapRegion(const std::shared_ptr<Impl::MemoryMappedFileImpl>& fileHandle, std::uint64_t offset, std::uint64_t length)
 		{
-			void* regionStart = reinterpret_cast<unsigned char*>(CreateMapViewOfFile(
-				fileHandle->_fileMappingObjectHandle,
-				offset,
-				length,
-				fileHandle->_fileLength));
-			return std::make_shared<MemoryMappedFileRegionImpl>(fileHandle, regionStart, offset, length);
+			const Impl::MappedView& wholeFileView = fileHandle->_wholeFileView;
+			if (wholeFileView != nullptr)
+			{
+				// No new view is needed, just point into the existing one
+				CheckViewBounds(offset, length, fileHandle->_fileLength);
+				return std::make_shared<MemoryMappedFileRegionImpl>(fileHandle, Impl::MappedView{ wholeFileView, wholeFileView.get() + offset }, offset, length);
+			}
+			auto& viewCache = fileHandle->_viewCache;
+			Impl::MappedView view = viewCache.Find(offset, static_cast<std::size_t>(length));
+			if (view == nullptr)
+			{
+				view = viewCache.Insert(
+					offset,
+					static_cast<std::size_t>(length),
+					CreateMapViewOfFile(
+						fileHandle->_fileMappingObjectHandle,
+						offset,
+						length,
+						fileHandle->_fileLength));
+			}
+			return std::make_shared<MemoryMappedFileRegionImpl>(fileHandle, std::move(view), offset, length);
 		}
 
 		const unsigned char* RegionBegin(const Impl::MemoryMappedFileRegionImpl& region)
@@ -244,6 +503,49 @@ namespace Eyesol::MemoryMappedIO
 		{
 			return region.end();
 		}
+
+		PrivatePages AllocatePrivatePages(std::size_t length)
+		{
+			const PlaceholderApi& api = GetPlaceholderApi();
+			if (api.VirtualAlloc2 != nullptr)
+			{
+				void* placeholder = api.VirtualAlloc2(::GetCurrentProcess(), nullptr, length,
+					MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS, nullptr, 0);
+				if (placeholder == nullptr)
+				{
+					return nullptr;
+				}
+				unsigned char* base = static_cast<unsigned char*>(placeholder);
+				auto pages = std::make_shared<PlaceholderPages>(base, length);
+				if (!pages->Commit(0))
+				{
+					return nullptr;
+				}
+				return PrivatePages{ base, PlaceholderPagesRelease{ std::move(pages) } };
+			}
+			// Committed pages are zero-filled on first access, untouched ones take no physical memory
+			void* baseAddress = ::VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			if (baseAddress == nullptr)
+			{
+				return nullptr;
+			}
+			auto release = [](unsigned char* pages)
+				{
+					::VirtualFree(pages, 0, MEM_RELEASE);
+				};
+			return PrivatePages{ static_cast<unsigned char*>(baseAddress), release };
+		}
+
+		Result<bool> MapFilePagesAt(const MemoryMappedFileImpl& file, const PrivatePages& pages, std::size_t pagesOffset, std::uint64_t offset, std::size_t length)
+		{
+			// A view may only replace a placeholder, otherwise the data is copied
+			const PlaceholderPagesRelease* release = std::get_deleter<PlaceholderPagesRelease>(pages);
+			if (release == nullptr)
+			{
+				return false;
+			}
+			return release->Pages->MapFile(file._fileMappingObjectHandle, pagesOffset, offset, length);
+		}
 	}
 	#pragma endregion
 }
@@ -1,35 +1,69 @@
 ﻿#include "MzParser.hpp"
 #include "Exceptions.hpp"
-#include <stack>
 
 namespace Eyesol::Executables::Mz
 {
 	MzParseContext::~MzParseContext() { }
 
 	//////// MZ Parser
-	bool MzParser::TryParseTypeAndFormatPrivate(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, MzParseContext* ctx) const
+	Result<void> MzParser::TryParseTypeAndFormatPrivate(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, MzParseContext* ctx) const
 	{
 		MzDosHeader headerLoc;
 		MzDosHeader& header = ctx ? ctx->header : headerLoc;
-		ReadDosHeader(file, header);
+		Result<void> status = TryReadDosHeader(file, probeBytes, header);
+		if (!status)
+		{
+			return status;
+		}
 		if (header.e_magic != DOS_HEADER_MAGIC)
 		{
-			return false;
+			return Unexpected{ ErrorCode::UnknownFormat };
 		}
 		if (ctx != nullptr)
 		{
 			ctx->mzHeaderRead = true;
 		}
-		if (TryParseTypeAndFormat(file, header, ctx))
-		{
-			return true;
-		}
-		return false;
+		return TryParseTypeAndFormat(file, probeBytes, header, ctx);
 	}
 
 	bool MzParser::IsTypeSupported(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, ExecutableObjectFormat* format, ExecutableType* type) const
 	{
-		return TryParseTypeAndFormatPrivate(file, nullptr);
+		ExecutableProbe probe{ file };
+		return ProbeType(file, probe, nullptr, format, type).has_value();
+	}
+
+	std::vector<ExecutableMagic> MzParser::SupportedMagics() const
+	{
+		return { ExecutableMagic::Mz };
+	}
+
+	Result<void> MzParser::ProbeType(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext>* ctx, ExecutableObjectFormat* format, ExecutableType* type) const
+	{
+		if (probe.magic() != ExecutableMagic::Mz)
+		{
+			return Unexpected{ ErrorCode::UnknownFormat };
+		}
+		// The format and the type are detected into the context. If ctx is not null,
+		// the header read here is reused by TryParseProbed
+		std::unique_ptr<MzParseContext> mzCtx = CreateParseContext();
+		Result<void> status = TryParseTypeAndFormatPrivate(file, probe.bytes(), mzCtx.get());
+		if (!status)
+		{
+			return status;
+		}
+		if (format != nullptr)
+		{
+			*format = mzCtx->format.value_or(ExecutableObjectFormat::Mz);
+		}
+		if (type != nullptr)
+		{
+			*type = mzCtx->type.value_or(ExecutableType::Executable);
+		}
+		if (ctx != nullptr)
+		{
+			*ctx = std::move(mzCtx);
+		}
+		return status;
 	}
 
 	std::unique_ptr<MzParseContext> MzParser::CreateParseContext() const
@@ -39,15 +73,9 @@ namespace Eyesol::Executables::Mz
 
 	std::shared_ptr<Executable> MzParser::TryParse(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::exception_ptr* excPtr) const
 	{
-		std::unique_ptr<MzParseContext> ctx = CreateParseContext();
-		if (!TryParseTypeAndFormatPrivate(file, ctx.get()))
-		{
-			return nullptr;
-		}
 		try
 		{
-			ReadDosMetadata(file, *ctx);
-			return ParseExecutable(file, *ctx);
+			return FromResult(TryParseNoThrow(file), excPtr);
 		}
 		catch (...)
 		{
@@ -59,8 +87,38 @@ namespace Eyesol::Executables::Mz
 		}
 	}
 
+	Result<std::shared_ptr<Executable>> MzParser::TryParseProbed(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, const ExecutableProbe& probe, std::unique_ptr<ExecutableParseContext> ctx) const
+	{
+		std::unique_ptr<MzParseContext> mzCtx{ dynamic_cast<MzParseContext*>(ctx.get()) };
+		if (mzCtx != nullptr)
+		{
+			// Continue with the context returned by ProbeType
+			ctx.release();
+		}
+		else
+		{
+			mzCtx = CreateParseContext();
+			Result<void> status = TryParseTypeAndFormatPrivate(file, probe.bytes(), mzCtx.get());
+			if (!status)
+			{
+				return Unexpected{ status.error() };
+			}
+		}
+		Result<void> status = TryReadDosMetadata(file, probe.bytes(), *mzCtx);
+		if (!status)
+		{
+			return Unexpected{ status.error() };
+		}
+		Result<std::shared_ptr<MzExecutable>> exe = ParseExecutable(file, *mzCtx);
+		if (!exe)
+		{
+			return Unexpected{ exe.error() };
+		}
+		return std::shared_ptr<Executable>{ std::move(*exe) };
+	}
+
 
-	bool MzParser::TryParseTypeAndFormat(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, MzDosHeader& header, MzParseContext* ctx) const
+	Result<void> MzParser::TryParseTypeAndFormat(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> /*probeBytes*/, MzDosHeader& header, MzParseContext* ctx) const
 	{
 		if (ctx != nullptr)
 		{
@@ -76,13 +134,13 @@ namespace Eyesol::Executables::Mz
 				ctx->type = ExecutableType::Executable;
 			}
 		}
-		return true;
+		return {};
 	}
 
-	std::shared_ptr<MzExecutable> MzParser::ParseExecutable(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, MzParseContext& ctx) const
+	Result<std::shared_ptr<MzExecutable>> MzParser::ParseExecutable(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, MzParseContext& ctx) const
 	{
 		std::shared_ptr<MzExecutable> exe = std::make_shared<MzExecutable>();
-		exe->init(file, ctx);
+		exe->init(file, std::move(ctx));
 		return exe;
 	}
 
@@ -96,50 +154,41 @@ namespace Eyesol::Executables::Mz
 		return precalculatedLength;
 	}
 
-	void MzParser::ReadDosHeader(const MemoryMappedIO::MemoryMappedFile& file, MzDosHeader& header)
+	Result<void> MzParser::TryReadDosHeader(const MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, MzDosHeader& header)
 	{
-		if constexpr (DOS_ENDIANNESS == std::endian::native)
+		// A single bounded copy. Multi-byte fields are swapped
+		// only if the host byte order differs from the DOS one
+		if (probeBytes.size() >= sizeof(MzDosHeader))
 		{
-			file.Read<DOS_ENDIANNESS>(header, 0);
+			Memory::ReadStruct<DOS_ENDIANNESS>(probeBytes.data(), header);
+			return {};
 		}
-		else
+		Result<MzDosHeader> result = file.TryReadStruct<DOS_ENDIANNESS, MzDosHeader>(0);
+		if (!result)
 		{
-			// Assume big endian
-			file.Read<DOS_ENDIANNESS>(header.e_magic, 0);
-			file.Read<DOS_ENDIANNESS>(header.e_cblp, 2);
-			file.Read<DOS_ENDIANNESS>(header.e_cp, 4);
-			file.Read<DOS_ENDIANNESS>(header.e_crlc, 6);
-			file.Read<DOS_ENDIANNESS>(header.e_cparhdr, 8);
-			file.Read<DOS_ENDIANNESS>(header.e_minalloc, 0xa);
-			file.Read<DOS_ENDIANNESS>(header.e_maxalloc, 0xc);
-			file.Read<DOS_ENDIANNESS>(header.e_ss, 0xe);
-			file.Read<DOS_ENDIANNESS>(header.e_sp, 0x10);
-			file.Read<DOS_ENDIANNESS>(header.e_csum, 0x12);
-			file.Read<DOS_ENDIANNESS>(header.e_ip, 0x14);
-			file.Read<DOS_ENDIANNESS>(header.e_cs, 0x16);
-			file.Read<DOS_ENDIANNESS>(header.e_lfarlc, 0x18);
-			file.Read<DOS_ENDIANNESS>(header.e_ovno, 0x1a);
-			file.Read<DOS_ENDIANNESS>(header.e_res, 0x1c);
-			file.Read<DOS_ENDIANNESS>(header.e_oemid, 0x24);
-			file.Read<DOS_ENDIANNESS>(header.e_oeminfo, 0x26);
-			file.Read<DOS_ENDIANNESS>(header.e_res2, 0x28);
-			file.Read<DOS_ENDIANNESS>(header.e_lfanew, 0x3c);
+			return Unexpected{ result.error() };
 		}
+		header = *result;
+		return {};
 	}
 
-	void MzParser::ReadDosMetadata(const MemoryMappedIO::MemoryMappedFile& file, MzParseContext& ctx) const
+	Result<void> MzParser::TryReadDosMetadata(const MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, MzParseContext& ctx) const
 	{
 		// https://bytepointer.com/download.php?name=msdos_encyclopedia_article4_program_structure_exe_com.pdf
 		MzDosHeader& mzHeader = ctx.header;
 		MzFileMetadata& metadata = ctx.metadata;
 		if (!ctx.mzHeaderRead)
 		{
-			ReadDosHeader(file, mzHeader);
+			Result<void> status = TryReadDosHeader(file, {}, mzHeader);
+			if (!status)
+			{
+				return status;
+			}
 			ctx.mzHeaderRead = true;
 		}
 		if (mzHeader.e_magic != DOS_HEADER_MAGIC)
 		{
-			throw std::runtime_error{ "file is not a DOS executable" };
+			return Unexpected{ ErrorCode::UnknownFormat };
 		}
 		//isDerivedType = IsDerivedType(file, mzHeader, nullptr, nullptr);
 
@@ -165,7 +214,27 @@ namespace Eyesol::Executables::Mz
 			dosPartFileLength = static_cast<uint32_t>(fileLength);
 		}
 		dosPartFileLength = CalculateActualMzDataLength(file, dosPartFileLength, ctx);
+		if (dosPartFileLength > fileLength)
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
 		metadata.actualDosDataLength = dosPartFileLength;
+		// The checksum and the Rich header are read from the probe bytes, which usually cover the DOS part.
+		// Otherwise it is mapped once for both
+		if (probeBytes.size() >= dosPartFileLength)
+		{
+			ctx.dosData = probeBytes.first(dosPartFileLength);
+		}
+		else
+		{
+			Result<MemoryMappedIO::MemoryMappedFileRegion> region = file.TryMapRegion(0, dosPartFileLength);
+			if (!region)
+			{
+				return Unexpected{ region.error() };
+			}
+			ctx.dosDataRegion = std::move(*region);
+			ctx.dosData = { ctx.dosDataRegion.data(), dosPartFileLength };
+		}
 
 		// Write and move out a generic algorithm to read a plain MZ DOS and PE files
 		/*
@@ -183,65 +252,41 @@ namespace Eyesol::Executables::Mz
 		uint16_t dosRelocationsOffset = mzHeader.e_lfarlc;
 		uint16_t relocationsCount = mzHeader.e_crlc;
 		metadata.dosRelocationsLoc = { dosRelocationsOffset, relocationsCount * DOS_HEADER_RELOCATION_SIZE };
-		auto&& dosRelocations = metadata.dosRelocations;
-		for (std::size_t i = 0; i < relocationsCount; i++)
+		// Relocations and stub code are only located here. They are read on demand through MzExecutable views
+		if (metadata.dosRelocationsLoc.AbsoluteEndOffset() > fileLength)
 		{
-			MzDosHeaderRelocation reloc;
-			file.Read<std::endian::little>(reloc.offset, dosRelocationsOffset + i * DOS_HEADER_RELOCATION_SIZE);
-			file.Read<std::endian::little>(reloc.segment, dosRelocationsOffset + i * DOS_HEADER_RELOCATION_SIZE + sizeof(uint16_t));
-			dosRelocations.push_back(reloc);
+			return Unexpected{ ErrorCode::DosRelocationsOutOfFile };
 		}
-		size_t dosStubCodeStart = dosRelocationsOffset + relocationsCount * DOS_HEADER_RELOCATION_SIZE;
+		size_t dosStubCodeStart = metadata.dosRelocationsLoc.AbsoluteEndOffset();
 		//uint32_t peHeaderOffset = mzHeader.e_lfanew;
-		size_t dosStubCodeLength = dosPartFileLength - dosStubCodeStart;
-		metadata.dosStubCodeLoc = { dosStubCodeStart, dosStubCodeLength };
-		auto&& dosStubCode = metadata.dosStubCode;
-		dosStubCode.resize(dosStubCodeLength, 0);
-		if (file.Read(dosStubCode.data(), dosStubCodeLength, dosStubCodeStart, 0, dosStubCodeLength) < dosStubCodeLength)
+		if (dosStubCodeStart > dosPartFileLength)
 		{
-			throw std::runtime_error{ "File is not DOS EXE file" };
+			return Unexpected{ ErrorCode::BadDosHeader };
 		}
-		uint16_t checksum = CalculateChecksum(file, ctx, false);
+		size_t dosStubCodeLength = dosPartFileLength - dosStubCodeStart;
+		metadata.dosStubCodeLoc = { dosStubCodeStart, dosStubCodeLength };
+		uint16_t checksum = CalculateChecksum(ctx.dosData);
 		if (mzHeader.e_csum != 0U)
 		{
 			metadata.checksumValid = ChecksumValid(checksum, mzHeader.e_csum);
 		}
 		// Implement reading of undocumented Microsoft "Rich" header
-		TryParseRichHeader(file, ctx);
+		return TryParseRichHeader(ctx);
 	}
 
-	uint16_t MzParser::CalculateChecksum(const MemoryMappedIO::MemoryMappedFile& file, MzParseContext& ctx, bool includeBytesBeyondActualDosPart)
+	uint16_t MzParser::CalculateChecksum(std::span<const unsigned char> dosData)
 	{
-		uint32_t actualMzFileLength = ctx.metadata.actualDosDataLength;
-		uint32_t nominalMzFileLength = ctx.metadata.nominalDosDataLength;
-		// Nominal may be greater than actual
-		MemoryMappedIO::MemoryMappedFileRegion region
-			= includeBytesBeyondActualDosPart
-			? file.MapRegion(0, nominalMzFileLength)
-			: file.MapRegion(0, actualMzFileLength);
 		// File format is little endian
-		const unsigned char* const start = region.begin();
-		uint16_t checksum{};
-		for (const unsigned char* ptr = start; ptr != start + DOS_HEADER_CHECKSUM_OFFSET; ptr += sizeof(uint16_t))
+		const unsigned char* const start = dosData.data();
+		auto regionLength = dosData.size();
+		// Words are summed in bulk, and the trailing odd byte is zero-extended
+		uint16_t checksum = Memory::Impl::LittleEndianWordSum(start, regionLength);
+		// We treat the Checksum field as 0x0000, so subtract it back
+		if (regionLength >= DOS_HEADER_CHECKSUM_OFFSET + sizeof(uint16_t))
 		{
 			uint16_t word;
-			Memory::Read<std::endian::little>(ptr, word);
-			checksum += word;
-		}
-		auto regionLength = region.length();
-		// We treat the Checksum field as 0x0000, so omit addition
-		for (size_t i = DOS_HEADER_CHECKSUM_OFFSET + sizeof(uint16_t); i < regionLength; i += 2)
-		{
-			uint16_t word;
-			Memory::Read<std::endian::little>(start + i, word);
-			checksum += word;
-		}
-		// If count of bytes is even
-		if (regionLength % 2 == 1)
-		{
-			// treat the last byte as uint16 with high byte zeroed
-			// Zero-extend read byte
-			checksum += static_cast<uint16_t>(region.at(regionLength - 1));
+			Memory::UnalignedRead<std::endian::little>(start + DOS_HEADER_CHECKSUM_OFFSET, word);
+			checksum -= word;
 		}
 		// If the nominal size is greater than the actual size of DOS file,
 		// the remaining *virtual* bytes will be null, so don't need to add it.
@@ -253,7 +298,7 @@ namespace Eyesol::Executables::Mz
 		return checksum + complementChecksum == std::numeric_limits<uint16_t>::max();
 	}
 
-	void MzParser::TryParseRichHeader(const MemoryMappedIO::MemoryMappedFile& file, MzParseContext& ctx)
+	Result<void> MzParser::TryParseRichHeader(MzParseContext& ctx)
 	{
 		// https://bytepointer.com/articles/the_microsoft_rich_header.htm
 		// https://ntcore.com/files/richsign.htm
@@ -309,78 +354,52 @@ is a multiple of 8. Unlike the previous two sections, the footer is not XORed wi
 the checksum value.
 		*/
 
+		// The header starts within the first 256 bytes and holds at most 255 elements,
+		// so the signature and the key after it can't be found farther, however long the DOS stub is
+		constexpr size_t RICH_SIGNATURE_SEARCH_WINDOW
+			= std::numeric_limits<uint8_t>::max() + RICH_HEADER_DANS_BLOCK_SIZE
+			+ std::numeric_limits<uint8_t>::max() * sizeof(RichHeaderElement) + sizeof(uint32_t) * 2;
+
 		uint32_t dataLength = ctx.metadata.actualDosDataLength;
-		auto region = file.MapRegion(0, dataLength);
-		const unsigned char* fileBegin = region.begin();
-		const unsigned char* filePtr = fileBegin + dataLength - sizeof(uint32_t);
-		bool richSignatureFound = false;
-		while (filePtr != fileBegin)
-		{
-			uint32_t data;
-			Memory::Read<std::endian::little>(filePtr, data);
-			if (data == DOS_HEADER_RICH_SIGNATURE_MAGIC)
-			{
-				richSignatureFound = true;
-				break;
-			}
-			filePtr -= sizeof(uint32_t);
-		}
-		if (!richSignatureFound)
+		size_t searchLength = std::min<size_t>(dataLength, RICH_SIGNATURE_SEARCH_WINDOW);
+		if (searchLength < sizeof(uint32_t) * 2)
 		{
-			return;
+			return {};
 		}
-		// Now filePtr points to a Rich signature
-		size_t richSignatureOffset = static_cast<size_t>(static_cast<std::make_unsigned_t<ptrdiff_t>>(filePtr - fileBegin));
-		uint32_t decryptKey;
-		Memory::Read<std::endian::little>(filePtr + sizeof(uint32_t), decryptKey);
-		filePtr -= sizeof(uint32_t);
-		bool startFound = false;
-		std::stack<RichHeaderElement> elements;
-		size_t richHeaderStartOffset{};
-
-		auto calculateHeaderStartOffset = [&filePtr, &fileBegin]() -> size_t
-			{
-				return static_cast<size_t>(static_cast<std::make_unsigned_t<ptrdiff_t>>(filePtr - fileBegin));
-			};
-
-		while (!startFound && (filePtr >= fileBegin))
+		// Only the search window is read, the header and its checksummed bytes are all within it
+		const unsigned char* fileBegin = ctx.dosData.first(searchLength).data();
+		// The signature is dword aligned and followed by the key.
+		// Dwords are compared as stored, so the magic is converted to the file byte order
+		constexpr uint32_t richSignaturePattern
+			= std::endian::native == std::endian::little ? DOS_HEADER_RICH_SIGNATURE_MAGIC : Memory::ByteSwap(DOS_HEADER_RICH_SIGNATURE_MAGIC);
+		// Dwords followed by a whole key. In a maximal header the signature is at 2308, the dword 577
+		size_t searchDwords = (searchLength - sizeof(uint32_t)) / sizeof(uint32_t);
+		size_t richSignatureIndex = Memory::Impl::FindLastDword(fileBegin, searchDwords, richSignaturePattern);
+		// Offset 0 contains the MZ magic, so it is never a signature
+		if (richSignatureIndex == searchDwords || richSignatureIndex == 0)
 		{
-			uint32_t lastPart;
-			Memory::Read<std::endian::little>(filePtr, lastPart);
-			lastPart ^= decryptKey;
-			if (lastPart == DOS_HEADER_DECRYPTED_DANS_SIGNATURE_MAGIC)
-			{
-				startFound = true;
-				richHeaderStartOffset = calculateHeaderStartOffset();
-				break;
-			}
-			filePtr -= sizeof(uint32_t);
-			uint32_t firstPart;
-			Memory::Read<std::endian::little>(filePtr, firstPart);
-			firstPart ^= decryptKey;
-			if (firstPart == DOS_HEADER_DECRYPTED_DANS_SIGNATURE_MAGIC)
-			{
-				startFound = true;
-				richHeaderStartOffset = calculateHeaderStartOffset();
-				break;
-			}
-			if (firstPart == 0 && lastPart == 0)
-			{
-				// Just an alignment element
-				continue;
-			}
-			uint16_t id = static_cast<uint16_t>((firstPart & 0xFFFF0000) >> 16);
-			uint16_t buildNumber = static_cast<uint16_t>((firstPart & 0xFFFF));
-			elements.push(RichHeaderElement{ id, buildNumber, lastPart });
-			filePtr -= sizeof(uint32_t);
+			return {};
 		}
-		if (!startFound)
+		size_t richSignatureOffset = richSignatureIndex * sizeof(uint32_t);
+		uint32_t decryptKey;
+		Memory::UnalignedRead<std::endian::little>(fileBegin + richSignatureOffset + sizeof(uint32_t), decryptKey);
+		// The key as stored in the file, to XOR raw dwords with it
+		uint32_t rawDecryptKey;
+		std::memcpy(&rawDecryptKey, fileBegin + richSignatureOffset + sizeof(uint32_t), sizeof(rawDecryptKey));
+
+		// Find the encrypted "DanS" preceding the signature
+		constexpr uint32_t dansSignaturePattern
+			= std::endian::native == std::endian::little ? DOS_HEADER_DECRYPTED_DANS_SIGNATURE_MAGIC : Memory::ByteSwap(DOS_HEADER_DECRYPTED_DANS_SIGNATURE_MAGIC);
+		size_t dansSignatureIndex = Memory::Impl::FindLastDword(fileBegin, richSignatureIndex, dansSignaturePattern ^ rawDecryptKey);
+		if (dansSignatureIndex == richSignatureIndex)
 		{
-			return;
+			return {};
 		}
-		if (richHeaderStartOffset > std::numeric_limits<uint8_t>::max())
+		size_t richHeaderStartOffset = dansSignatureIndex * sizeof(uint32_t);
+		size_t elementsOffset = richHeaderStartOffset + RICH_HEADER_DANS_BLOCK_SIZE;
+		if (richHeaderStartOffset > std::numeric_limits<uint8_t>::max() || elementsOffset > richSignatureOffset)
 		{
-			throw std::runtime_error{ "Something went wrong" };
+			return Unexpected{ ErrorCode::BadRichHeader };
 		}
 		size_t richHeaderEndOffset = ctx.metadata.actualDosDataLength;
 		size_t richHeaderLength = richHeaderEndOffset - richHeaderStartOffset;
@@ -391,15 +410,26 @@ the checksum value.
 		richMetadata.loc = { richHeaderStartOffset, richHeaderLength };
 		richMetadata.richSignatureOffset = richSignatureOffset;
 		richHeader.decryptKey = decryptKey;
+
+		// Decrypt all the elements at once, right into the vector
 		auto&& vec = richHeader.elements;
-		while (!elements.empty())
+		vec.resize((richSignatureOffset - elementsOffset) / sizeof(RichHeaderElement));
+		Memory::Impl::XorDwords(fileBegin + elementsOffset, vec.data(), vec.size() * sizeof(RichHeaderElement) / sizeof(uint32_t), rawDecryptKey);
+		if constexpr (std::endian::native != std::endian::little)
 		{
-			vec.push_back(elements.top());
-			elements.pop();
+			for (auto&& elem : vec)
+			{
+				Memory::StructLayoutOf<RichHeaderElement>::SwapByteOrder(elem);
+			}
 		}
+		// Null elements are just an alignment
+		std::erase_if(vec, [](const RichHeaderElement& elem)
+			{
+				return elem.id == 0 && elem.build_number == 0 && elem.use_count == 0;
+			});
 		if (vec.size() > std::numeric_limits<uint8_t>::max())
 		{
-			throw std::runtime_error{ "Something went wrong" };
+			return Unexpected{ ErrorCode::BadRichHeader };
 		}
 		// Now calculate the Rich header checksum
 		// Header cannot end in unaligned address, so don't check
@@ -483,11 +513,13 @@ csum = 0x80 + cd + cr
 		// Usually 0x80
 		uint32_t fullDosHeaderSize = richHeaderStartOffset;
 		ctx.metadata.actualDosDataLength = fullDosHeaderSize;
-		auto correctedMzCodeLength = ctx.metadata.dosStubCode.size() - richHeaderLength;
-		ctx.metadata.dosStubCode.resize(correctedMzCodeLength);
+		// The Rich header is not a part of the stub code
+		auto&& dosStubCodeLoc = ctx.metadata.dosStubCodeLoc;
+		dosStubCodeLoc.Length -= std::min(dosStubCodeLoc.Length, richHeaderLength);
 		//ctx.metadata.dosHeaderLoc = ;
 		uint32_t checksum = fullDosHeaderSize + cd + cr;
 		richMetadata.checksumValid = checksum == decryptKey;
+		return {};
 	}
 
 	ExecutableObjectFormat MzExecutable::format() const
@@ -526,11 +558,11 @@ csum = 0x80 + cd + cr
 		throw std::logic_error{ "File doesn't contain debug info" };
 	}
 
-	void MzExecutable::init(MemoryMappedIO::MemoryMappedFile file, const MzParseContext& ctx)
+	void MzExecutable::init(MemoryMappedIO::MemoryMappedFile file, MzParseContext&& ctx)
 	{
 		_file = std::move(file);
 		_exeType = ctx.type.value();
-		_metadata = ctx.metadata;
+		_metadata = std::move(ctx.metadata);
 	}
 
 	std::vector<std::string> MzParser::_supportedFormatNames{ "MZ" };
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include "PeAuthenticode.hpp"
+#include "PeParser.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		// Big enough to make mapping costs negligible, small enough to keep the address space free
+		constexpr std::size_t WINDOW_LENGTH = 4 * 1024 * 1024;
+
+		constexpr std::size_t CHECKSUM_LENGTH = sizeof(std::uint32_t);
+
+		// Yields the ranges window by window. A window stays mapped until the next call
+		class RangeReader
+		{
+		public:
+			RangeReader(const MemoryMappedIO::MemoryMappedFile& file, std::vector<FileLocation> ranges)
+				: _file{ &file },
+				_ranges{ std::move(ranges) },
+				_range{},
+				_position{},
+				_window{}
+			{
+			}
+
+			Result<std::span<const unsigned char>> operator()()
+			{
+				while (_range != _ranges.size() && _position == _ranges[_range].Length)
+				{
+					_range++;
+					_position = 0;
+				}
+				if (_range == _ranges.size())
+				{
+					_window = {};
+					return std::span<const unsigned char>{};
+				}
+				const FileLocation& range = _ranges[_range];
+				std::size_t length = std::min(range.Length - _position, WINDOW_LENGTH);
+				Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> window = _file->TryView<unsigned char>(range.AbsoluteOffset + _position, length);
+				if (!window)
+				{
+					return Unexpected{ window.error() };
+				}
+				_window = std::move(*window);
+				_position += length;
+				return _window.span();
+			}
+
+		private:
+			const MemoryMappedIO::MemoryMappedFile* _file;
+			std::vector<FileLocation> _ranges;
+			std::size_t _range;
+			std::size_t _position;
+			MemoryMappedIO::MemoryMappedSpan<unsigned char> _window;
+		};
+
+		template <typename Hasher>
+		AuthenticodeDigest HashAll(RangeReader& reader)
+		{
+			Hasher hasher;
+			for (;;)
+			{
+				Result<std::span<const unsigned char>> piece = reader();
+				if (!piece)
+				{
+					return Unexpected{ piece.error() };
+				}
+				if (piece->empty())
+				{
+					break;
+				}
+				hasher.Update(*piece);
+			}
+			typename Hasher::Digest digest = hasher.Final();
+			return std::vector<std::uint8_t>(digest.begin(), digest.end());
+		}
+	}
+	#pragma endregion
+
+	Result<std::vector<FileLocation>> GetAuthenticodeRanges(const PeExecutable& exe)
+	{
+		const PeFileMetadata& metadata = exe.peMetadata();
+		std::uint64_t fileLength = exe.file().length();
+		std::uint64_t headersLength = metadata.optionalHeader.SizeOfHeaders;
+		if (headersLength > fileLength)
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+
+		std::vector<FileLocation> ranges;
+		std::uint64_t position = 0;
+		auto hashUpTo = [&](std::uint64_t end)
+		{
+			if (end > position)
+			{
+				ranges.push_back({ position, static_cast<std::size_t>(end - position) });
+			}
+		};
+		// The excluded fields are rewritten by signing, so the hash must not depend on them
+		std::uint64_t checkSumOffset = metadata.checkSumOffset();
+		if (checkSumOffset + CHECKSUM_LENGTH > headersLength)
+		{
+			return Unexpected{ ErrorCode::BadOptionalHeader };
+		}
+		hashUpTo(checkSumOffset);
+		position = checkSumOffset + CHECKSUM_LENGTH;
+		constexpr auto SECURITY = static_cast<std::uint32_t>(DataDirectoryIndex::Security);
+		std::uint64_t certificatesLength = 0;
+		if (metadata.dataDirectoriesCount > SECURITY)
+		{
+			std::uint64_t entryOffset = metadata.dataDirectoryOffset(DataDirectoryIndex::Security);
+			if (entryOffset + sizeof(DataDirectory) > headersLength)
+			{
+				return Unexpected{ ErrorCode::BadOptionalHeader };
+			}
+			hashUpTo(entryOffset);
+			position = entryOffset + sizeof(DataDirectory);
+
+			const DataDirectory& certificates = metadata.dataDirectory(DataDirectoryIndex::Security);
+			certificatesLength = certificates.Size;
+			if (certificatesLength != 0 && std::uint64_t{ certificates.VirtualAddress } + certificatesLength > fileLength)
+			{
+				return Unexpected{ ErrorCode::TruncatedData };
+			}
+		}
+		hashUpTo(headersLength);
+
+		std::size_t headerRanges = ranges.size();
+		for (const SectionHeader& section : exe.sections())
+		{
+			if (section.SizeOfRawData == 0)
+			{
+				continue;
+			}
+			if (std::uint64_t{ section.PointerToRawData } + section.SizeOfRawData > fileLength)
+			{
+				return Unexpected{ ErrorCode::TruncatedData };
+			}
+			ranges.push_back({ section.PointerToRawData, section.SizeOfRawData });
+		}
+		std::stable_sort(ranges.begin() + headerRanges, ranges.end(),
+			[](const FileLocation& left, const FileLocation& right)
+			{
+				return left.AbsoluteOffset < right.AbsoluteOffset;
+			});
+
+		// As the specification puts it, the extra data starts at the count of hashed bytes,
+		// and the certificate table is assumed to be at the end of the file
+		std::uint64_t hashedBytes = headersLength;
+		for (std::size_t i = headerRanges; i < ranges.size(); i++)
+		{
+			hashedBytes += ranges[i].Length;
+		}
+		if (hashedBytes + certificatesLength < fileLength)
+		{
+			ranges.push_back({ hashedBytes, static_cast<std::size_t>(fileLength - certificatesLength - hashedBytes) });
+		}
+		return ranges;
+	}
+
+	AuthenticodeDigest ComputeAuthenticodeHash(const PeExecutable& exe, Hashing::HashAlgorithm algorithm)
+	{
+		Result<std::vector<FileLocation>> ranges = GetAuthenticodeRanges(exe);
+		if (!ranges)
+		{
+			return Unexpected{ ranges.error() };
+		}
+		RangeReader reader{ exe.file(), std::move(*ranges) };
+		switch (algorithm)
+		{
+		case Hashing::HashAlgorithm::Sha1:
+			return HashAll<Hashing::Sha1>(reader);
+		case Hashing::HashAlgorithm::Sha256:
+			return HashAll<Hashing::Sha256>(reader);
+		default:
+			return Unexpected{ ErrorCode::NotImplemented };
+		}
+	}
+
+	std::vector<AuthenticodeDigest> ComputeAuthenticodeHashes(std::span<const PeExecutable* const> executables, Hashing::HashAlgorithm algorithm)
+	{
+		std::vector<Hashing::MultiBufferHasher::Reader> readers;
+		readers.reserve(executables.size());
+		for (const PeExecutable* exe : executables)
+		{
+			Result<std::vector<FileLocation>> ranges = GetAuthenticodeRanges(*exe);
+			if (ranges)
+			{
+				readers.emplace_back(RangeReader{ exe->file(), std::move(*ranges) });
+			}
+			else
+			{
+				// The hasher records the error as the digest
+				readers.emplace_back([error = ranges.error()]() -> Result<std::span<const unsigned char>>
+					{
+						return Unexpected{ error };
+					});
+			}
+		}
+		return Hashing::MultiBufferHasher{ algorithm }.Hash(readers);
+	}
+}
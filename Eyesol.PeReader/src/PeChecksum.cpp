@@ -0,0 +1,52 @@
+#include <algorithm>
+#include "Memory.hpp"
+#include "PeChecksum.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		// Big enough to make mapping costs negligible, small enough to keep the address space free.
+		// Even, so every window starts at a word boundary
+		constexpr std::size_t WINDOW_LENGTH = 4 * 1024 * 1024;
+
+		constexpr std::size_t CHECKSUM_LENGTH = sizeof(std::uint32_t);
+	}
+	#pragma endregion
+
+	Result<std::uint32_t> ComputePeChecksum(const MemoryMappedIO::MemoryMappedFile& file, std::uint64_t checkSumOffset)
+	{
+		std::uint64_t fileLength = file.length();
+		if (checkSumOffset > fileLength || fileLength - checkSumOffset < CHECKSUM_LENGTH)
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		std::uint64_t sum = 0;
+		for (std::uint64_t position = 0; position < fileLength; position += WINDOW_LENGTH)
+		{
+			std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(fileLength - position, WINDOW_LENGTH));
+			Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> window = file.TryView<unsigned char>(position, length);
+			if (!window)
+			{
+				return Unexpected{ window.error() };
+			}
+			sum += Memory::Impl::LittleEndianOnesComplementSum(window->data(), window->size());
+		}
+
+		// The field is summed with the rest of the file, so its words are subtracted back.
+		// The header may start at an odd offset, then the field spans three words
+		Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> field = file.TryView<unsigned char>(checkSumOffset, CHECKSUM_LENGTH);
+		if (!field)
+		{
+			return Unexpected{ field.error() };
+		}
+		const unsigned char* bytes = field->data();
+		std::uint32_t fieldSum = checkSumOffset % 2 == 0
+			? (bytes[0] | bytes[1] << 8) + (bytes[2] | bytes[3] << 8)
+			: (bytes[0] << 8) + (bytes[1] | bytes[2] << 8) + bytes[3];
+		// 2 * 0xFFFF is zero in ones' complement arithmetic, and keeps the difference positive
+		sum += 2 * 0xFFFF - fieldSum;
+		return static_cast<std::uint32_t>(Memory::Impl::FoldCarries(sum) + fileLength);
+	}
+}
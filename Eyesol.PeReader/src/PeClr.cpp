@@ -0,0 +1,635 @@
+#include <bit>
+#include <cstring>
+#include "PeClr.hpp"
+#include "PeParser.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		enum class ColumnType : std::uint8_t
+		{
+			U16,
+			U32,
+			StringIndex,
+			GuidIndex,
+			BlobIndex,
+			// A row of the target table
+			TableIndex,
+			// A coded index of the target kind
+			Coded,
+		};
+
+		struct Column
+		{
+			ColumnType type;
+			std::uint8_t target;
+		};
+
+		struct TableSchema
+		{
+			std::uint8_t count;
+			std::array<Column, METADATA_MAXIMUM_COLUMNS> columns;
+		};
+
+		constexpr Column U16{ ColumnType::U16, 0 };
+		constexpr Column U32{ ColumnType::U32, 0 };
+		constexpr Column String{ ColumnType::StringIndex, 0 };
+		constexpr Column GuidIndex{ ColumnType::GuidIndex, 0 };
+		constexpr Column Blob{ ColumnType::BlobIndex, 0 };
+
+		constexpr Column Index(MetadataTable table)
+		{
+			return { ColumnType::TableIndex, static_cast<std::uint8_t>(table) };
+		}
+
+		constexpr Column Coded(CodedIndex kind)
+		{
+			return { ColumnType::Coded, static_cast<std::uint8_t>(kind) };
+		}
+
+		using enum MetadataTable;
+		using enum CodedIndex;
+
+		// Columns of every table in the table order, ECMA-335 II.22
+		constexpr std::array<TableSchema, METADATA_TABLES_COUNT> TABLE_SCHEMAS
+		{
+			{
+				// Module: Generation, Name, Mvid, EncId, EncBaseId
+				{ 5, { U16, String, GuidIndex, GuidIndex, GuidIndex } },
+				// TypeRef: ResolutionScope, TypeName, TypeNamespace
+				{ 3, { Coded(ResolutionScope), String, String } },
+				// TypeDef: Flags, TypeName, TypeNamespace, Extends, FieldList, MethodList
+				{ 6, { U32, String, String, Coded(TypeDefOrRef), Index(Field), Index(MethodDef) } },
+				// FieldPtr: Field
+				{ 1, { Index(Field) } },
+				// Field: Flags, Name, Signature
+				{ 3, { U16, String, Blob } },
+				// MethodPtr: Method
+				{ 1, { Index(MethodDef) } },
+				// MethodDef: RVA, ImplFlags, Flags, Name, Signature, ParamList
+				{ 6, { U32, U16, U16, String, Blob, Index(Param) } },
+				// ParamPtr: Param
+				{ 1, { Index(Param) } },
+				// Param: Flags, Sequence, Name
+				{ 3, { U16, U16, String } },
+				// InterfaceImpl: Class, Interface
+				{ 2, { Index(TypeDef), Coded(TypeDefOrRef) } },
+				// MemberRef: Class, Name, Signature
+				{ 3, { Coded(MemberRefParent), String, Blob } },
+				// Constant: Type with a padding byte, Parent, Value
+				{ 3, { U16, Coded(HasConstant), Blob } },
+				// CustomAttribute: Parent, Type, Value
+				{ 3, { Coded(HasCustomAttribute), Coded(CustomAttributeType), Blob } },
+				// FieldMarshal: Parent, NativeType
+				{ 2, { Coded(HasFieldMarshal), Blob } },
+				// DeclSecurity: Action, Parent, PermissionSet
+				{ 3, { U16, Coded(HasDeclSecurity), Blob } },
+				// ClassLayout: PackingSize, ClassSize, Parent
+				{ 3, { U16, U32, Index(TypeDef) } },
+				// FieldLayout: Offset, Field
+				{ 2, { U32, Index(Field) } },
+				// StandAloneSig: Signature
+				{ 1, { Blob } },
+				// EventMap: Parent, EventList
+				{ 2, { Index(TypeDef), Index(Event) } },
+				// EventPtr: Event
+				{ 1, { Index(Event) } },
+				// Event: EventFlags, Name, EventType
+				{ 3, { U16, String, Coded(TypeDefOrRef) } },
+				// PropertyMap: Parent, PropertyList
+				{ 2, { Index(TypeDef), Index(Property) } },
+				// PropertyPtr: Property
+				{ 1, { Index(Property) } },
+				// Property: Flags, Name, Type
+				{ 3, { U16, String, Blob } },
+				// MethodSemantics: Semantics, Method, Association
+				{ 3, { U16, Index(MethodDef), Coded(HasSemantics) } },
+				// MethodImpl: Class, MethodBody, MethodDeclaration
+				{ 3, { Index(TypeDef), Coded(MethodDefOrRef), Coded(MethodDefOrRef) } },
+				// ModuleRef: Name
+				{ 1, { String } },
+				// TypeSpec: Signature
+				{ 1, { Blob } },
+				// ImplMap: MappingFlags, MemberForwarded, ImportName, ImportScope
+				{ 4, { U16, Coded(MemberForwarded), String, Index(ModuleRef) } },
+				// FieldRVA: RVA, Field
+				{ 2, { U32, Index(Field) } },
+				// EncLog: Token, FuncCode
+				{ 2, { U32, U32 } },
+				// EncMap: Token
+				{ 1, { U32 } },
+				// Assembly: HashAlgId, MajorVersion, MinorVersion, BuildNumber, RevisionNumber, Flags, PublicKey, Name, Culture
+				{ 9, { U32, U16, U16, U16, U16, U32, Blob, String, String } },
+				// AssemblyProcessor: Processor
+				{ 1, { U32 } },
+				// AssemblyOS: OSPlatformID, OSMajorVersion, OSMinorVersion
+				{ 3, { U32, U32, U32 } },
+				// AssemblyRef: MajorVersion, MinorVersion, BuildNumber, RevisionNumber, Flags, PublicKeyOrToken, Name, Culture, HashValue
+				{ 9, { U16, U16, U16, U16, U32, Blob, String, String, Blob } },
+				// AssemblyRefProcessor: Processor, AssemblyRef
+				{ 2, { U32, Index(AssemblyRef) } },
+				// AssemblyRefOS: OSPlatformId, OSMajorVersion, OSMinorVersion, AssemblyRef
+				{ 4, { U32, U32, U32, Index(AssemblyRef) } },
+				// File: Flags, Name, HashValue
+				{ 3, { U32, String, Blob } },
+				// ExportedType: Flags, TypeDefId, TypeName, TypeNamespace, Implementation
+				{ 5, { U32, U32, String, String, Coded(Implementation) } },
+				// ManifestResource: Offset, Flags, Name, Implementation
+				{ 4, { U32, U32, String, Coded(Implementation) } },
+				// NestedClass: NestedClass, EnclosingClass
+				{ 2, { Index(TypeDef), Index(TypeDef) } },
+				// GenericParam: Number, Flags, Owner, Name
+				{ 4, { U16, U16, Coded(TypeOrMethodDef), String } },
+				// MethodSpec: Method, Instantiation
+				{ 2, { Coded(MethodDefOrRef), Blob } },
+				// GenericParamConstraint: Owner, Constraint
+				{ 2, { Index(GenericParam), Coded(TypeDefOrRef) } },
+			}
+		};
+
+		// Tags, which no table is encoded with
+		constexpr std::uint8_t NO_TABLE = 0xFF;
+		constexpr std::size_t CODED_INDEX_MAXIMUM_TABLES = 22;
+
+		struct CodedIndexSchema
+		{
+			std::uint8_t tagBits;
+			std::uint8_t count;
+			// Tables in the tag order
+			std::array<std::uint8_t, CODED_INDEX_MAXIMUM_TABLES> tables;
+		};
+
+		constexpr std::uint8_t T(MetadataTable table)
+		{
+			return static_cast<std::uint8_t>(table);
+		}
+
+		// ECMA-335 II.24.2.6
+		constexpr std::array<CodedIndexSchema, static_cast<std::size_t>(TypeOrMethodDef) + 1> CODED_INDEX_SCHEMAS
+		{
+			{
+				// TypeDefOrRef
+				{ 2, 3, { T(TypeDef), T(TypeRef), T(TypeSpec) } },
+				// HasConstant
+				{ 2, 3, { T(Field), T(Param), T(Property) } },
+				// HasCustomAttribute
+				{ 5, 22,
+					{
+						T(MethodDef), T(Field), T(TypeRef), T(TypeDef), T(Param), T(InterfaceImpl), T(MemberRef), T(Module),
+						T(DeclSecurity), T(Property), T(Event), T(StandAloneSig), T(ModuleRef), T(TypeSpec), T(Assembly),
+						T(AssemblyRef), T(File), T(ExportedType), T(ManifestResource), T(GenericParam),
+						T(GenericParamConstraint), T(MethodSpec)
+					}
+				},
+				// HasFieldMarshal
+				{ 1, 2, { T(Field), T(Param) } },
+				// HasDeclSecurity
+				{ 2, 3, { T(TypeDef), T(MethodDef), T(Assembly) } },
+				// MemberRefParent
+				{ 3, 5, { T(TypeDef), T(TypeRef), T(ModuleRef), T(MethodDef), T(TypeSpec) } },
+				// HasSemantics
+				{ 1, 2, { T(Event), T(Property) } },
+				// MethodDefOrRef
+				{ 1, 2, { T(MethodDef), T(MemberRef) } },
+				// MemberForwarded
+				{ 1, 2, { T(Field), T(MethodDef) } },
+				// Implementation
+				{ 2, 3, { T(File), T(AssemblyRef), T(ExportedType) } },
+				// CustomAttributeType, only two of the tags are used
+				{ 3, 5, { NO_TABLE, NO_TABLE, T(MethodDef), T(MemberRef), NO_TABLE } },
+				// ResolutionScope
+				{ 2, 4, { T(Module), T(ModuleRef), T(AssemblyRef), T(TypeRef) } },
+				// TypeOrMethodDef
+				{ 1, 2, { T(TypeDef), T(MethodDef) } },
+			}
+		};
+
+		// HeapSizes bits of the tables stream header
+		constexpr std::uint8_t HEAP_SIZES_WIDE_STRINGS = 0x01;
+		constexpr std::uint8_t HEAP_SIZES_WIDE_GUIDS = 0x02;
+		constexpr std::uint8_t HEAP_SIZES_WIDE_BLOBS = 0x04;
+		// Uncompressed streams may have a dword of edit-and-continue data after the row counts
+		constexpr std::uint8_t HEAP_SIZES_EXTRA_DATA = 0x40;
+
+		// The signature, versions, the reserved dword and the version length
+		constexpr std::size_t METADATA_ROOT_FIXED_LENGTH = 16;
+		// Reserved, MajorVersion, MinorVersion, HeapSizes, Reserved, Valid and Sorted
+		constexpr std::size_t TABLES_HEADER_LENGTH = 24;
+		// Stream names are null-terminated and padded, 32 bytes at most
+		constexpr std::size_t STREAM_NAME_MAXIMUM_LENGTH = 32;
+		// Tokens store rows in three bytes
+		constexpr std::uint32_t MAXIMUM_ROWS = 0x00FFFFFF;
+
+		constexpr std::size_t AlignUp4(std::size_t value)
+		{
+			return (value + 3) & ~std::size_t{ 3 };
+		}
+
+		// The compressed length of a blob, ECMA-335 II.24.2.4
+		Result<std::span<const unsigned char>> ReadBlob(std::span<const unsigned char> heap, std::uint32_t index)
+		{
+			if (index == 0)
+			{
+				return std::span<const unsigned char>{};
+			}
+			if (index >= heap.size())
+			{
+				return Unexpected{ ErrorCode::TokenOutOfRange };
+			}
+			std::span<const unsigned char> rest = heap.subspan(index);
+			std::uint32_t length;
+			std::size_t lengthSize;
+			if ((rest[0] & 0x80) == 0)
+			{
+				length = rest[0];
+				lengthSize = 1;
+			}
+			else if ((rest[0] & 0xC0) == 0x80 && rest.size() >= 2)
+			{
+				length = (rest[0] & 0x3Fu) << 8 | rest[1];
+				lengthSize = 2;
+			}
+			else if ((rest[0] & 0xE0) == 0xC0 && rest.size() >= 4)
+			{
+				length = (rest[0] & 0x1Fu) << 24 | rest[1] << 16 | rest[2] << 8 | rest[3];
+				lengthSize = 4;
+			}
+			else
+			{
+				return Unexpected{ ErrorCode::BadClrMetadata };
+			}
+			if (length > rest.size() - lengthSize)
+			{
+				return Unexpected{ ErrorCode::BadClrMetadata };
+			}
+			return rest.subspan(lengthSize, length);
+		}
+	}
+	#pragma endregion
+
+	ClrMetadata::ClrMetadata() noexcept
+		: _data{},
+		_version{},
+		_uncompressed{},
+		_sortedMask{},
+		_tablesData{},
+		_strings{},
+		_userStrings{},
+		_guids{},
+		_blobs{},
+		_tables{}
+	{
+	}
+
+	Result<ClrMetadata> ClrMetadata::Create(const PeExecutable& exe)
+	{
+		const std::optional<Cor20Header>& header = exe.clrHeader();
+		if (!header)
+		{
+			return ClrMetadata{};
+		}
+		const DataDirectory& metadata = header->MetaData;
+		if (metadata.VirtualAddress == 0 || metadata.Size == 0)
+		{
+			return Unexpected{ ErrorCode::BadClrMetadata };
+		}
+		// Only the metadata is mapped, IL and resources are not
+		Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> data = exe.ViewAtRva(metadata.VirtualAddress, metadata.Size);
+		if (!data)
+		{
+			return Unexpected{ data.error() };
+		}
+		return Parse(std::move(*data));
+	}
+
+	Result<ClrMetadata> ClrMetadata::Parse(MemoryMappedIO::MemoryMappedSpan<unsigned char> data)
+	{
+		std::span<const unsigned char> bytes = data;
+		if (bytes.size() < METADATA_ROOT_FIXED_LENGTH)
+		{
+			return Unexpected{ ErrorCode::BadClrMetadata };
+		}
+		std::uint32_t signature;
+		std::uint32_t versionLength;
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(bytes.data(), signature);
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(bytes.data() + 12, versionLength);
+		// The version is followed by Flags and the count of streams
+		if (signature != CLR_METADATA_SIGNATURE || versionLength > bytes.size() - METADATA_ROOT_FIXED_LENGTH - 2 * sizeof(std::uint16_t))
+		{
+			return Unexpected{ ErrorCode::BadClrMetadata };
+		}
+		ClrMetadata result;
+		// The version is null-padded up to a dword boundary
+		const char* version = reinterpret_cast<const char*>(bytes.data() + METADATA_ROOT_FIXED_LENGTH);
+		const void* terminator = std::memchr(version, '\0', versionLength);
+		result._version = std::string_view{ version, terminator ? static_cast<const char*>(terminator) : version + versionLength };
+
+		std::size_t position = METADATA_ROOT_FIXED_LENGTH + versionLength;
+		std::uint16_t streamsCount;
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(bytes.data() + position + sizeof(std::uint16_t), streamsCount);
+		position += 2 * sizeof(std::uint16_t);
+		bool tablesFound = false;
+		for (std::uint16_t i = 0; i < streamsCount; i++)
+		{
+			std::uint32_t offset;
+			std::uint32_t size;
+			if (bytes.size() - position < 2 * sizeof(std::uint32_t))
+			{
+				return Unexpected{ ErrorCode::BadClrMetadata };
+			}
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(bytes.data() + position, offset);
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(bytes.data() + position + sizeof(std::uint32_t), size);
+			position += 2 * sizeof(std::uint32_t);
+			const char* name = reinterpret_cast<const char*>(bytes.data() + position);
+			const void* nameEnd = std::memchr(name, '\0', std::min(bytes.size() - position, STREAM_NAME_MAXIMUM_LENGTH));
+			if (nameEnd == nullptr || offset > bytes.size() || size > bytes.size() - offset)
+			{
+				return Unexpected{ ErrorCode::BadClrMetadata };
+			}
+			std::string_view streamName{ name, static_cast<const char*>(nameEnd) };
+			position = std::min(bytes.size(), position + AlignUp4(streamName.size() + 1));
+
+			// Like the runtime, take the first stream of a name
+			std::span<const unsigned char> stream = bytes.subspan(offset, size);
+			if ((streamName == "#~" || streamName == "#-") && !tablesFound)
+			{
+				tablesFound = true;
+				result._uncompressed = streamName == "#-";
+				result._tablesData = stream;
+			}
+			else if (streamName == "#Strings" && result._strings.empty())
+			{
+				result._strings = stream;
+			}
+			else if (streamName == "#US" && result._userStrings.empty())
+			{
+				result._userStrings = stream;
+			}
+			else if (streamName == "#GUID" && result._guids.empty())
+			{
+				result._guids = stream;
+			}
+			else if (streamName == "#Blob" && result._blobs.empty())
+			{
+				result._blobs = stream;
+			}
+		}
+		if (!tablesFound || result._tablesData.size() < TABLES_HEADER_LENGTH)
+		{
+			return Unexpected{ ErrorCode::BadClrMetadata };
+		}
+
+		std::uint8_t heapSizes = result._tablesData[6];
+		std::uint64_t validMask;
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(result._tablesData.data() + 8, validMask);
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(result._tablesData.data() + 16, result._sortedMask);
+		Result<void> status = result.ComputeLayouts(result._tablesData, heapSizes, validMask);
+		if (!status)
+		{
+			return Unexpected{ status.error() };
+		}
+		result._data = std::move(data);
+		return result;
+	}
+
+	Result<void> ClrMetadata::ComputeLayouts(std::span<const unsigned char> header, std::uint8_t heapSizes, std::uint64_t validMask)
+	{
+		// Portable PDB tables and unknown tables may not be in an image
+		if ((validMask >> METADATA_TABLES_COUNT) != 0)
+		{
+			return Unexpected{ ErrorCode::BadClrMetadata };
+		}
+		std::size_t position = TABLES_HEADER_LENGTH;
+		std::size_t rowCountsLength = static_cast<std::size_t>(std::popcount(validMask)) * sizeof(std::uint32_t);
+		if (header.size() - position < rowCountsLength)
+		{
+			return Unexpected{ ErrorCode::BadClrMetadata };
+		}
+		for (std::size_t table = 0; table < METADATA_TABLES_COUNT; table++)
+		{
+			_tables[table] = {};
+			if ((validMask >> table & 1) != 0)
+			{
+				Memory::UnalignedRead<PE_COFF_ENDIANNESS>(header.data() + position, _tables[table].rows);
+				position += sizeof(std::uint32_t);
+				if (_tables[table].rows > MAXIMUM_ROWS)
+				{
+					return Unexpected{ ErrorCode::BadClrMetadata };
+				}
+			}
+		}
+		if ((heapSizes & HEAP_SIZES_EXTRA_DATA) != 0)
+		{
+			position += sizeof(std::uint32_t);
+		}
+
+		std::uint8_t stringWidth = (heapSizes & HEAP_SIZES_WIDE_STRINGS) != 0 ? 4 : 2;
+		std::uint8_t guidWidth = (heapSizes & HEAP_SIZES_WIDE_GUIDS) != 0 ? 4 : 2;
+		std::uint8_t blobWidth = (heapSizes & HEAP_SIZES_WIDE_BLOBS) != 0 ? 4 : 2;
+		auto columnWidth = [this, stringWidth, guidWidth, blobWidth](Column column) -> std::uint8_t
+			{
+				switch (column.type)
+				{
+				case ColumnType::U16:
+					return 2;
+				case ColumnType::U32:
+					return 4;
+				case ColumnType::StringIndex:
+					return stringWidth;
+				case ColumnType::GuidIndex:
+					return guidWidth;
+				case ColumnType::BlobIndex:
+					return blobWidth;
+				case ColumnType::TableIndex:
+					return _tables[column.target].rows <= 0xFFFF ? 2 : 4;
+				default:
+				{
+					// Short indices keep the row in the bits left after the tag
+					const CodedIndexSchema& coded = CODED_INDEX_SCHEMAS[column.target];
+					std::uint32_t maximumRows = 0;
+					for (std::size_t i = 0; i < coded.count; i++)
+					{
+						if (coded.tables[i] != NO_TABLE)
+						{
+							maximumRows = std::max(maximumRows, _tables[coded.tables[i]].rows);
+						}
+					}
+					return maximumRows < (1u << (16 - coded.tagBits)) ? 2 : 4;
+				}
+				}
+			};
+
+		// Tables follow each other in the table order
+		std::uint64_t offset = position;
+		for (std::size_t table = 0; table < METADATA_TABLES_COUNT; table++)
+		{
+			const TableSchema& schema = TABLE_SCHEMAS[table];
+			TableLayout& layout = _tables[table];
+			layout.columnsCount = schema.count;
+			std::uint8_t columnOffset = 0;
+			for (std::size_t column = 0; column < schema.count; column++)
+			{
+				layout.columnOffsets[column] = columnOffset;
+				columnOffset += columnWidth(schema.columns[column]);
+			}
+			layout.columnOffsets[schema.count] = columnOffset;
+			layout.rowSize = columnOffset;
+			layout.offset = static_cast<std::uint32_t>(offset);
+			offset += std::uint64_t{ layout.rows } * layout.rowSize;
+			if (offset > header.size())
+			{
+				return Unexpected{ ErrorCode::BadClrMetadata };
+			}
+		}
+		return {};
+	}
+
+	Result<MetadataRow> ClrMetadata::RowAt(MetadataTable table, std::uint32_t row) const
+	{
+		std::size_t tableIndex = static_cast<std::size_t>(table);
+		if (tableIndex >= METADATA_TABLES_COUNT || row == 0 || row > _tables[tableIndex].rows)
+		{
+			return Unexpected{ ErrorCode::TokenOutOfRange };
+		}
+		const TableLayout& layout = _tables[tableIndex];
+		const unsigned char* data = _tablesData.data() + layout.offset + static_cast<std::size_t>(row - 1) * layout.rowSize;
+		MetadataRow result{};
+		result.size = layout.columnsCount;
+		for (std::size_t column = 0; column < layout.columnsCount; column++)
+		{
+			const unsigned char* field = data + layout.columnOffsets[column];
+			if (layout.columnOffsets[column + 1] - layout.columnOffsets[column] == sizeof(std::uint16_t))
+			{
+				std::uint16_t value;
+				Memory::UnalignedRead<PE_COFF_ENDIANNESS>(field, value);
+				result.columns[column] = value;
+			}
+			else
+			{
+				Memory::UnalignedRead<PE_COFF_ENDIANNESS>(field, result.columns[column]);
+			}
+		}
+		return result;
+	}
+
+	Result<TypeDefRow> ClrMetadata::TypeDefAt(std::uint32_t row) const
+	{
+		Result<MetadataRow> raw = RowAt(MetadataTable::TypeDef, row);
+		if (!raw)
+		{
+			return Unexpected{ raw.error() };
+		}
+		Result<std::string_view> typeName = GetString((*raw)[1]);
+		Result<std::string_view> typeNamespace = GetString((*raw)[2]);
+		Result<MetadataToken> extends = DecodeCodedIndex(CodedIndex::TypeDefOrRef, (*raw)[3]);
+		if (!typeName || !typeNamespace || !extends)
+		{
+			return Unexpected{ !typeName ? typeName.error() : !typeNamespace ? typeNamespace.error() : extends.error() };
+		}
+		return TypeDefRow{ (*raw)[0], *typeName, *typeNamespace, *extends, (*raw)[4], (*raw)[5] };
+	}
+
+	Result<MethodDefRow> ClrMetadata::MethodDefAt(std::uint32_t row) const
+	{
+		Result<MetadataRow> raw = RowAt(MetadataTable::MethodDef, row);
+		if (!raw)
+		{
+			return Unexpected{ raw.error() };
+		}
+		Result<std::string_view> name = GetString((*raw)[3]);
+		Result<std::span<const unsigned char>> signature = GetBlob((*raw)[4]);
+		if (!name || !signature)
+		{
+			return Unexpected{ !name ? name.error() : signature.error() };
+		}
+		return MethodDefRow
+		{
+			(*raw)[0],
+			static_cast<std::uint16_t>((*raw)[1]),
+			static_cast<std::uint16_t>((*raw)[2]),
+			*name,
+			*signature,
+			(*raw)[5]
+		};
+	}
+
+	Result<MemberRefRow> ClrMetadata::MemberRefAt(std::uint32_t row) const
+	{
+		Result<MetadataRow> raw = RowAt(MetadataTable::MemberRef, row);
+		if (!raw)
+		{
+			return Unexpected{ raw.error() };
+		}
+		Result<MetadataToken> parent = DecodeCodedIndex(CodedIndex::MemberRefParent, (*raw)[0]);
+		Result<std::string_view> name = GetString((*raw)[1]);
+		Result<std::span<const unsigned char>> signature = GetBlob((*raw)[2]);
+		if (!parent || !name || !signature)
+		{
+			return Unexpected{ !parent ? parent.error() : !name ? name.error() : signature.error() };
+		}
+		return MemberRefRow{ *parent, *name, *signature };
+	}
+
+	Result<std::string_view> ClrMetadata::GetString(std::uint32_t index) const
+	{
+		if (index == 0)
+		{
+			return std::string_view{};
+		}
+		if (index >= _strings.size())
+		{
+			return Unexpected{ ErrorCode::TokenOutOfRange };
+		}
+		const char* str = reinterpret_cast<const char*>(_strings.data() + index);
+		const void* terminator = std::memchr(str, '\0', _strings.size() - index);
+		if (terminator == nullptr)
+		{
+			return Unexpected{ ErrorCode::BadClrMetadata };
+		}
+		return std::string_view{ str, static_cast<const char*>(terminator) };
+	}
+
+	Result<Utf16LeView> ClrMetadata::GetUserString(std::uint32_t index) const
+	{
+		Result<std::span<const unsigned char>> blob = ReadBlob(_userStrings, index);
+		if (!blob)
+		{
+			return Unexpected{ blob.error() };
+		}
+		// The last byte tells whether the string has characters, which need special handling
+		return Utf16LeView{ blob->first(blob->size() & ~std::size_t{ 1 }) };
+	}
+
+	Result<Guid> ClrMetadata::GetGuid(std::uint32_t index) const
+	{
+		if (index == 0)
+		{
+			return Guid{};
+		}
+		if (index > _guids.size() / sizeof(Guid))
+		{
+			return Unexpected{ ErrorCode::TokenOutOfRange };
+		}
+		Guid guid;
+		Memory::ReadStruct<PE_COFF_ENDIANNESS>(_guids.data() + (index - 1) * sizeof(Guid), guid);
+		return guid;
+	}
+
+	Result<std::span<const unsigned char>> ClrMetadata::GetBlob(std::uint32_t index) const
+	{
+		return ReadBlob(_blobs, index);
+	}
+
+	Result<MetadataToken> ClrMetadata::DecodeCodedIndex(CodedIndex kind, std::uint32_t value) noexcept
+	{
+		const CodedIndexSchema& coded = CODED_INDEX_SCHEMAS[static_cast<std::size_t>(kind)];
+		std::uint32_t tag = value & ((1u << coded.tagBits) - 1);
+		if (tag >= coded.count || coded.tables[tag] == NO_TABLE)
+		{
+			return Unexpected{ ErrorCode::BadClrMetadata };
+		}
+		return MetadataToken{ static_cast<MetadataTable>(coded.tables[tag]), value >> coded.tagBits };
+	}
+}
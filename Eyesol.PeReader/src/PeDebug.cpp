@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "PeDebug.hpp"
+#include "PeParser.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		// Corrupted sizes don't make a lookup map more than this. Paths are much shorter
+		constexpr std::size_t CODEVIEW_RECORD_MAXIMUM_LENGTH = 64 * 1024;
+
+		// The path follows the header, and ends at the first null
+		Result<std::string_view> PathAfter(std::span<const unsigned char> record, std::size_t headerLength)
+		{
+			const char* path = reinterpret_cast<const char*>(record.data() + headerLength);
+			const void* terminator = std::memchr(path, '\0', record.size() - headerLength);
+			if (terminator == nullptr)
+			{
+				return Unexpected{ ErrorCode::BadDebugDirectory };
+			}
+			return std::string_view{ path, static_cast<const char*>(terminator) };
+		}
+	}
+	#pragma endregion
+
+	#pragma region PdbDebugInfo
+	PdbDebugInfo::PdbDebugInfo() noexcept
+		: _record{},
+		_format{},
+		_portable{},
+		_guid{},
+		_pdbSignature{},
+		_age{},
+		_pdbPath{}
+	{
+	}
+
+	Result<std::shared_ptr<PdbDebugInfo>> PdbDebugInfo::Parse(const DebugDirectoryEntry& entry, MemoryMappedIO::MemoryMappedSpan<unsigned char> record)
+	{
+		std::uint32_t signature;
+		if (record.size() < sizeof(signature))
+		{
+			return Unexpected{ ErrorCode::BadDebugDirectory };
+		}
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(record.data(), signature);
+		std::shared_ptr<PdbDebugInfo> info{ new PdbDebugInfo{} };
+		Result<std::string_view> path;
+		switch (signature)
+		{
+		case CODEVIEW_RSDS_SIGNATURE:
+		{
+			if (record.size() < sizeof(CodeViewRsdsHeader))
+			{
+				return Unexpected{ ErrorCode::BadDebugDirectory };
+			}
+			CodeViewRsdsHeader header;
+			Memory::ReadStruct<PE_COFF_ENDIANNESS>(record.data(), header);
+			info->_format = CodeViewFormat::Rsds;
+			info->_guid = header.PdbGuid;
+			info->_age = header.Age;
+			path = PathAfter(record, sizeof(CodeViewRsdsHeader));
+			break;
+		}
+		case CODEVIEW_NB10_SIGNATURE:
+		{
+			if (record.size() < sizeof(CodeViewNb10Header))
+			{
+				return Unexpected{ ErrorCode::BadDebugDirectory };
+			}
+			CodeViewNb10Header header;
+			Memory::ReadStruct<PE_COFF_ENDIANNESS>(record.data(), header);
+			info->_format = CodeViewFormat::Nb10;
+			info->_pdbSignature = header.PdbSignature;
+			info->_age = header.Age;
+			path = PathAfter(record, sizeof(CodeViewNb10Header));
+			break;
+		}
+		default:
+			return Unexpected{ ErrorCode::BadDebugDirectory };
+		}
+		if (!path)
+		{
+			return Unexpected{ path.error() };
+		}
+		info->_pdbPath = *path;
+		info->_portable = info->_format == CodeViewFormat::Rsds && entry.MinorVersion == PORTABLE_PDB_CODEVIEW_MINOR_VERSION;
+		info->_record = std::move(record);
+		return info;
+	}
+
+	DebugInfoType PdbDebugInfo::type() const
+	{
+		return _portable ? DebugInfoType::PortablePdb : DebugInfoType::Pdb;
+	}
+
+	std::string PdbDebugInfo::SymbolServerKey() const
+	{
+		// 32 digits of a GUID, 8 of the age and a null
+		char key[32 + 8 + 1];
+		int length;
+		if (_format == CodeViewFormat::Nb10)
+		{
+			length = std::snprintf(key, sizeof(key), "%08X%X", _pdbSignature, _age);
+		}
+		else
+		{
+			length = std::snprintf(key, sizeof(key), "%08X%04X%04X", _guid.Data1, _guid.Data2, _guid.Data3);
+			for (std::uint8_t byte : _guid.Data4)
+			{
+				length += std::snprintf(key + length, sizeof(key) - length, "%02X", byte);
+			}
+			length += _portable
+				? std::snprintf(key + length, sizeof(key) - length, "FFFFFFFF")
+				: std::snprintf(key + length, sizeof(key) - length, "%X", _age);
+		}
+		return std::string(key, static_cast<std::size_t>(length));
+	}
+	#pragma endregion
+
+	#pragma region PogoInfo
+	PogoInfo::PogoInfo() noexcept
+		: _data{}
+	{
+	}
+
+	PogoInfo::PogoInfo(MemoryMappedIO::MemoryMappedSpan<unsigned char> data) noexcept
+		: _data{ std::move(data) }
+	{
+	}
+
+	std::uint32_t PogoInfo::signature() const noexcept
+	{
+		std::uint32_t signature{};
+		if (_data.size() >= sizeof(signature))
+		{
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(_data.data(), signature);
+		}
+		return signature;
+	}
+
+	Result<std::vector<PogoEntry>> PogoInfo::entries() const
+	{
+		// After the signature: an RVA, a size and a null-terminated name padded to a dword boundary
+		constexpr std::size_t ENTRY_HEADER_LENGTH = 2 * sizeof(std::uint32_t);
+		std::vector<PogoEntry> entries;
+		std::size_t position = sizeof(std::uint32_t);
+		while (position + ENTRY_HEADER_LENGTH < _data.size())
+		{
+			PogoEntry entry;
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(_data.data() + position, entry.rva);
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(_data.data() + position + sizeof(std::uint32_t), entry.size);
+			position += ENTRY_HEADER_LENGTH;
+			const char* name = reinterpret_cast<const char*>(_data.data() + position);
+			const void* terminator = std::memchr(name, '\0', _data.size() - position);
+			if (terminator == nullptr)
+			{
+				return Unexpected{ ErrorCode::BadDebugDirectory };
+			}
+			entry.name = std::string_view{ name, static_cast<const char*>(terminator) };
+			position += Memory::AlignAddress(entry.name.size() + 1, sizeof(std::uint32_t));
+			entries.push_back(entry);
+		}
+		return entries;
+	}
+	#pragma endregion
+
+	#pragma region DebugDirectory
+	DebugDirectory::DebugDirectory() noexcept
+		: _exe{},
+		_entries{}
+	{
+	}
+
+	Result<DebugDirectory> DebugDirectory::Create(const PeExecutable& exe)
+	{
+		DebugDirectory directory;
+		directory._exe = &exe;
+		const DataDirectory& debug = exe.dataDirectory(DataDirectoryIndex::Debug);
+		std::size_t length = debug.Size / sizeof(DebugDirectoryEntry) * sizeof(DebugDirectoryEntry);
+		if (debug.VirtualAddress == 0 || length == 0)
+		{
+			return directory;
+		}
+		// Only the entries are mapped, not the whole section
+		Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> entries = exe.ViewAtRva(debug.VirtualAddress, length);
+		if (!entries)
+		{
+			return Unexpected{ entries.error() };
+		}
+		directory._entries = std::move(*entries);
+		return directory;
+	}
+
+	Result<DebugDirectoryEntry> DebugDirectory::Find(std::uint32_t type) const
+	{
+		for (std::size_t i = 0; i < size(); i++)
+		{
+			DebugDirectoryEntry entry = (*this)[i];
+			if (entry.Type == type)
+			{
+				return entry;
+			}
+		}
+		return Unexpected{ ErrorCode::DebugInfoNotFound };
+	}
+
+	Result<std::uint64_t> DebugDirectory::DataOffset(const DebugDirectoryEntry& entry) const
+	{
+		if (entry.PointerToRawData != 0)
+		{
+			return entry.PointerToRawData;
+		}
+		if (entry.AddressOfRawData != 0)
+		{
+			return _exe->RvaToOffset(entry.AddressOfRawData);
+		}
+		return Unexpected{ ErrorCode::BadDebugDirectory };
+	}
+
+	Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> DebugDirectory::DataOf(const DebugDirectoryEntry& entry, std::size_t maximumLength) const
+	{
+		std::size_t length = std::min<std::size_t>(entry.SizeOfData, maximumLength);
+		if (length == 0)
+		{
+			return MemoryMappedIO::MemoryMappedSpan<unsigned char>{};
+		}
+		Result<std::uint64_t> offset = DataOffset(entry);
+		if (!offset)
+		{
+			return Unexpected{ offset.error() };
+		}
+		return _exe->file().TryView<unsigned char>(*offset, length);
+	}
+
+	Result<std::shared_ptr<PdbDebugInfo>> DebugDirectory::FindPdb() const
+	{
+		Result<DebugDirectoryEntry> entry = Find(IMAGE_DEBUG_TYPE_CODEVIEW);
+		if (!entry)
+		{
+			return Unexpected{ entry.error() };
+		}
+		Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> record = DataOf(*entry, CODEVIEW_RECORD_MAXIMUM_LENGTH);
+		if (!record)
+		{
+			return Unexpected{ record.error() };
+		}
+		return PdbDebugInfo::Parse(*entry, std::move(*record));
+	}
+
+	Result<PogoInfo> DebugDirectory::FindPogo() const
+	{
+		Result<DebugDirectoryEntry> entry = Find(IMAGE_DEBUG_TYPE_POGO);
+		if (!entry)
+		{
+			return Unexpected{ entry.error() };
+		}
+		Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> data = DataOf(*entry);
+		if (!data)
+		{
+			return Unexpected{ data.error() };
+		}
+		return PogoInfo{ std::move(*data) };
+	}
+
+	bool DebugDirectory::reproducible() const
+	{
+		return Find(IMAGE_DEBUG_TYPE_REPRO).has_value();
+	}
+
+	Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> DebugDirectory::FindReproHash() const
+	{
+		Result<DebugDirectoryEntry> entry = Find(IMAGE_DEBUG_TYPE_REPRO);
+		if (!entry)
+		{
+			return Unexpected{ entry.error() };
+		}
+		if (entry->SizeOfData == 0)
+		{
+			return MemoryMappedIO::MemoryMappedSpan<unsigned char>{};
+		}
+		std::uint32_t hashLength;
+		if (entry->SizeOfData < sizeof(hashLength))
+		{
+			return Unexpected{ ErrorCode::BadDebugDirectory };
+		}
+		Result<std::uint64_t> offset = DataOffset(*entry);
+		if (!offset)
+		{
+			return Unexpected{ offset.error() };
+		}
+		Result<std::uint32_t> length = _exe->file().TryRead<PE_COFF_ENDIANNESS, std::uint32_t>(*offset);
+		if (!length)
+		{
+			return Unexpected{ length.error() };
+		}
+		hashLength = *length;
+		if (hashLength > entry->SizeOfData - sizeof(hashLength))
+		{
+			return Unexpected{ ErrorCode::BadDebugDirectory };
+		}
+		return _exe->file().TryView<unsigned char>(*offset + sizeof(hashLength), hashLength);
+	}
+	#pragma endregion
+}
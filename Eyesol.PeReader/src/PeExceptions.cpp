@@ -0,0 +1,282 @@
+#include "PeExceptions.hpp"
+#include "PeParser.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		// VersionAndFlags, SizeOfProlog, CountOfCodes and FrameRegisterAndOffset
+		constexpr std::size_t X64_UNWIND_INFO_HEADER_LENGTH = 4;
+		constexpr std::size_t X64_UNWIND_CODE_LENGTH = 2;
+
+		// Packed unwind data with this flag is reserved
+		constexpr std::uint32_t ARM64_PACKED_RESERVED_FLAG = 3;
+
+		// Lengths of ARM64 functions are stored in instructions
+		constexpr std::uint32_t ARM64_INSTRUCTION_LENGTH = 4;
+		// Frame sizes of packed unwind data are stored in 16-byte units
+		constexpr std::uint32_t ARM64_FRAME_SIZE_UNIT = 16;
+
+		std::uint32_t Arm64XdataFunctionLength(std::uint32_t header)
+		{
+			return (header & 0x3FFFF) * ARM64_INSTRUCTION_LENGTH;
+		}
+
+		std::uint32_t Arm64PackedFunctionLength(std::uint32_t unwindData)
+		{
+			return (unwindData >> 2 & 0x7FF) * ARM64_INSTRUCTION_LENGTH;
+		}
+	}
+	#pragma endregion
+
+	ExceptionDirectory::ExceptionDirectory() noexcept
+		: _exe{},
+		_entries{},
+		_entryLength{ sizeof(Amd64RuntimeFunctionEntry) }
+	{
+	}
+
+	Result<ExceptionDirectory> ExceptionDirectory::Create(const PeExecutable& exe)
+	{
+		ExceptionDirectory directory;
+		directory._exe = &exe;
+		const DataDirectory& exception = exe.dataDirectory(DataDirectoryIndex::Exception);
+		if (exception.VirtualAddress == 0 || exception.Size == 0)
+		{
+			return directory;
+		}
+		switch (exe.coffHeader().Machine)
+		{
+		case IMAGE_FILE_MACHINE_AMD64:
+			directory._entryLength = sizeof(Amd64RuntimeFunctionEntry);
+			break;
+		case IMAGE_FILE_MACHINE_ARM64:
+			directory._entryLength = sizeof(Arm64RuntimeFunctionEntry);
+			break;
+		default:
+			return Unexpected{ ErrorCode::NotImplemented };
+		}
+		std::size_t length = exception.Size / directory._entryLength * directory._entryLength;
+		Result<std::span<const unsigned char>> entries = exe.BytesAtRva(exception.VirtualAddress, length);
+		if (!entries)
+		{
+			return Unexpected{ entries.error() };
+		}
+		directory._entries = *entries;
+		// Lookups rely on the order, which the loader assumes too. A single pass is cheap next to a wrong answer
+		for (std::size_t i = 1; i < directory.size(); i++)
+		{
+			if (directory.BeginAt(i) < directory.BeginAt(i - 1))
+			{
+				return Unexpected{ ErrorCode::BadExceptionDirectory };
+			}
+		}
+		return directory;
+	}
+
+	Result<std::size_t> ExceptionDirectory::FindFunctionIndex(std::uint32_t rva) const
+	{
+		std::size_t count = size();
+		if (count == 0)
+		{
+			return Unexpected{ ErrorCode::FunctionNotFound };
+		}
+		// The last entry starting at or before the RVA. Samples make the comparisons unpredictable,
+		// so the half is selected by a conditional move instead of a branch
+		std::size_t first = 0;
+		while (count > 1)
+		{
+			std::size_t half = count / 2;
+			first = BeginAt(first + half) <= rva ? first + half : first;
+			count -= half;
+		}
+		RuntimeFunction function = (*this)[first];
+		if (function.beginAddress > rva)
+		{
+			return Unexpected{ ErrorCode::FunctionNotFound };
+		}
+		Result<std::uint32_t> end = FunctionEnd(function);
+		if (!end)
+		{
+			return Unexpected{ end.error() };
+		}
+		if (rva >= *end)
+		{
+			return Unexpected{ ErrorCode::FunctionNotFound };
+		}
+		return first;
+	}
+
+	Result<RuntimeFunction> ExceptionDirectory::FindFunction(std::uint32_t rva) const
+	{
+		Result<std::size_t> index = FindFunctionIndex(rva);
+		if (!index)
+		{
+			return Unexpected{ index.error() };
+		}
+		return (*this)[*index];
+	}
+
+	Result<std::uint32_t> ExceptionDirectory::FunctionEnd(const RuntimeFunction& function) const
+	{
+		if (_entryLength == sizeof(Amd64RuntimeFunctionEntry))
+		{
+			return function.endAddress;
+		}
+		if ((function.unwindData & 3) != 0)
+		{
+			return function.beginAddress + Arm64PackedFunctionLength(function.unwindData);
+		}
+		Result<std::span<const unsigned char>> header = _exe->BytesAtRva(function.unwindData, sizeof(std::uint32_t));
+		if (!header)
+		{
+			return Unexpected{ header.error() };
+		}
+		std::uint32_t headerWord;
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(header->data(), headerWord);
+		return function.beginAddress + Arm64XdataFunctionLength(headerWord);
+	}
+
+	Result<X64UnwindInfo> ExceptionDirectory::GetX64UnwindInfo(const RuntimeFunction& function) const
+	{
+		if (_entryLength != sizeof(Amd64RuntimeFunctionEntry))
+		{
+			return Unexpected{ ErrorCode::NotImplemented };
+		}
+		std::uint32_t rva = function.unwindData;
+		if ((rva & RUNTIME_FUNCTION_INDIRECT) != 0)
+		{
+			// The entry shares the unwind info of another one
+			Result<std::span<const unsigned char>> entry = _exe->BytesAtRva(rva & ~RUNTIME_FUNCTION_INDIRECT, sizeof(Amd64RuntimeFunctionEntry));
+			if (!entry)
+			{
+				return Unexpected{ entry.error() };
+			}
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(entry->data() + offsetof(Amd64RuntimeFunctionEntry, UnwindInfoAddress), rva);
+			if ((rva & RUNTIME_FUNCTION_INDIRECT) != 0)
+			{
+				return Unexpected{ ErrorCode::BadExceptionDirectory };
+			}
+		}
+		Result<std::span<const unsigned char>> bytes = _exe->RawBytesFromRva(rva);
+		if (!bytes)
+		{
+			return Unexpected{ bytes.error() };
+		}
+		if (bytes->size() < X64_UNWIND_INFO_HEADER_LENGTH)
+		{
+			return Unexpected{ ErrorCode::BadExceptionDirectory };
+		}
+		const unsigned char* data = bytes->data();
+		X64UnwindInfo info{};
+		info.version = data[0] & 0x07;
+		info.flags = data[0] >> 3;
+		info.sizeOfProlog = data[1];
+		std::uint8_t codesCount = data[2];
+		info.frameRegister = data[3] & 0x0F;
+		info.frameOffset = data[3] >> 4;
+		// The slots are padded to an even count, so the trailing data is dword aligned
+		std::size_t position = X64_UNWIND_INFO_HEADER_LENGTH + (codesCount + 1u) / 2 * 2 * X64_UNWIND_CODE_LENGTH;
+		if (bytes->size() < position)
+		{
+			return Unexpected{ ErrorCode::BadExceptionDirectory };
+		}
+		info.unwindCodes = bytes->subspan(X64_UNWIND_INFO_HEADER_LENGTH, codesCount * X64_UNWIND_CODE_LENGTH);
+		if ((info.flags & UNW_FLAG_CHAININFO) != 0)
+		{
+			if (bytes->size() - position < sizeof(Amd64RuntimeFunctionEntry))
+			{
+				return Unexpected{ ErrorCode::BadExceptionDirectory };
+			}
+			Amd64RuntimeFunctionEntry chained;
+			Memory::ReadStruct<PE_COFF_ENDIANNESS>(data + position, chained);
+			info.chained = RuntimeFunction{ chained.BeginAddress, chained.EndAddress, chained.UnwindInfoAddress };
+		}
+		else if ((info.flags & (UNW_FLAG_EHANDLER | UNW_FLAG_UHANDLER)) != 0)
+		{
+			if (bytes->size() - position < sizeof(std::uint32_t))
+			{
+				return Unexpected{ ErrorCode::BadExceptionDirectory };
+			}
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(data + position, info.exceptionHandler);
+			info.handlerData = rva + static_cast<std::uint32_t>(position + sizeof(std::uint32_t));
+		}
+		return info;
+	}
+
+	Result<Arm64UnwindInfo> ExceptionDirectory::GetArm64UnwindInfo(const RuntimeFunction& function) const
+	{
+		if (_entryLength != sizeof(Arm64RuntimeFunctionEntry))
+		{
+			return Unexpected{ ErrorCode::NotImplemented };
+		}
+		Arm64UnwindInfo info{};
+		std::uint32_t unwindData = function.unwindData;
+		if ((unwindData & 3) != 0)
+		{
+			if ((unwindData & 3) == ARM64_PACKED_RESERVED_FLAG)
+			{
+				return Unexpected{ ErrorCode::BadExceptionDirectory };
+			}
+			info.packed = true;
+			info.flag = static_cast<std::uint8_t>(unwindData & 3);
+			info.functionLength = Arm64PackedFunctionLength(unwindData);
+			info.regF = static_cast<std::uint8_t>(unwindData >> 13 & 0x7);
+			info.regI = static_cast<std::uint8_t>(unwindData >> 16 & 0xF);
+			info.homesParameters = (unwindData >> 20 & 1) != 0;
+			info.cr = static_cast<std::uint8_t>(unwindData >> 21 & 0x3);
+			info.frameSize = static_cast<std::uint16_t>((unwindData >> 23 & 0x1FF) * ARM64_FRAME_SIZE_UNIT);
+			return info;
+		}
+
+		Result<std::span<const unsigned char>> bytes = _exe->RawBytesFromRva(unwindData);
+		if (!bytes)
+		{
+			return Unexpected{ bytes.error() };
+		}
+		if (bytes->size() < sizeof(std::uint32_t))
+		{
+			return Unexpected{ ErrorCode::BadExceptionDirectory };
+		}
+		std::uint32_t header;
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(bytes->data(), header);
+		info.functionLength = Arm64XdataFunctionLength(header);
+		info.version = static_cast<std::uint8_t>(header >> 18 & 0x3);
+		info.hasExceptionData = (header >> 20 & 1) != 0;
+		info.singleEpilog = (header >> 21 & 1) != 0;
+		info.epilogCount = static_cast<std::uint16_t>(header >> 22 & 0x1F);
+		std::size_t codeWords = header >> 27;
+		std::size_t position = sizeof(std::uint32_t);
+		if (info.epilogCount == 0 && codeWords == 0)
+		{
+			// Counts too large for the header are in the extension word
+			if (bytes->size() < 2 * sizeof(std::uint32_t))
+			{
+				return Unexpected{ ErrorCode::BadExceptionDirectory };
+			}
+			std::uint32_t extension;
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(bytes->data() + position, extension);
+			info.epilogCount = static_cast<std::uint16_t>(extension);
+			codeWords = extension >> 16 & 0xFF;
+			position += sizeof(std::uint32_t);
+		}
+		std::size_t scopesLength = info.singleEpilog ? 0 : info.epilogCount * sizeof(std::uint32_t);
+		std::size_t codesLength = codeWords * sizeof(std::uint32_t);
+		std::size_t handlerLength = info.hasExceptionData ? sizeof(std::uint32_t) : 0;
+		if (bytes->size() - position < scopesLength + codesLength + handlerLength)
+		{
+			return Unexpected{ ErrorCode::BadExceptionDirectory };
+		}
+		info.epilogScopes = bytes->subspan(position, scopesLength);
+		position += scopesLength;
+		info.unwindCodes = bytes->subspan(position, codesLength);
+		position += codesLength;
+		if (info.hasExceptionData)
+		{
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(bytes->data() + position, info.exceptionHandler);
+			info.handlerData = unwindData + static_cast<std::uint32_t>(position + sizeof(std::uint32_t));
+		}
+		return info;
+	}
+}
@@ -0,0 +1,237 @@
+#include <limits>
+#include "PeExports.hpp"
+#include "PeParser.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		// Each table is a single view, so lookups don't translate RVAs
+		Result<std::span<const unsigned char>> TableView(const PeExecutable& exe, std::uint32_t rva, std::uint32_t count, std::size_t entryLength)
+		{
+			if (count == 0)
+			{
+				return std::span<const unsigned char>{};
+			}
+			if (count > std::numeric_limits<std::size_t>::max() / entryLength)
+			{
+				return Unexpected{ ErrorCode::BadExportDirectory };
+			}
+			return exe.BytesAtRva(rva, count * entryLength);
+		}
+
+		template <typename T>
+		T TableEntry(std::span<const unsigned char> table, std::size_t index)
+		{
+			T entry;
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(table.data() + index * sizeof(T), entry);
+			return entry;
+		}
+	}
+	#pragma endregion
+
+	ExportDirectory::ExportDirectory() noexcept
+		: _exe{},
+		_table{},
+		_name{},
+		_directoryRva{},
+		_directorySize{},
+		_functions{},
+		_names{},
+		_nameOrdinals{}
+	{
+	}
+
+	Result<ExportDirectory> ExportDirectory::Create(const PeExecutable& exe)
+	{
+		ExportDirectory exports;
+		const DataDirectory& directory = exe.dataDirectory(DataDirectoryIndex::Export);
+		if (directory.VirtualAddress == 0)
+		{
+			return exports;
+		}
+		exports._exe = &exe;
+		exports._directoryRva = directory.VirtualAddress;
+		exports._directorySize = directory.Size;
+
+		Result<std::span<const unsigned char>> tableBytes = exe.BytesAtRva(directory.VirtualAddress, sizeof(ExportDirectoryTable));
+		if (!tableBytes)
+		{
+			return Unexpected{ tableBytes.error() };
+		}
+		ExportDirectoryTable& table = exports._table;
+		Memory::ReadStruct<PE_COFF_ENDIANNESS>(tableBytes->data(), table);
+
+		Result<std::span<const unsigned char>> functions = TableView(exe, table.AddressOfFunctions, table.NumberOfFunctions, sizeof(std::uint32_t));
+		if (!functions)
+		{
+			return Unexpected{ functions.error() };
+		}
+		Result<std::span<const unsigned char>> names = TableView(exe, table.AddressOfNames, table.NumberOfNames, sizeof(std::uint32_t));
+		if (!names)
+		{
+			return Unexpected{ names.error() };
+		}
+		Result<std::span<const unsigned char>> nameOrdinals = TableView(exe, table.AddressOfNameOrdinals, table.NumberOfNames, sizeof(std::uint16_t));
+		if (!nameOrdinals)
+		{
+			return Unexpected{ nameOrdinals.error() };
+		}
+		exports._functions = *functions;
+		exports._names = *names;
+		exports._nameOrdinals = *nameOrdinals;
+
+		if (table.Name != 0)
+		{
+			Result<std::string_view> name = exe.StringAtRva(table.Name);
+			if (!name)
+			{
+				return Unexpected{ name.error() };
+			}
+			exports._name = *name;
+		}
+		return exports;
+	}
+
+	Result<ExportedFunction> ExportDirectory::FindExport(std::string_view name) const
+	{
+		std::size_t low = 0;
+		std::size_t high = namesCount();
+		while (low < high)
+		{
+			std::size_t middle = low + (high - low) / 2;
+			Result<std::string_view> candidate = NameAt(middle);
+			if (!candidate)
+			{
+				return Unexpected{ candidate.error() };
+			}
+			// char_traits<char> compares characters as unsigned, which matches the table order
+			int comparison = candidate->compare(name);
+			if (comparison == 0)
+			{
+				return NamedExportAt(middle);
+			}
+			if (comparison < 0)
+			{
+				low = middle + 1;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+		return Unexpected{ ErrorCode::ExportNotFound };
+	}
+
+	Result<ExportedFunction> ExportDirectory::FindExport(std::uint32_t ordinal) const
+	{
+		if (ordinal < _table.Base)
+		{
+			return Unexpected{ ErrorCode::ExportNotFound };
+		}
+		return ExportAt(ordinal - _table.Base);
+	}
+
+	Result<ExportedFunction> ExportDirectory::ExportAt(std::size_t functionIndex) const
+	{
+		if (functionIndex >= functionsCount())
+		{
+			return Unexpected{ ErrorCode::ExportNotFound };
+		}
+		ExportedFunction function{};
+		function.rva = TableEntry<std::uint32_t>(_functions, functionIndex);
+		if (function.rva == 0)
+		{
+			return Unexpected{ ErrorCode::ExportNotFound };
+		}
+		function.ordinal = _table.Base + static_cast<std::uint32_t>(functionIndex);
+		if (function.rva - _directoryRva < _directorySize)
+		{
+			Result<std::string_view> forwarder = _exe->StringAtRva(function.rva);
+			if (!forwarder)
+			{
+				return Unexpected{ forwarder.error() };
+			}
+			function.forwarder = *forwarder;
+		}
+		return function;
+	}
+
+	Result<ExportedFunction> ExportDirectory::NamedExportAt(std::size_t nameIndex) const
+	{
+		Result<std::string_view> name = NameAt(nameIndex);
+		if (!name)
+		{
+			return Unexpected{ name.error() };
+		}
+		std::uint16_t functionIndex = TableEntry<std::uint16_t>(_nameOrdinals, nameIndex);
+		Result<ExportedFunction> function = ExportAt(functionIndex);
+		if (!function)
+		{
+			// A name must refer to a used entry of the address table
+			return Unexpected{ function.error() == ErrorCode::ExportNotFound ? ErrorCode::BadExportDirectory : function.error() };
+		}
+		function->name = *name;
+		return function;
+	}
+
+	Result<std::string_view> ExportDirectory::NameAt(std::size_t nameIndex) const
+	{
+		if (nameIndex >= namesCount())
+		{
+			return Unexpected{ ErrorCode::ExportNotFound };
+		}
+		return _exe->StringAtRva(TableEntry<std::uint32_t>(_names, nameIndex));
+	}
+
+	#pragma region Iterator
+	ExportDirectory::Iterator::Iterator() noexcept
+		: _owner{},
+		_index{},
+		_current{},
+		_byName{},
+		_done{ true }
+	{
+	}
+
+	ExportDirectory::Iterator::Iterator(const ExportDirectory* owner, bool byName)
+		: _owner{ owner },
+		_index{},
+		_current{},
+		_byName{ byName },
+		_done{}
+	{
+		Load();
+	}
+
+	ExportDirectory::Iterator& ExportDirectory::Iterator::operator++()
+	{
+		// An error is the last element
+		if (!_current)
+		{
+			_done = true;
+		}
+		else
+		{
+			_index++;
+			Load();
+		}
+		return *this;
+	}
+
+	void ExportDirectory::Iterator::Load()
+	{
+		std::size_t count = _byName ? _owner->namesCount() : _owner->functionsCount();
+		for (; _index < count; _index++)
+		{
+			_current = _byName ? _owner->NamedExportAt(_index) : _owner->ExportAt(_index);
+			if (_current || _current.error() != ErrorCode::ExportNotFound)
+			{
+				return;
+			}
+		}
+		_done = true;
+	}
+	#pragma endregion
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "PeImage.hpp"
+#include "PeParser.hpp"
+#include "Runtime.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	PeImage::PeImage() noexcept
+		: _memory{},
+		_size{},
+		_mappedBytes{},
+		_copiedBytes{}
+	{
+	}
+
+	Result<PeImage> PeImage::Create(const PeExecutable& exe)
+	{
+		std::uint64_t imageSize = exe.optionalHeader().SizeOfImage;
+		if (imageSize == 0)
+		{
+			return Unexpected{ ErrorCode::BadOptionalHeader };
+		}
+		// The last page is allocated whole, so a file view may cover it
+		std::size_t granularity = Runtime::AllocationGranularity();
+		std::uint64_t memoryLength = (imageSize + granularity - 1) / granularity * granularity;
+		if (memoryLength > std::numeric_limits<std::size_t>::max())
+		{
+			return Unexpected{ ErrorCode::OutOfMemory };
+		}
+		Result<MemoryMappedIO::PrivateMemory> memory = MemoryMappedIO::PrivateMemory::Allocate(static_cast<std::size_t>(memoryLength));
+		if (!memory)
+		{
+			return Unexpected{ memory.error() };
+		}
+		PeImage image;
+		image._memory = std::move(*memory);
+		image._size = static_cast<std::size_t>(imageSize);
+
+		const MemoryMappedIO::MemoryMappedFile& file = exe.file();
+		const SectionIndex& index = exe.sectionIndex();
+		// Intervals are sorted, and the ones beyond SizeOfImage are not mapped by the loader
+		std::size_t intervalCount = 0;
+		while (intervalCount < index.size() && index.intervalStart(intervalCount) < imageSize)
+		{
+			intervalCount++;
+		}
+		// Views are mapped first, as mapping one may clear the memory around it
+		std::vector<std::size_t> mappedLengths(intervalCount);
+		for (std::size_t i = 0; i < intervalCount; i++)
+		{
+			std::uint64_t start = index.intervalStart(i);
+			FileLocation raw = index.rawData(i);
+			std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(raw.Length, imageSize - start));
+			// Whole pages are mapped, a partial last page is copied, as the file bytes after it must not get into the image
+			std::size_t pages = length / granularity * granularity;
+			if (pages != 0 && start % granularity == 0 && raw.AbsoluteOffset % granularity == 0)
+			{
+				Result<bool> viewMapped = image._memory.TryMapFile(static_cast<std::size_t>(start), file, raw.AbsoluteOffset, pages);
+				if (!viewMapped)
+				{
+					return Unexpected{ viewMapped.error() };
+				}
+				if (*viewMapped)
+				{
+					mappedLengths[i] = pages;
+				}
+			}
+		}
+		for (std::size_t i = 0; i < intervalCount; i++)
+		{
+			std::uint64_t start = index.intervalStart(i);
+			FileLocation raw = index.rawData(i);
+			std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(raw.Length, imageSize - start));
+			std::size_t mapped = mappedLengths[i];
+			std::size_t copied = length - mapped;
+			if (copied != 0)
+			{
+				Result<std::size_t> bytesRead = file.TryRead(image._memory.data(), image._size, raw.AbsoluteOffset + mapped, static_cast<std::size_t>(start) + mapped, copied);
+				if (!bytesRead)
+				{
+					return Unexpected{ bytesRead.error() };
+				}
+				if (*bytesRead < copied)
+				{
+					return Unexpected{ ErrorCode::TruncatedData };
+				}
+			}
+			image._mappedBytes += mapped;
+			image._copiedBytes += copied;
+		}
+		return image;
+	}
+}
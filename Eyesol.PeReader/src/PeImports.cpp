@@ -0,0 +1,322 @@
+#include <charconv>
+#include "PeImports.hpp"
+#include "PeParser.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		constexpr char ToLowerAscii(char c)
+		{
+			return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+		}
+
+		bool EqualsIgnoreCase(std::string_view left, std::string_view right)
+		{
+			return left.size() == right.size()
+				&& std::equal(left.begin(), left.end(), right.begin(), [](char l, char r) { return ToLowerAscii(l) == ToLowerAscii(r); });
+		}
+
+		// Lowercases through a small buffer, so names of any length are hashed without allocations
+		void UpdateLowercase(Hashing::Md5& md5, std::string_view str)
+		{
+			char buf[64];
+			while (!str.empty())
+			{
+				std::size_t chunkLength = std::min(str.size(), sizeof(buf));
+				std::transform(str.begin(), str.begin() + chunkLength, buf, ToLowerAscii);
+				md5.Update({ buf, chunkLength });
+				str.remove_prefix(chunkLength);
+			}
+		}
+
+		// pefile strips only these extensions
+		std::string_view ImpHashModuleName(std::string_view name)
+		{
+			std::size_t dot = name.rfind('.');
+			if (dot == std::string_view::npos)
+			{
+				return name;
+			}
+			std::string_view extension = name.substr(dot + 1);
+			if (EqualsIgnoreCase(extension, "dll") || EqualsIgnoreCase(extension, "ocx") || EqualsIgnoreCase(extension, "sys"))
+			{
+				return name.substr(0, dot);
+			}
+			return name;
+		}
+	}
+	#pragma endregion
+
+	#pragma region ImportedFunctions
+	ImportedFunctions::ImportedFunctions() noexcept
+		: _exe{},
+		_thunks{},
+		_iatRva{},
+		_pe32Plus{}
+	{
+	}
+
+	ImportedFunctions::ImportedFunctions(const PeExecutable& exe, std::uint32_t lookupTableRva, std::uint32_t iatRva)
+		: _exe{ &exe },
+		_thunks{ exe.RawBytesFromRva(lookupTableRva) },
+		_iatRva{ iatRva },
+		_pe32Plus{ exe.optionalHeader().IsPe32Plus() }
+	{
+	}
+
+	ImportedFunctions::Iterator::Iterator() noexcept
+		: _owner{},
+		_index{},
+		_current{},
+		_done{ true }
+	{
+	}
+
+	ImportedFunctions::Iterator::Iterator(const ImportedFunctions* owner)
+		: _owner{ owner },
+		_index{},
+		_current{},
+		_done{ owner->_exe == nullptr }
+	{
+		if (!_done)
+		{
+			Load();
+		}
+	}
+
+	ImportedFunctions::Iterator& ImportedFunctions::Iterator::operator++()
+	{
+		// An error is the last element
+		if (!_current)
+		{
+			_done = true;
+		}
+		else
+		{
+			_index++;
+			Load();
+		}
+		return *this;
+	}
+
+	void ImportedFunctions::Iterator::Load()
+	{
+		const Result<std::span<const unsigned char>>& thunks = _owner->_thunks;
+		if (!thunks)
+		{
+			_current = Unexpected{ thunks.error() };
+			return;
+		}
+		std::size_t thunkLength = _owner->_pe32Plus ? sizeof(std::uint64_t) : sizeof(std::uint32_t);
+		if (thunks->size() / thunkLength <= _index)
+		{
+			_current = Unexpected{ ErrorCode::TruncatedData };
+			return;
+		}
+		const unsigned char* ptr = thunks->data() + _index * thunkLength;
+		std::uint64_t thunk;
+		bool byOrdinal;
+		if (_owner->_pe32Plus)
+		{
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(ptr, thunk);
+			byOrdinal = (thunk & IMAGE_ORDINAL_FLAG64) != 0;
+		}
+		else
+		{
+			std::uint32_t thunk32;
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(ptr, thunk32);
+			thunk = thunk32;
+			byOrdinal = (thunk32 & IMAGE_ORDINAL_FLAG32) != 0;
+		}
+		if (thunk == 0)
+		{
+			_done = true;
+			return;
+		}
+
+		ImportedFunction function{};
+		function.iatRva = _owner->_iatRva + static_cast<std::uint32_t>(_index * thunkLength);
+		if (byOrdinal)
+		{
+			function.byOrdinal = true;
+			function.ordinal = static_cast<std::uint16_t>(thunk);
+			_current = function;
+			return;
+		}
+		// The hint/name entry RVA takes 31 bits, the others must be zero
+		if (thunk > 0x7FFFFFFF)
+		{
+			_current = Unexpected{ ErrorCode::BadImportDirectory };
+			return;
+		}
+		std::uint32_t hintNameRva = static_cast<std::uint32_t>(thunk);
+		Result<std::span<const unsigned char>> hint = _owner->_exe->BytesAtRva(hintNameRva, sizeof(function.hint));
+		if (!hint)
+		{
+			_current = Unexpected{ hint.error() };
+			return;
+		}
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(hint->data(), function.hint);
+		Result<std::string_view> name = _owner->_exe->StringAtRva(hintNameRva + sizeof(function.hint));
+		if (!name)
+		{
+			_current = Unexpected{ name.error() };
+			return;
+		}
+		function.name = *name;
+		_current = function;
+	}
+	#pragma endregion
+
+	#pragma region ImportedModule
+	ImportedModule::ImportedModule() noexcept
+		: _exe{},
+		_descriptor{},
+		_name{}
+	{
+	}
+
+	ImportedModule::ImportedModule(const PeExecutable& exe, const ImportDescriptor& descriptor, std::string_view name)
+		: _exe{ &exe },
+		_descriptor{ descriptor },
+		_name{ name }
+	{
+	}
+
+	ImportedFunctions ImportedModule::functions() const
+	{
+		if (_exe == nullptr)
+		{
+			return {};
+		}
+		std::uint32_t lookupTableRva = _descriptor.OriginalFirstThunk != 0 ? _descriptor.OriginalFirstThunk : _descriptor.FirstThunk;
+		return { *_exe, lookupTableRva, _descriptor.FirstThunk };
+	}
+	#pragma endregion
+
+	#pragma region ImportDirectory
+	ImportDirectory::ImportDirectory(const PeExecutable& exe, StringPool& pool)
+		: _exe{ &exe },
+		_pool{ &pool },
+		_descriptors{}
+	{
+		const DataDirectory& directory = exe.dataDirectory(DataDirectoryIndex::Import);
+		if (directory.VirtualAddress != 0)
+		{
+			_descriptors = exe.RawBytesFromRva(directory.VirtualAddress);
+		}
+	}
+
+	ImportDirectory::Iterator::Iterator() noexcept
+		: _owner{},
+		_index{},
+		_current{},
+		_done{ true }
+	{
+	}
+
+	ImportDirectory::Iterator::Iterator(const ImportDirectory* owner)
+		: _owner{ owner },
+		_index{},
+		_current{},
+		// Section data is never empty, so an empty span means there is no directory
+		_done{ owner->_descriptors && owner->_descriptors->empty() }
+	{
+		if (!_done)
+		{
+			Load();
+		}
+	}
+
+	ImportDirectory::Iterator& ImportDirectory::Iterator::operator++()
+	{
+		// An error is the last element
+		if (!_current)
+		{
+			_done = true;
+		}
+		else
+		{
+			_index++;
+			Load();
+		}
+		return *this;
+	}
+
+	void ImportDirectory::Iterator::Load()
+	{
+		const Result<std::span<const unsigned char>>& descriptors = _owner->_descriptors;
+		if (!descriptors)
+		{
+			_current = Unexpected{ descriptors.error() };
+			return;
+		}
+		if (descriptors->size() / sizeof(ImportDescriptor) <= _index)
+		{
+			_current = Unexpected{ ErrorCode::TruncatedData };
+			return;
+		}
+		ImportDescriptor descriptor;
+		Memory::ReadStruct<PE_COFF_ENDIANNESS>(descriptors->data() + _index * sizeof(ImportDescriptor), descriptor);
+		if (descriptor.terminates())
+		{
+			_done = true;
+			return;
+		}
+		Result<std::string_view> name = _owner->_exe->StringAtRva(descriptor.Name);
+		if (!name)
+		{
+			_current = Unexpected{ name.error() };
+			return;
+		}
+		_current = ImportedModule{ *_owner->_exe, descriptor, _owner->_pool->Intern(*name) };
+	}
+
+	Result<Hashing::Md5::Digest> ImportDirectory::ImpHash() const
+	{
+		Hashing::Md5 md5;
+		bool first = true;
+		for (const Result<ImportedModule>& module : *this)
+		{
+			if (!module)
+			{
+				return Unexpected{ module.error() };
+			}
+			std::string_view moduleName = ImpHashModuleName(module->name());
+			for (const Result<ImportedFunction>& function : module->functions())
+			{
+				if (!function)
+				{
+					return Unexpected{ function.error() };
+				}
+				if (!function->byOrdinal && function->name.empty())
+				{
+					continue;
+				}
+				if (!first)
+				{
+					md5.Update(",");
+				}
+				first = false;
+				UpdateLowercase(md5, moduleName);
+				md5.Update(".");
+				if (function->byOrdinal)
+				{
+					// pefile resolves ordinals of a few system modules to names, they are hashed as numbers here
+					char ordinal[8];
+					std::to_chars_result converted = std::to_chars(std::begin(ordinal), std::end(ordinal), function->ordinal);
+					md5.Update("ord");
+					md5.Update(std::string_view{ ordinal, converted.ptr });
+				}
+				else
+				{
+					UpdateLowercase(md5, function->name);
+				}
+			}
+		}
+		return md5.Final();
+	}
+	#pragma endregion
+}
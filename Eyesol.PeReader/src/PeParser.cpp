@@ -1,44 +1,260 @@
+#include <cstring>
 #include "PeParser.hpp"
 #include "Exceptions.hpp"
 
 namespace Eyesol::Executables::Pe
 {
-	struct PeParseContext : Mz::MzParseContext
+	#pragma region nameless namespace
+	namespace
 	{
+		Cpu::ArchType ArchFromMachine(std::uint16_t machine)
+		{
+			switch (machine)
+			{
+			case IMAGE_FILE_MACHINE_I386:
+				return Cpu::ArchType::X86_32;
+			case IMAGE_FILE_MACHINE_AMD64:
+				return Cpu::ArchType::X86_64;
+			case IMAGE_FILE_MACHINE_ARM:
+			case IMAGE_FILE_MACHINE_THUMB:
+			case IMAGE_FILE_MACHINE_ARMNT:
+				return Cpu::ArchType::Arm32;
+			case IMAGE_FILE_MACHINE_ARM64:
+				return Cpu::ArchType::Arm64;
+			case IMAGE_FILE_MACHINE_IA64:
+				return Cpu::ArchType::Ia64;
+			default:
+				return Cpu::ArchType::Unknown;
+			}
+		}
 
-	};
+		ExecutableType TypeFromCharacteristics(std::uint16_t characteristics)
+		{
+			return (characteristics & IMAGE_FILE_DLL) != 0 ? ExecutableType::DynamicLib : ExecutableType::Executable;
+		}
+
+		// Decodes an optional header as stored in the file, and zero-extends PE32 fields
+		template <typename RawOptionalHeader>
+		void DecodeOptionalHeader(const unsigned char* ptr, OptionalHeader& header)
+		{
+			RawOptionalHeader raw;
+			Memory::ReadStruct<PE_COFF_ENDIANNESS>(ptr, raw);
+			header.Magic = raw.Magic;
+			header.MajorLinkerVersion = raw.MajorLinkerVersion;
+			header.MinorLinkerVersion = raw.MinorLinkerVersion;
+			header.SizeOfCode = raw.SizeOfCode;
+			header.SizeOfInitializedData = raw.SizeOfInitializedData;
+			header.SizeOfUninitializedData = raw.SizeOfUninitializedData;
+			header.AddressOfEntryPoint = raw.AddressOfEntryPoint;
+			header.BaseOfCode = raw.BaseOfCode;
+			if constexpr (requires { raw.BaseOfData; })
+			{
+				header.BaseOfData = raw.BaseOfData;
+			}
+			else
+			{
+				header.BaseOfData = 0;
+			}
+			header.ImageBase = raw.ImageBase;
+			header.SectionAlignment = raw.SectionAlignment;
+			header.FileAlignment = raw.FileAlignment;
+			header.MajorOperatingSystemVersion = raw.MajorOperatingSystemVersion;
+			header.MinorOperatingSystemVersion = raw.MinorOperatingSystemVersion;
+			header.MajorImageVersion = raw.MajorImageVersion;
+			header.MinorImageVersion = raw.MinorImageVersion;
+			header.MajorSubsystemVersion = raw.MajorSubsystemVersion;
+			header.MinorSubsystemVersion = raw.MinorSubsystemVersion;
+			header.Win32VersionValue = raw.Win32VersionValue;
+			header.SizeOfImage = raw.SizeOfImage;
+			header.SizeOfHeaders = raw.SizeOfHeaders;
+			header.CheckSum = raw.CheckSum;
+			header.Subsystem = raw.Subsystem;
+			header.DllCharacteristics = raw.DllCharacteristics;
+			header.SizeOfStackReserve = raw.SizeOfStackReserve;
+			header.SizeOfStackCommit = raw.SizeOfStackCommit;
+			header.SizeOfHeapReserve = raw.SizeOfHeapReserve;
+			header.SizeOfHeapCommit = raw.SizeOfHeapCommit;
+			header.LoaderFlags = raw.LoaderFlags;
+			header.NumberOfRvaAndSizes = raw.NumberOfRvaAndSizes;
+		}
+	}
+	#pragma endregion
+
+	PeParseContext::~PeParseContext() { }
+
+	PeParser::PeParser(ChecksumVerification checksumVerification) noexcept
+		: _checksumVerification{ checksumVerification }
+	{
+	}
 
 	std::unique_ptr<Mz::MzParseContext> PeParser::CreateParseContext() const
 	{
 		return std::make_unique<PeParseContext>();
 	}
 
-	bool PeParser::TryParseTypeAndFormat(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, Mz::MzDosHeader& header, Mz::MzParseContext* ctx) const
+	Result<void> PeParser::TryParseTypeAndFormat(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, Mz::MzDosHeader& header, Mz::MzParseContext* ctx) const
 	{
 		if (header.e_lfanew == 0)
 		{
-			return false;
+			return Unexpected{ ErrorCode::UnknownFormat };
 		}
-		std::uint32_t peSig;
-		file.Read<std::endian::little>(peSig, header.e_lfanew);
-		if (peSig == PE_SIGNATURE)
+		// Contexts are created by CreateParseContext
+		PeFileMetadata metadataLoc;
+		PeFileMetadata& metadata = ctx ? static_cast<PeParseContext*>(ctx)->peMetadata : metadataLoc;
+		Result<void> status = TryReadNtHeaders(file, probeBytes, header.e_lfanew, metadata);
+		if (!status)
 		{
-			if (ctx != nullptr)
+			return status;
+		}
+		if (ctx != nullptr)
+		{
+			ctx->format = metadata.optionalHeader.IsPe32Plus() ? ExecutableObjectFormat::Pe32Plus : ExecutableObjectFormat::Pe;
+			ctx->type = TypeFromCharacteristics(metadata.coffHeader.Characteristics);
+		}
+		return {};
+	}
+
+	Result<void> PeParser::TryReadNtHeaders(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, std::span<const unsigned char> probeBytes, std::uint32_t offset, PeFileMetadata& metadata)
+	{
+		std::uint64_t fileLength = file.length();
+		if (offset >= fileLength)
+		{
+			return Unexpected{ ErrorCode::OffsetOutOfRange };
+		}
+		// Everything decoded here is within this length, so only a page or two are touched
+		std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(PE_NT_HEADERS_MAXIMUM_LENGTH, fileLength - offset));
+		MemoryMappedIO::MemoryMappedFileRegion region;
+		const unsigned char* headers;
+		if (offset <= probeBytes.size() && length <= probeBytes.size() - offset)
+		{
+			headers = probeBytes.data() + offset;
+		}
+		else
+		{
+			std::size_t offsetInRegion;
+			Result<MemoryMappedIO::MemoryMappedFileRegion> mapped = file.TryMapRange(offset, length, offsetInRegion);
+			if (!mapped)
 			{
-				// Now implement easy, but incorrect format determination
-				ctx->format = ExecutableObjectFormat::Pe;
-				ctx->type = ExecutableType::Executable;
+				return Unexpected{ mapped.error() };
 			}
-			return true;
+			region = std::move(*mapped);
+			headers = region.data() + offsetInRegion;
+		}
+
+		std::uint32_t signature;
+		if (length < sizeof(signature))
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(headers, signature);
+		if (signature != PE_SIGNATURE)
+		{
+			return Unexpected{ ErrorCode::UnknownFormat };
+		}
+		std::size_t position = sizeof(signature);
+		if (length - position < sizeof(CoffFileHeader))
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		CoffFileHeader& coffHeader = metadata.coffHeader;
+		Memory::ReadStruct<PE_COFF_ENDIANNESS>(headers + position, coffHeader);
+		position += sizeof(CoffFileHeader);
+
+		std::uint16_t magic;
+		if (coffHeader.SizeOfOptionalHeader < sizeof(magic))
+		{
+			return Unexpected{ ErrorCode::BadOptionalHeader };
+		}
+		if (length - position < sizeof(magic))
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(headers + position, magic);
+		std::size_t fixedPartLength;
+		switch (magic)
+		{
+		case IMAGE_NT_OPTIONAL_HDR32_MAGIC:
+			fixedPartLength = sizeof(OptionalHeader32);
+			break;
+		case IMAGE_NT_OPTIONAL_HDR64_MAGIC:
+			fixedPartLength = sizeof(OptionalHeader64);
+			break;
+		default:
+			return Unexpected{ ErrorCode::BadOptionalHeader };
+		}
+		if (coffHeader.SizeOfOptionalHeader < fixedPartLength)
+		{
+			return Unexpected{ ErrorCode::BadOptionalHeader };
 		}
-		return false;
+		if (length - position < fixedPartLength)
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		OptionalHeader& optionalHeader = metadata.optionalHeader;
+		if (magic == IMAGE_NT_OPTIONAL_HDR32_MAGIC)
+		{
+			DecodeOptionalHeader<OptionalHeader32>(headers + position, optionalHeader);
+		}
+		else
+		{
+			DecodeOptionalHeader<OptionalHeader64>(headers + position, optionalHeader);
+		}
+		position += fixedPartLength;
+
+		// Like the loader, ignore directories beyond the optional header and the 16th one
+		std::size_t directoriesCount = std::min<std::size_t>(
+			{
+				optionalHeader.NumberOfRvaAndSizes,
+				(coffHeader.SizeOfOptionalHeader - fixedPartLength) / sizeof(DataDirectory),
+				IMAGE_NUMBEROF_DIRECTORY_ENTRIES
+			});
+		if (length - position < directoriesCount * sizeof(DataDirectory))
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		metadata.dataDirectories = {};
+		for (std::size_t i = 0; i < directoriesCount; i++)
+		{
+			Memory::ReadStruct<PE_COFF_ENDIANNESS>(headers + position + i * sizeof(DataDirectory), metadata.dataDirectories[i]);
+		}
+		metadata.dataDirectoriesCount = static_cast<std::uint32_t>(directoriesCount);
+		metadata.ntHeadersLoc = { offset, sizeof(signature) + sizeof(CoffFileHeader) + coffHeader.SizeOfOptionalHeader };
+		// The section table follows the optional header, whatever its declared length is
+		metadata.sectionTableLoc = { metadata.ntHeadersLoc.AbsoluteOffset + metadata.ntHeadersLoc.Length, static_cast<std::size_t>(coffHeader.NumberOfSections) * sizeof(SectionHeader) };
+		return {};
 	}
 
-	std::shared_ptr<Mz::MzExecutable> PeParser::ParseExecutable(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, Mz::MzParseContext& ctx) const
+	Result<std::shared_ptr<Mz::MzExecutable>> PeParser::ParseExecutable(const Eyesol::MemoryMappedIO::MemoryMappedFile& file, Mz::MzParseContext& ctx) const
 	{
 		PeParseContext& peCtx = static_cast<PeParseContext&>(ctx);
-
-		throw NotImplementedException{};
+		// Headers are already decoded by TryParseTypeAndFormat
+		const FileLocation& sectionTableLoc = peCtx.peMetadata.sectionTableLoc;
+		Result<SectionTable> sections = file.TryView<PE_COFF_ENDIANNESS, SectionHeader>(sectionTableLoc.AbsoluteOffset, sectionTableLoc.Length / sizeof(SectionHeader));
+		if (!sections)
+		{
+			return Unexpected{ sections.error() };
+		}
+		peCtx.sectionIndex = SectionIndex{ *sections, peCtx.peMetadata.optionalHeader, file.length() };
+		const DataDirectory& comDescriptor = peCtx.peMetadata.dataDirectory(DataDirectoryIndex::ComDescriptor);
+		if (comDescriptor.VirtualAddress != 0 && comDescriptor.Size != 0)
+		{
+			// A header, which cannot be read, is ignored like the loader does, so the image is still parsed as native
+			unsigned char bytes[sizeof(Cor20Header)];
+			if (peCtx.sectionIndex.ReadAtRva(file, comDescriptor.VirtualAddress, bytes, sizeof(bytes)))
+			{
+				Cor20Header header;
+				Memory::ReadStruct<PE_COFF_ENDIANNESS>(bytes, header);
+				peCtx.clrHeader = header;
+			}
+		}
+		std::shared_ptr<PeExecutable> exe = std::make_shared<PeExecutable>();
+		exe->init(file, std::move(peCtx));
+		if (_checksumVerification == ChecksumVerification::Eager)
+		{
+			// The result is kept by the executable. Errors are reported by its accessors too
+			static_cast<void>(exe->actualChecksum());
+		}
+		return std::shared_ptr<Mz::MzExecutable>{ std::move(exe) };
 	}
 
 	std::uint32_t PeParser::CalculateActualMzDataLength(const MemoryMappedIO::MemoryMappedFile& file, uint32_t precalculatedLength, const Mz::MzParseContext& ctx) const
@@ -46,8 +262,251 @@ namespace Eyesol::Executables::Pe
 		return ctx.header.e_lfanew;
 	}
 
-	void PeExecutable::init(MemoryMappedIO::MemoryMappedFile file, PeParseContext& ctx)
+	ExecutableObjectFormat PeExecutable::format() const
+	{
+		if (_clrHeader)
+		{
+			return (_clrHeader->Flags & COMIMAGE_FLAGS_ILONLY) != 0 ? ExecutableObjectFormat::DotNetAssembly : ExecutableObjectFormat::DotNetMixedAssembly;
+		}
+		return _peMetadata.optionalHeader.IsPe32Plus() ? ExecutableObjectFormat::Pe32Plus : ExecutableObjectFormat::Pe;
+	}
+
+	ExecutableType PeExecutable::type() const
+	{
+		return TypeFromCharacteristics(_peMetadata.coffHeader.Characteristics);
+	}
+
+	Eyesol::Cpu::ArchType PeExecutable::arch() const
+	{
+		return ArchFromMachine(_peMetadata.coffHeader.Machine);
+	}
+
+	uint64_t PeExecutable::length() const
+	{
+		return metadata().fullFileLength;
+	}
+
+	Result<std::span<const unsigned char>> PeExecutable::BytesAtRva(std::uint32_t rva, std::size_t length) const
+	{
+		Result<std::span<const unsigned char>> bytes = RawBytesFromRva(rva);
+		if (!bytes)
+		{
+			return bytes;
+		}
+		if (length > bytes->size())
+		{
+			// Tells zero-filled data from data outside of the image
+			Result<RvaLocation> location = _sectionIndex.Locate(rva);
+			return Unexpected{ length > location->virtualLength ? ErrorCode::RvaOutOfImage : ErrorCode::RvaNotInFile };
+		}
+		return bytes->first(length);
+	}
+
+	Result<std::span<const unsigned char>> PeExecutable::RawBytesFromRva(std::uint32_t rva) const
+	{
+		Result<RvaLocation> location = _sectionIndex.Locate(rva);
+		if (!location)
+		{
+			return Unexpected{ location.error() };
+		}
+		if (location->rawLength == 0)
+		{
+			return Unexpected{ ErrorCode::RvaNotInFile };
+		}
+		Result<std::span<const unsigned char>> data = intervalData(location->interval);
+		if (!data)
+		{
+			return data;
+		}
+		std::size_t offsetInData = static_cast<std::size_t>(location->fileOffset - _sectionIndex.rawData(location->interval).AbsoluteOffset);
+		return data->subspan(offsetInData, location->rawLength);
+	}
+
+	Result<std::string_view> PeExecutable::StringAtRva(std::uint32_t rva) const
+	{
+		Result<std::span<const unsigned char>> bytes = RawBytesFromRva(rva);
+		if (!bytes)
+		{
+			return Unexpected{ bytes.error() };
+		}
+		const char* str = reinterpret_cast<const char*>(bytes->data());
+		const void* terminator = std::memchr(str, '\0', bytes->size());
+		if (terminator == nullptr)
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		return std::string_view{ str, static_cast<const char*>(terminator) };
+	}
+
+	ImportDirectory PeExecutable::imports(StringPool& pool) const
+	{
+		return ImportDirectory{ *this, pool };
+	}
+
+	Result<ExportDirectory> PeExecutable::exports() const
+	{
+		return ExportDirectory::Create(*this);
+	}
+
+	RelocationDirectory PeExecutable::relocations() const
+	{
+		return RelocationDirectory{ *this };
+	}
+
+	Result<ExceptionDirectory> PeExecutable::exceptions() const
+	{
+		return ExceptionDirectory::Create(*this);
+	}
+
+	Result<PeImage> PeExecutable::MapImage() const
+	{
+		return PeImage::Create(*this);
+	}
+
+	ResourceTree PeExecutable::resources(std::size_t budget) const
+	{
+		return ResourceTree{ *this, budget };
+	}
+
+	Result<VersionInfo> PeExecutable::GetVersionInfo() const
+	{
+		// A version resource has three levels, so a tiny budget suffices
+		constexpr std::size_t VERSION_LOOKUP_BUDGET = 64;
+		ResourceTree tree{ *this, VERSION_LOOKUP_BUDGET };
+		Result<ResourceData> data = tree.FindFirstOfType(RT_VERSION);
+		if (!data)
+		{
+			return Unexpected{ data.error() };
+		}
+		return VersionInfo::Parse(data->bytes);
+	}
+
+	Result<DebugDirectory> PeExecutable::debugDirectory() const
+	{
+		return DebugDirectory::Create(*this);
+	}
+
+	bool PeExecutable::ContainsDebugInfo() const
+	{
+		Result<DebugDirectory> directory = debugDirectory();
+		return directory && directory->FindPdb().has_value();
+	}
+
+	std::shared_ptr<DebugInfo> PeExecutable::GetDebugInfo() const
+	{
+		Result<DebugDirectory> directory = debugDirectory();
+		if (!directory)
+		{
+			ThrowError(directory.error());
+		}
+		Result<std::shared_ptr<PdbDebugInfo>> pdb = directory->FindPdb();
+		if (!pdb)
+		{
+			ThrowError(pdb.error());
+		}
+		return std::move(*pdb);
+	}
+
+	Result<ClrMetadata> PeExecutable::clrMetadata() const
+	{
+		return ClrMetadata::Create(*this);
+	}
+
+	AuthenticodeDigest PeExecutable::AuthenticodeHash(Hashing::HashAlgorithm algorithm) const
+	{
+		return ComputeAuthenticodeHash(*this, algorithm);
+	}
+
+	Result<std::uint32_t> PeExecutable::actualChecksum() const
+	{
+		std::call_once(_checksumComputed, [this]()
+			{
+				_actualChecksum = ComputePeChecksum(file(), _peMetadata.checkSumOffset());
+			});
+		return _actualChecksum;
+	}
+
+	Result<std::optional<bool>> PeExecutable::checksumValid() const
+	{
+		std::uint32_t expected = _peMetadata.optionalHeader.CheckSum;
+		if (expected == 0)
+		{
+			return std::optional<bool>{};
+		}
+		Result<std::uint32_t> actual = actualChecksum();
+		if (!actual)
+		{
+			return Unexpected{ actual.error() };
+		}
+		return std::optional<bool>{ *actual == expected };
+	}
+
+	FileLocation PeExecutable::overlay() const
+	{
+		std::uint64_t fileLength = file().length();
+		std::uint64_t imageEnd = _peMetadata.optionalHeader.SizeOfHeaders;
+		for (const SectionHeader& section : sections())
+		{
+			if (section.SizeOfRawData != 0)
+			{
+				imageEnd = std::max<std::uint64_t>(imageEnd, std::uint64_t{ section.PointerToRawData } + section.SizeOfRawData);
+			}
+		}
+		imageEnd = std::min(imageEnd, fileLength);
+		return { imageEnd, static_cast<std::size_t>(fileLength - imageEnd) };
+	}
+
+	Result<std::vector<Analysis::ByteHistogram>> PeExecutable::SectionHistograms() const
+	{
+		std::uint64_t fileLength = file().length();
+		std::vector<Analysis::ByteHistogram> histograms;
+		histograms.reserve(_peMetadata.coffHeader.NumberOfSections);
+		for (const SectionHeader& section : sections())
+		{
+			std::uint64_t offset = std::min<std::uint64_t>(section.PointerToRawData, fileLength);
+			std::uint64_t length = std::min<std::uint64_t>(section.SizeOfRawData, fileLength - offset);
+			Result<Analysis::ByteHistogram> histogram = Analysis::ComputeHistogram(file(), offset, length);
+			if (!histogram)
+			{
+				return Unexpected{ histogram.error() };
+			}
+			histograms.push_back(*histogram);
+		}
+		return histograms;
+	}
+
+	Result<Analysis::ByteHistogram> PeExecutable::OverlayHistogram() const
+	{
+		FileLocation location = overlay();
+		return Analysis::ComputeHistogram(file(), location.AbsoluteOffset, location.Length);
+	}
+
+	Result<std::span<const unsigned char>> PeExecutable::intervalData(std::size_t interval) const
+	{
+		IntervalData& entry = _intervalsData[interval];
+		std::call_once(entry.mapped, [this, interval, &entry]()
+			{
+				// Raw data of intervals is limited by the file length, so only a mapping failure is an error.
+				// Offsets of intervals without data may be anywhere
+				FileLocation loc = _sectionIndex.rawData(interval);
+				if (loc.Length != 0)
+				{
+					entry.data = file().TryView<unsigned char>(loc.AbsoluteOffset, loc.Length);
+				}
+			});
+		if (!entry.data)
+		{
+			return Unexpected{ entry.data.error() };
+		}
+		return std::span<const unsigned char>{ *entry.data };
+	}
+
+	void PeExecutable::init(MemoryMappedIO::MemoryMappedFile file, PeParseContext&& ctx)
 	{
-		MzExecutable::init(std::move(file), ctx);
+		_peMetadata = ctx.peMetadata;
+		_sectionIndex = std::move(ctx.sectionIndex);
+		_intervalsData = std::make_unique<IntervalData[]>(_sectionIndex.size());
+		_clrHeader = ctx.clrHeader;
+		MzExecutable::init(std::move(file), std::move(ctx));
 	}
-}
\ No newline at end of file
+}
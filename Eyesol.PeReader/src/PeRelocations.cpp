@@ -0,0 +1,248 @@
+#include <cstring>
+#include "PeRelocations.hpp"
+#include "PeParser.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		std::uint16_t EntryType(std::uint16_t entry)
+		{
+			return static_cast<std::uint16_t>(entry >> 12);
+		}
+
+		std::uint16_t EntryAt(const unsigned char* entries, std::size_t index)
+		{
+			std::uint16_t entry;
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(entries + index * sizeof(entry), entry);
+			return entry;
+		}
+
+		// OR of differences from the type. A single reduction without early exits, so compilers vectorize it
+		bool AllOfType(const unsigned char* entries, std::size_t count, std::uint16_t type)
+		{
+			std::uint16_t mismatch = 0;
+			for (std::size_t i = 0; i < count; i++)
+			{
+				mismatch |= EntryType(EntryAt(entries, i)) ^ type;
+			}
+			return mismatch == 0;
+		}
+
+		template <typename T>
+		void AddDelta(unsigned char* ptr, T delta)
+		{
+			T value;
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(ptr, value);
+			Memory::UnalignedWrite<PE_COFF_ENDIANNESS>(ptr, static_cast<T>(value + delta));
+		}
+
+		// The caller checked types of the entries and that the whole page is within the image
+		template <typename T>
+		void AddDeltaToPage(unsigned char* page, const unsigned char* entries, std::size_t count, T delta)
+		{
+			for (std::size_t i = 0; i < count; i++)
+			{
+				AddDelta<T>(page + (EntryAt(entries, i) & 0x0FFF), delta);
+			}
+		}
+
+		bool FitsImage(std::span<unsigned char> image, std::uint64_t rva, std::size_t length)
+		{
+			return rva <= image.size() && length <= image.size() - rva;
+		}
+
+		// Any entry type, with bounds checks of every target
+		Result<void> ApplyEntries(const RelocationBlock& block, std::span<unsigned char> image, std::uint64_t delta)
+		{
+			std::uint32_t delta32 = static_cast<std::uint32_t>(delta);
+			for (std::size_t i = 0; i < block.size(); i++)
+			{
+				std::uint16_t entry = block.rawEntry(i);
+				std::uint16_t type = EntryType(entry);
+				std::uint64_t rva = static_cast<std::uint64_t>(block.pageRva()) + (entry & 0x0FFF);
+				std::size_t length;
+				switch (type)
+				{
+				case IMAGE_REL_BASED_ABSOLUTE:
+					continue;
+				case IMAGE_REL_BASED_HIGH:
+				case IMAGE_REL_BASED_LOW:
+				case IMAGE_REL_BASED_HIGHADJ:
+					length = sizeof(std::uint16_t);
+					break;
+				case IMAGE_REL_BASED_HIGHLOW:
+					length = sizeof(std::uint32_t);
+					break;
+				case IMAGE_REL_BASED_DIR64:
+					length = sizeof(std::uint64_t);
+					break;
+				default:
+					return Unexpected{ ErrorCode::UnsupportedRelocation };
+				}
+				if (!FitsImage(image, rva, length))
+				{
+					return Unexpected{ ErrorCode::RvaOutOfImage };
+				}
+				unsigned char* ptr = image.data() + rva;
+				std::uint16_t halfword;
+				switch (type)
+				{
+				case IMAGE_REL_BASED_HIGH:
+					Memory::UnalignedRead<PE_COFF_ENDIANNESS>(ptr, halfword);
+					Memory::UnalignedWrite<PE_COFF_ENDIANNESS>(ptr, static_cast<std::uint16_t>(((static_cast<std::uint32_t>(halfword) << 16) + delta32) >> 16));
+					break;
+				case IMAGE_REL_BASED_LOW:
+					AddDelta<std::uint16_t>(ptr, static_cast<std::uint16_t>(delta32));
+					break;
+				case IMAGE_REL_BASED_HIGHADJ:
+				{
+					// The next entry holds the low half, which is added with rounding
+					if (++i >= block.size())
+					{
+						return Unexpected{ ErrorCode::BadRelocationDirectory };
+					}
+					std::int16_t low = static_cast<std::int16_t>(block.rawEntry(i));
+					Memory::UnalignedRead<PE_COFF_ENDIANNESS>(ptr, halfword);
+					std::uint32_t value = (static_cast<std::uint32_t>(halfword) << 16) + static_cast<std::uint32_t>(static_cast<std::int32_t>(low));
+					value += delta32 + 0x8000;
+					Memory::UnalignedWrite<PE_COFF_ENDIANNESS>(ptr, static_cast<std::uint16_t>(value >> 16));
+					break;
+				}
+				case IMAGE_REL_BASED_HIGHLOW:
+					AddDelta<std::uint32_t>(ptr, delta32);
+					break;
+				default:
+					AddDelta<std::uint64_t>(ptr, delta);
+					break;
+				}
+			}
+			return {};
+		}
+	}
+	#pragma endregion
+
+	Result<void> ApplyRelocationBlock(const RelocationBlock& block, std::span<unsigned char> image, std::uint64_t delta)
+	{
+		const unsigned char* entries = block.entries().data();
+		std::size_t count = block.size();
+		// Blocks are padded to 4 bytes by an ABSOLUTE entry
+		while (count != 0 && EntryType(EntryAt(entries, count - 1)) == IMAGE_REL_BASED_ABSOLUTE)
+		{
+			count--;
+		}
+		if (count == 0)
+		{
+			return {};
+		}
+		std::uint16_t type = EntryType(EntryAt(entries, 0));
+		bool batched = (type == IMAGE_REL_BASED_HIGHLOW || type == IMAGE_REL_BASED_DIR64)
+			&& FitsImage(image, block.pageRva(), BASE_RELOCATION_PAGE_SIZE + sizeof(std::uint64_t))
+			&& AllOfType(entries, count, type);
+		if (!batched)
+		{
+			return ApplyEntries(block, image, delta);
+		}
+		unsigned char* page = image.data() + block.pageRva();
+		if (type == IMAGE_REL_BASED_HIGHLOW)
+		{
+			AddDeltaToPage<std::uint32_t>(page, entries, count, static_cast<std::uint32_t>(delta));
+		}
+		else
+		{
+			AddDeltaToPage<std::uint64_t>(page, entries, count, delta);
+		}
+		return {};
+	}
+
+	Result<void> ApplyBaseRelocations(const RelocationDirectory& relocations, std::span<unsigned char> image, std::uint64_t oldBase, std::uint64_t newBase)
+	{
+		std::uint64_t delta = newBase - oldBase;
+		if (delta == 0)
+		{
+			return {};
+		}
+		for (const Result<RelocationBlock>& block : relocations)
+		{
+			if (!block)
+			{
+				return Unexpected{ block.error() };
+			}
+			Result<void> applied = ApplyRelocationBlock(*block, image, delta);
+			if (!applied)
+			{
+				return applied;
+			}
+		}
+		return {};
+	}
+
+	#pragma region RelocationDirectory
+	RelocationDirectory::RelocationDirectory(const PeExecutable& exe)
+		: _data{}
+	{
+		const DataDirectory& directory = exe.dataDirectory(DataDirectoryIndex::BaseRelocation);
+		if (!directory.empty())
+		{
+			_data = exe.BytesAtRva(directory.VirtualAddress, directory.Size);
+		}
+	}
+
+	RelocationDirectory::Iterator::Iterator() noexcept
+		: _owner{},
+		_offset{},
+		_current{},
+		_done{ true }
+	{
+	}
+
+	RelocationDirectory::Iterator::Iterator(const RelocationDirectory* owner)
+		: _owner{ owner },
+		_offset{},
+		_current{},
+		_done{}
+	{
+		Load();
+	}
+
+	RelocationDirectory::Iterator& RelocationDirectory::Iterator::operator++()
+	{
+		// An error is the last element
+		if (!_current)
+		{
+			_done = true;
+		}
+		else
+		{
+			Load();
+		}
+		return *this;
+	}
+
+	void RelocationDirectory::Iterator::Load()
+	{
+		const Result<std::span<const unsigned char>>& data = _owner->_data;
+		if (!data)
+		{
+			_current = Unexpected{ data.error() };
+			return;
+		}
+		// Trailing bytes shorter than a block header are ignored, like the loader does
+		if (data->size() - _offset < sizeof(BaseRelocationBlock))
+		{
+			_done = true;
+			return;
+		}
+		BaseRelocationBlock header;
+		Memory::ReadStruct<PE_COFF_ENDIANNESS>(data->data() + _offset, header);
+		if (header.SizeOfBlock < sizeof(BaseRelocationBlock) || header.SizeOfBlock > data->size() - _offset)
+		{
+			_current = Unexpected{ ErrorCode::BadRelocationDirectory };
+			return;
+		}
+		_current = RelocationBlock{ header.VirtualAddress, data->subspan(_offset + sizeof(BaseRelocationBlock), header.SizeOfBlock - sizeof(BaseRelocationBlock)) };
+		_offset += header.SizeOfBlock;
+	}
+	#pragma endregion
+}
@@ -0,0 +1,360 @@
+#include "PeResources.hpp"
+#include "PeParser.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		constexpr char16_t ToUpperAscii(char16_t c)
+		{
+			return c >= u'a' && c <= u'z' ? static_cast<char16_t>(c - u'a' + u'A') : c;
+		}
+
+		bool Fits(std::span<const unsigned char> data, std::uint64_t offset, std::uint64_t length)
+		{
+			return offset <= data.size() && length <= data.size() - offset;
+		}
+	}
+	#pragma endregion
+
+	#pragma region Utf16LeView
+	bool Utf16LeView::operator==(std::u16string_view str) const noexcept
+	{
+		if (size() != str.size())
+		{
+			return false;
+		}
+		for (std::size_t i = 0; i < str.size(); i++)
+		{
+			if ((*this)[i] != str[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool Utf16LeView::EqualsIgnoreCase(std::u16string_view str) const noexcept
+	{
+		if (size() != str.size())
+		{
+			return false;
+		}
+		for (std::size_t i = 0; i < str.size(); i++)
+		{
+			if (ToUpperAscii((*this)[i]) != ToUpperAscii(str[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::u16string Utf16LeView::str() const
+	{
+		std::u16string result(size(), u'\0');
+		for (std::size_t i = 0; i < result.size(); i++)
+		{
+			result[i] = (*this)[i];
+		}
+		return result;
+	}
+	#pragma endregion
+
+	#pragma region ResourceTree
+	ResourceTree::ResourceTree(const PeExecutable& exe, std::size_t budget)
+		: _exe{ &exe },
+		_data{ Unexpected{ ErrorCode::ResourceNotFound } },
+		_budget{ budget }
+	{
+		const DataDirectory& directory = exe.dataDirectory(DataDirectoryIndex::Resource);
+		if (directory.VirtualAddress != 0)
+		{
+			_data = exe.RawBytesFromRva(directory.VirtualAddress);
+		}
+	}
+
+	Result<ResourceDirectory> ResourceTree::root() const
+	{
+		return OpenDirectory(std::make_shared<ResourceWalkBudget>(_budget), ResourcePath{}, 0);
+	}
+
+	Result<ResourceData> ResourceTree::FindFirstOfType(std::uint32_t type) const
+	{
+		Result<ResourceDirectory> types = root();
+		if (!types)
+		{
+			return Unexpected{ types.error() };
+		}
+		Result<ResourceEntry> entry = types->FindEntry(type);
+		// Names, then languages
+		for (int level = 0; level < 2 && entry; level++)
+		{
+			Result<ResourceDirectory> directory = entry->directory();
+			if (!directory)
+			{
+				return Unexpected{ directory.error() };
+			}
+			entry = directory->EntryAt(0);
+		}
+		if (!entry)
+		{
+			return Unexpected{ entry.error() };
+		}
+		return entry->data();
+	}
+
+	Result<void> ResourceTree::Charge(ResourceWalkBudget& budget)
+	{
+		if (budget.remaining == 0)
+		{
+			return Unexpected{ ErrorCode::ResourceLimitExceeded };
+		}
+		budget.remaining--;
+		return {};
+	}
+
+	Result<ResourceDirectory> ResourceTree::OpenDirectory(const std::shared_ptr<ResourceWalkBudget>& budget, const ResourcePath& parentPath, std::uint32_t offset) const
+	{
+		if (!_data)
+		{
+			return Unexpected{ _data.error() };
+		}
+		// A subdirectory pointing to its ancestor would make the tree endless
+		if (parentPath.depth >= ResourcePath::MAXIMUM_DEPTH || parentPath.contains(offset))
+		{
+			return Unexpected{ ErrorCode::ResourceLimitExceeded };
+		}
+		Result<void> charged = Charge(*budget);
+		if (!charged)
+		{
+			return Unexpected{ charged.error() };
+		}
+		if (!Fits(*_data, offset, sizeof(ResourceDirectoryTable)))
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		ResourceDirectoryTable table;
+		Memory::ReadStruct<PE_COFF_ENDIANNESS>(_data->data() + offset, table);
+		std::uint64_t entriesLength = (static_cast<std::uint64_t>(table.NumberOfNamedEntries) + table.NumberOfIdEntries) * sizeof(ResourceDirectoryEntry);
+		if (!Fits(*_data, offset + sizeof(ResourceDirectoryTable), entriesLength))
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		ResourcePath path = parentPath;
+		path.offsets[path.depth++] = offset;
+		return ResourceDirectory{ *this, budget, path, table };
+	}
+
+	Result<ResourceEntry> ResourceTree::ReadEntry(const std::shared_ptr<ResourceWalkBudget>& budget, const ResourcePath& path, std::size_t index) const
+	{
+		Result<void> charged = Charge(*budget);
+		if (!charged)
+		{
+			return Unexpected{ charged.error() };
+		}
+		// The directory has been checked to contain all of its entries
+		std::size_t offset = path.offsets[path.depth - 1] + sizeof(ResourceDirectoryTable) + index * sizeof(ResourceDirectoryEntry);
+		ResourceDirectoryEntry entry;
+		Memory::ReadStruct<PE_COFF_ENDIANNESS>(_data->data() + offset, entry);
+		Result<ResourceName> name = ReadName(entry);
+		if (!name)
+		{
+			return Unexpected{ name.error() };
+		}
+		return ResourceEntry{ *this, budget, path, entry, *name };
+	}
+
+	Result<ResourceName> ResourceTree::ReadName(const ResourceDirectoryEntry& entry) const
+	{
+		ResourceName name{};
+		if (!entry.isNamed())
+		{
+			name.id = entry.Name;
+			return name;
+		}
+		// A length in UTF-16 code units, followed by the units
+		std::uint32_t offset = entry.nameOffset();
+		if (!Fits(*_data, offset, sizeof(std::uint16_t)))
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		std::uint16_t length;
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(_data->data() + offset, length);
+		if (!Fits(*_data, offset + sizeof(length), length * sizeof(char16_t)))
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		name.name = Utf16LeView{ _data->subspan(offset + sizeof(length), length * sizeof(char16_t)) };
+		name.isString = true;
+		return name;
+	}
+
+	Result<ResourceData> ResourceTree::ReadData(std::uint32_t offset) const
+	{
+		if (!Fits(*_data, offset, sizeof(ResourceDataEntry)))
+		{
+			return Unexpected{ ErrorCode::TruncatedData };
+		}
+		ResourceData data{};
+		Memory::ReadStruct<PE_COFF_ENDIANNESS>(_data->data() + offset, data.entry);
+		Result<std::span<const unsigned char>> bytes = _exe->BytesAtRva(data.entry.OffsetToData, data.entry.Size);
+		if (!bytes)
+		{
+			return Unexpected{ bytes.error() };
+		}
+		data.bytes = *bytes;
+		return data;
+	}
+	#pragma endregion
+
+	#pragma region ResourceEntry
+	ResourceEntry::ResourceEntry() noexcept
+		: _tree{},
+		_budget{},
+		_parentPath{},
+		_entry{},
+		_name{}
+	{
+	}
+
+	ResourceEntry::ResourceEntry(const ResourceTree& tree, const std::shared_ptr<ResourceWalkBudget>& budget, const ResourcePath& parentPath, const ResourceDirectoryEntry& entry, const ResourceName& name) noexcept
+		: _tree{ &tree },
+		_budget{ budget },
+		_parentPath{ parentPath },
+		_entry{ entry },
+		_name{ name }
+	{
+	}
+
+	Result<ResourceDirectory> ResourceEntry::directory() const
+	{
+		if (_tree == nullptr || !_entry.isDirectory())
+		{
+			return Unexpected{ ErrorCode::BadResourceDirectory };
+		}
+		return _tree->OpenDirectory(_budget, _parentPath, _entry.dataOffset());
+	}
+
+	Result<ResourceData> ResourceEntry::data() const
+	{
+		if (_tree == nullptr || _entry.isDirectory())
+		{
+			return Unexpected{ ErrorCode::BadResourceDirectory };
+		}
+		return _tree->ReadData(_entry.dataOffset());
+	}
+	#pragma endregion
+
+	#pragma region ResourceDirectory
+	ResourceDirectory::ResourceDirectory() noexcept
+		: _tree{},
+		_budget{},
+		_path{},
+		_table{}
+	{
+	}
+
+	ResourceDirectory::ResourceDirectory(const ResourceTree& tree, const std::shared_ptr<ResourceWalkBudget>& budget, const ResourcePath& path, const ResourceDirectoryTable& table) noexcept
+		: _tree{ &tree },
+		_budget{ budget },
+		_path{ path },
+		_table{ table }
+	{
+	}
+
+	Result<ResourceEntry> ResourceDirectory::EntryAt(std::size_t index) const
+	{
+		if (index >= size())
+		{
+			return Unexpected{ ErrorCode::ResourceNotFound };
+		}
+		return _tree->ReadEntry(_budget, _path, index);
+	}
+
+	Result<ResourceEntry> ResourceDirectory::FindEntry(std::uint32_t id) const
+	{
+		std::size_t low = _table.NumberOfNamedEntries;
+		std::size_t high = size();
+		while (low < high)
+		{
+			std::size_t middle = low + (high - low) / 2;
+			Result<ResourceEntry> entry = EntryAt(middle);
+			if (!entry)
+			{
+				return entry;
+			}
+			std::uint32_t candidate = entry->entry().Name;
+			if (candidate == id)
+			{
+				return entry;
+			}
+			if (candidate < id)
+			{
+				low = middle + 1;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+		return Unexpected{ ErrorCode::ResourceNotFound };
+	}
+
+	Result<ResourceEntry> ResourceDirectory::FindEntry(std::u16string_view name) const
+	{
+		for (std::size_t i = 0; i < _table.NumberOfNamedEntries; i++)
+		{
+			Result<ResourceEntry> entry = EntryAt(i);
+			if (!entry || entry->name().name.EqualsIgnoreCase(name))
+			{
+				return entry;
+			}
+		}
+		return Unexpected{ ErrorCode::ResourceNotFound };
+	}
+
+	ResourceDirectory::Iterator::Iterator() noexcept
+		: _owner{},
+		_index{},
+		_current{},
+		_done{ true }
+	{
+	}
+
+	ResourceDirectory::Iterator::Iterator(const ResourceDirectory* owner)
+		: _owner{ owner },
+		_index{},
+		_current{},
+		_done{}
+	{
+		Load();
+	}
+
+	ResourceDirectory::Iterator& ResourceDirectory::Iterator::operator++()
+	{
+		// An error is the last element
+		if (!_current)
+		{
+			_done = true;
+		}
+		else
+		{
+			_index++;
+			Load();
+		}
+		return *this;
+	}
+
+	void ResourceDirectory::Iterator::Load()
+	{
+		if (_owner->_tree == nullptr || _index >= _owner->size())
+		{
+			_done = true;
+			return;
+		}
+		_current = _owner->EntryAt(_index);
+	}
+	#pragma endregion
+}
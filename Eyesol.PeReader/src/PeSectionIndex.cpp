@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include "PeSectionIndex.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		struct Interval
+		{
+			std::uint32_t start;
+			std::uint64_t end;
+			std::uint64_t rawOffset;
+			std::uint64_t rawLength;
+			std::uint32_t section;
+		};
+
+		// Alignments, which are not a power of two, are ignored
+		std::uint64_t AlignUp(std::uint64_t value, std::uint32_t alignment)
+		{
+			if (!std::has_single_bit(alignment))
+			{
+				return value;
+			}
+			return (value + alignment - 1) & ~static_cast<std::uint64_t>(alignment - 1);
+		}
+
+		// Raw data is limited by the virtual size and by the end of the file
+		std::uint64_t ClampRawLength(std::uint64_t rawOffset, std::uint64_t rawLength, std::uint64_t virtualLength, std::uint64_t fileLength)
+		{
+			if (rawOffset >= fileLength)
+			{
+				return 0;
+			}
+			return std::min({ rawLength, virtualLength, fileLength - rawOffset });
+		}
+	}
+	#pragma endregion
+
+	SectionIndex::SectionIndex() noexcept
+		: _lastHit{}
+	{
+	}
+
+	SectionIndex::SectionIndex(const SectionTable& sections, const OptionalHeader& optionalHeader, std::uint64_t fileLength)
+		: _lastHit{}
+	{
+		std::vector<Interval> intervals;
+		intervals.reserve(sections.size() + 1);
+		std::uint32_t sectionIndex = 0;
+		for (const SectionHeader& section : sections)
+		{
+			std::uint32_t index = sectionIndex++;
+			std::uint64_t virtualSize = section.VirtualSize != 0 ? section.VirtualSize : section.SizeOfRawData;
+			std::uint64_t virtualLength = AlignUp(virtualSize, optionalHeader.SectionAlignment);
+			if (virtualLength == 0)
+			{
+				continue;
+			}
+			std::uint64_t rawOffset = section.PointerToRawData;
+			if (optionalHeader.FileAlignment >= SECTION_RAW_DATA_MINIMUM_ALIGNMENT)
+			{
+				rawOffset = rawOffset / SECTION_RAW_DATA_MINIMUM_ALIGNMENT * SECTION_RAW_DATA_MINIMUM_ALIGNMENT;
+			}
+			// Sections without raw data are zero-filled
+			std::uint64_t rawLength = section.PointerToRawData != 0 ? section.SizeOfRawData : 0;
+			intervals.push_back(
+				{
+					section.VirtualAddress,
+					section.VirtualAddress + virtualLength,
+					rawOffset,
+					ClampRawLength(rawOffset, rawLength, virtualLength, fileLength),
+					index
+				});
+		}
+		// The loader maps sections in ascending order, so a next section overrides an overlapped part
+		std::stable_sort(intervals.begin(), intervals.end(), [](const Interval& left, const Interval& right)
+			{
+				return left.start < right.start;
+			});
+		for (std::size_t i = 0; i + 1 < intervals.size(); i++)
+		{
+			Interval& current = intervals[i];
+			if (current.end > intervals[i + 1].start)
+			{
+				current.end = intervals[i + 1].start;
+				current.rawLength = std::min(current.rawLength, current.end - current.start);
+			}
+		}
+		std::erase_if(intervals, [](const Interval& interval)
+			{
+				return interval.end == interval.start;
+			});
+		// Headers occupy the image start up to the first section
+		std::uint64_t headersEnd = AlignUp(optionalHeader.SizeOfHeaders, optionalHeader.SectionAlignment);
+		if (!intervals.empty())
+		{
+			headersEnd = std::min<std::uint64_t>(headersEnd, intervals.front().start);
+		}
+		if (headersEnd != 0)
+		{
+			intervals.insert(intervals.begin(), { 0, headersEnd, 0, ClampRawLength(0, optionalHeader.SizeOfHeaders, headersEnd, fileLength), HEADERS_SECTION });
+		}
+
+		_starts.reserve(intervals.size());
+		_ends.reserve(intervals.size());
+		_rawOffsets.reserve(intervals.size());
+		_rawLengths.reserve(intervals.size());
+		_sections.reserve(intervals.size());
+		for (const Interval& interval : intervals)
+		{
+			_starts.push_back(interval.start);
+			_ends.push_back(interval.end);
+			_rawOffsets.push_back(interval.rawOffset);
+			// Not longer than the virtual length, which doesn't exceed 4 GiB for valid RVAs
+			_rawLengths.push_back(static_cast<std::uint32_t>(std::min<std::uint64_t>(interval.rawLength, std::numeric_limits<std::uint32_t>::max())));
+			_sections.push_back(interval.section);
+		}
+	}
+
+	SectionIndex::SectionIndex(const SectionIndex& other)
+		: _starts{ other._starts },
+		_ends{ other._ends },
+		_rawOffsets{ other._rawOffsets },
+		_rawLengths{ other._rawLengths },
+		_sections{ other._sections },
+		_lastHit{ other._lastHit.load(std::memory_order_relaxed) }
+	{
+	}
+
+	SectionIndex::SectionIndex(SectionIndex&& other) noexcept
+		: _starts{ std::move(other._starts) },
+		_ends{ std::move(other._ends) },
+		_rawOffsets{ std::move(other._rawOffsets) },
+		_rawLengths{ std::move(other._rawLengths) },
+		_sections{ std::move(other._sections) },
+		_lastHit{ other._lastHit.load(std::memory_order_relaxed) }
+	{
+	}
+
+	SectionIndex& SectionIndex::operator=(const SectionIndex& other)
+	{
+		_starts = other._starts;
+		_ends = other._ends;
+		_rawOffsets = other._rawOffsets;
+		_rawLengths = other._rawLengths;
+		_sections = other._sections;
+		_lastHit.store(other._lastHit.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		return *this;
+	}
+
+	SectionIndex& SectionIndex::operator=(SectionIndex&& other) noexcept
+	{
+		_starts = std::move(other._starts);
+		_ends = std::move(other._ends);
+		_rawOffsets = std::move(other._rawOffsets);
+		_rawLengths = std::move(other._rawLengths);
+		_sections = std::move(other._sections);
+		_lastHit.store(other._lastHit.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		return *this;
+	}
+
+	Result<RvaLocation> SectionIndex::Locate(std::uint32_t rva) const noexcept
+	{
+		// The hint may be stale after an assignment, so it is bounds checked
+		std::size_t i = _lastHit.load(std::memory_order_relaxed);
+		if (i >= _starts.size() || rva < _starts[i] || rva >= _ends[i])
+		{
+			auto it = std::upper_bound(_starts.begin(), _starts.end(), rva);
+			if (it == _starts.begin())
+			{
+				return Unexpected{ ErrorCode::RvaOutOfImage };
+			}
+			i = static_cast<std::size_t>(it - _starts.begin()) - 1;
+			if (rva >= _ends[i])
+			{
+				return Unexpected{ ErrorCode::RvaOutOfImage };
+			}
+			_lastHit.store(i, std::memory_order_relaxed);
+		}
+		std::uint32_t delta = rva - _starts[i];
+		RvaLocation location;
+		location.fileOffset = _rawOffsets[i] + delta;
+		location.rawLength = delta < _rawLengths[i] ? _rawLengths[i] - delta : 0;
+		location.virtualLength = static_cast<std::uint32_t>(std::min<std::uint64_t>(_ends[i] - rva, std::numeric_limits<std::uint32_t>::max()));
+		location.section = _sections[i];
+		location.interval = static_cast<std::uint32_t>(i);
+		return location;
+	}
+
+	Result<std::uint64_t> SectionIndex::RvaToOffset(std::uint32_t rva) const noexcept
+	{
+		Result<RvaLocation> location = Locate(rva);
+		if (!location)
+		{
+			return Unexpected{ location.error() };
+		}
+		if (location->rawLength == 0)
+		{
+			return Unexpected{ ErrorCode::RvaNotInFile };
+		}
+		return location->fileOffset;
+	}
+
+	Result<void> SectionIndex::ReadAtRva(const MemoryMappedIO::MemoryMappedFile& file, std::uint32_t rva, void* buf, std::size_t length) const
+	{
+		unsigned char* dst = static_cast<unsigned char*>(buf);
+		while (length != 0)
+		{
+			Result<RvaLocation> location = Locate(rva);
+			if (!location)
+			{
+				return Unexpected{ location.error() };
+			}
+			std::size_t chunkLength = std::min<std::size_t>(length, location->virtualLength);
+			std::size_t rawLength = std::min<std::size_t>(chunkLength, location->rawLength);
+			if (rawLength != 0)
+			{
+				Result<std::size_t> bytesRead = file.TryRead(dst, rawLength, location->fileOffset, 0, rawLength);
+				if (!bytesRead)
+				{
+					return Unexpected{ bytesRead.error() };
+				}
+				if (*bytesRead < rawLength)
+				{
+					return Unexpected{ ErrorCode::TruncatedData };
+				}
+			}
+			std::memset(dst + rawLength, 0, chunkLength - rawLength);
+			dst += chunkLength;
+			length -= chunkLength;
+			if (length != 0 && chunkLength > std::numeric_limits<std::uint32_t>::max() - rva)
+			{
+				return Unexpected{ ErrorCode::RvaOutOfImage };
+			}
+			rva += static_cast<std::uint32_t>(chunkLength);
+		}
+		return {};
+	}
+
+	Result<MemoryMappedIO::MemoryMappedSpan<unsigned char>> SectionIndex::ViewAtRva(const MemoryMappedIO::MemoryMappedFile& file, std::uint32_t rva, std::size_t length) const
+	{
+		Result<RvaLocation> location = Locate(rva);
+		if (!location)
+		{
+			return Unexpected{ location.error() };
+		}
+		if (length > location->virtualLength)
+		{
+			return Unexpected{ ErrorCode::RvaOutOfImage };
+		}
+		if (length > location->rawLength)
+		{
+			return Unexpected{ ErrorCode::RvaNotInFile };
+		}
+		return file.TryView<unsigned char>(location->fileOffset, length);
+	}
+}
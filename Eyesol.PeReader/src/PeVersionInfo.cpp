@@ -0,0 +1,271 @@
+#include "PeVersionInfo.hpp"
+
+namespace Eyesol::Executables::Pe
+{
+	#pragma region nameless namespace
+	namespace
+	{
+		// wLength, wValueLength and wType
+		constexpr std::size_t BLOCK_HEADER_LENGTH = 3 * sizeof(std::uint16_t);
+		// wType of blocks with text values, whose lengths are in characters
+		constexpr std::uint16_t BLOCK_TYPE_TEXT = 1;
+
+		// A version resource node: a header, a null-terminated key, a value and child blocks.
+		// Parts are aligned to 4 bytes from the start of the resource
+		struct Block
+		{
+			std::size_t end;
+			Utf16LeView key;
+			std::span<const unsigned char> value;
+			std::size_t childrenOffset;
+		};
+
+		constexpr std::size_t Align4(std::size_t offset)
+		{
+			return (offset + 3) & ~static_cast<std::size_t>(3);
+		}
+
+		Result<Block> ReadBlock(std::span<const unsigned char> data, std::size_t offset, std::size_t parentEnd)
+		{
+			if (offset > parentEnd || parentEnd - offset < BLOCK_HEADER_LENGTH)
+			{
+				return Unexpected{ ErrorCode::BadVersionInfo };
+			}
+			std::uint16_t length;
+			std::uint16_t valueLength;
+			std::uint16_t type;
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(data.data() + offset, length);
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(data.data() + offset + 2, valueLength);
+			Memory::UnalignedRead<PE_COFF_ENDIANNESS>(data.data() + offset + 4, type);
+			// Each block must advance the walk, and stay within its parent
+			if (length < BLOCK_HEADER_LENGTH || length > parentEnd - offset)
+			{
+				return Unexpected{ ErrorCode::BadVersionInfo };
+			}
+			Block block;
+			block.end = offset + length;
+
+			std::size_t keyOffset = offset + BLOCK_HEADER_LENGTH;
+			std::size_t keyEnd = keyOffset;
+			for (;; keyEnd += sizeof(char16_t))
+			{
+				if (block.end - keyEnd < sizeof(char16_t))
+				{
+					return Unexpected{ ErrorCode::BadVersionInfo };
+				}
+				if (data[keyEnd] == 0 && data[keyEnd + 1] == 0)
+				{
+					break;
+				}
+			}
+			block.key = Utf16LeView{ data.subspan(keyOffset, keyEnd - keyOffset) };
+
+			std::size_t valueOffset = std::min(Align4(keyEnd + sizeof(char16_t)), block.end);
+			std::size_t valueBytes = type == BLOCK_TYPE_TEXT ? valueLength * sizeof(char16_t) : valueLength;
+			valueBytes = std::min(valueBytes, block.end - valueOffset);
+			block.value = data.subspan(valueOffset, valueBytes);
+			block.childrenOffset = std::min(Align4(valueOffset + valueBytes), block.end);
+			return block;
+		}
+
+		// Some writers count text values in bytes, so the value is cut at the terminator instead
+		Utf16LeView TextValue(std::span<const unsigned char> data, const Block& block)
+		{
+			std::size_t valueOffset = static_cast<std::size_t>(block.value.data() - data.data());
+			if (block.value.empty())
+			{
+				return {};
+			}
+			Utf16LeView text{ data.subspan(valueOffset, block.end - valueOffset) };
+			std::size_t length = 0;
+			while (length < text.size() && text[length] != u'\0')
+			{
+				length++;
+			}
+			return Utf16LeView{ text.bytes().first(length * sizeof(char16_t)) };
+		}
+	}
+	#pragma endregion
+
+	VersionInfo::VersionInfo() noexcept
+		: _data{},
+		_childrenOffset{},
+		_fixedFileInfo{},
+		_translations{}
+	{
+	}
+
+	Result<VersionInfo> VersionInfo::Parse(std::span<const unsigned char> data)
+	{
+		Result<Block> root = ReadBlock(data, 0, data.size());
+		if (!root)
+		{
+			return Unexpected{ root.error() };
+		}
+		if (!(root->key == u"VS_VERSION_INFO"))
+		{
+			return Unexpected{ ErrorCode::BadVersionInfo };
+		}
+		VersionInfo info;
+		info._data = data.first(root->end);
+		info._childrenOffset = root->childrenOffset;
+		if (root->value.size() >= sizeof(FixedFileInfo))
+		{
+			FixedFileInfo fixedFileInfo;
+			Memory::ReadStruct<PE_COFF_ENDIANNESS>(root->value.data(), fixedFileInfo);
+			if (fixedFileInfo.dwSignature == VS_FFI_SIGNATURE)
+			{
+				info._fixedFileInfo = fixedFileInfo;
+			}
+		}
+
+		// VarFileInfo\Translation. Malformed variables are ignored, as they don't affect strings
+		for (std::size_t offset = info._childrenOffset; offset < root->end;)
+		{
+			Result<Block> child = ReadBlock(data, offset, root->end);
+			if (!child)
+			{
+				break;
+			}
+			if (child->key == u"VarFileInfo")
+			{
+				for (std::size_t varOffset = child->childrenOffset; varOffset < child->end;)
+				{
+					Result<Block> var = ReadBlock(data, varOffset, child->end);
+					if (!var)
+					{
+						break;
+					}
+					if (var->key == u"Translation")
+					{
+						info._translations = var->value;
+						break;
+					}
+					varOffset = Align4(var->end);
+				}
+			}
+			offset = Align4(child->end);
+		}
+		return info;
+	}
+
+	Result<Utf16LeView> VersionInfo::FindString(std::u16string_view key) const
+	{
+		for (const Result<VersionString>& str : strings())
+		{
+			if (!str)
+			{
+				return Unexpected{ str.error() };
+			}
+			if (str->key == key)
+			{
+				return str->value;
+			}
+		}
+		return Unexpected{ ErrorCode::ResourceNotFound };
+	}
+
+	VersionTranslation VersionInfo::translationAt(std::size_t index) const noexcept
+	{
+		VersionTranslation translation;
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(_translations.data() + index * sizeof(std::uint32_t), translation.language);
+		Memory::UnalignedRead<PE_COFF_ENDIANNESS>(_translations.data() + index * sizeof(std::uint32_t) + sizeof(std::uint16_t), translation.codePage);
+		return translation;
+	}
+
+	#pragma region Iterator
+	VersionInfo::Iterator::Iterator() noexcept
+		: _owner{},
+		_childOffset{},
+		_tableOffset{},
+		_tablesEnd{},
+		_stringOffset{},
+		_stringsEnd{},
+		_table{},
+		_current{},
+		_done{ true }
+	{
+	}
+
+	VersionInfo::Iterator::Iterator(const VersionInfo* owner)
+		: _owner{ owner },
+		_childOffset{ owner->_childrenOffset },
+		_tableOffset{},
+		_tablesEnd{},
+		_stringOffset{},
+		_stringsEnd{},
+		_table{},
+		_current{},
+		_done{}
+	{
+		Load();
+	}
+
+	VersionInfo::Iterator& VersionInfo::Iterator::operator++()
+	{
+		// An error is the last element
+		if (!_current)
+		{
+			_done = true;
+		}
+		else
+		{
+			Load();
+		}
+		return *this;
+	}
+
+	void VersionInfo::Iterator::Load()
+	{
+		std::span<const unsigned char> data = _owner->_data;
+		// Every step consumes a block, so the loop ends within the resource length
+		while (true)
+		{
+			if (_stringOffset < _stringsEnd)
+			{
+				Result<Block> str = ReadBlock(data, _stringOffset, _stringsEnd);
+				if (!str)
+				{
+					_current = Unexpected{ str.error() };
+					return;
+				}
+				_stringOffset = Align4(str->end);
+				_current = VersionString{ _table, str->key, TextValue(data, *str) };
+				return;
+			}
+			if (_tableOffset < _tablesEnd)
+			{
+				Result<Block> table = ReadBlock(data, _tableOffset, _tablesEnd);
+				if (!table)
+				{
+					_current = Unexpected{ table.error() };
+					return;
+				}
+				_tableOffset = Align4(table->end);
+				_table = table->key;
+				_stringOffset = table->childrenOffset;
+				_stringsEnd = table->end;
+				continue;
+			}
+			if (_childOffset < data.size())
+			{
+				Result<Block> child = ReadBlock(data, _childOffset, data.size());
+				if (!child)
+				{
+					_current = Unexpected{ child.error() };
+					return;
+				}
+				_childOffset = Align4(child->end);
+				if (child->key == u"StringFileInfo")
+				{
+					_tableOffset = child->childrenOffset;
+					_tablesEnd = child->end;
+				}
+				continue;
+			}
+			_done = true;
+			return;
+		}
+	}
+	#pragma endregion
+}
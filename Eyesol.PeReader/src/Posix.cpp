@@ -0,0 +1,18 @@
+#if defined __unix__ || defined __APPLE__
+#	include <cstring>
+#	include "Posix.hpp"
+
+namespace Eyesol::Posix
+{
+	std::string FormatPosixErrorMessage(int code, std::string actionDescription)
+	{
+		return
+			std::string("An error occured while ")
+			+ actionDescription
+			+ ", error code: "
+			+ std::to_string(code)
+			+ ", message: "
+			+ std::strerror(code);
+	}
+}
+#endif
@@ -0,0 +1,20 @@
+#if defined __unix__ || defined __APPLE__
+#include "Runtime.hpp"
+#include <unistd.h>
+
+namespace
+{
+	inline std::size_t QueryAllocationGranularity()
+	{
+		// mmap() offsets only have to be aligned to a page size
+		long pageSize = ::sysconf(_SC_PAGESIZE);
+		return pageSize > 0 ? static_cast<std::size_t>(pageSize) : 4096U;
+	}
+}
+
+std::size_t Eyesol::Runtime::AllocationGranularity()
+{
+	static std::size_t data = QueryAllocationGranularity();
+	return data;
+}
+#endif
@@ -0,0 +1,32 @@
+#include <mutex>
+#include "StringPool.hpp"
+
+namespace Eyesol
+{
+	std::string_view StringPool::Intern(std::string_view str)
+	{
+		{
+			std::shared_lock lock{ _mutex };
+			auto it = _strings.find(str);
+			if (it != _strings.end())
+			{
+				return *it;
+			}
+		}
+		std::unique_lock lock{ _mutex };
+		// Another thread may have added the string in the meantime
+		return *_strings.emplace(str).first;
+	}
+
+	std::size_t StringPool::size() const
+	{
+		std::shared_lock lock{ _mutex };
+		return _strings.size();
+	}
+
+	StringPool& StringPool::Shared()
+	{
+		static StringPool pool;
+		return pool;
+	}
+}
@@ -0,0 +1,138 @@
+#if defined __unix__ || defined __APPLE__
+#include "Strings.hpp"
+
+namespace Eyesol
+{
+	// On POSIX systems, wchar_t is a 32-bit type holding UTF-32 code points
+	static_assert(sizeof(wchar_t) == sizeof(char32_t), "wchar_t is expected to hold UTF-32");
+
+	namespace
+	{
+		constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+		void AppendUtf8(std::string& str, char32_t codePoint)
+		{
+			if (codePoint < 0x80)
+			{
+				str.push_back(static_cast<char>(codePoint));
+			}
+			else if (codePoint < 0x800)
+			{
+				str.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+				str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+			}
+			else if (codePoint < 0x10000)
+			{
+				str.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+				str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+				str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+			}
+			else
+			{
+				str.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+				str.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+				str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+				str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+			}
+		}
+	}
+
+	std::wstring utf8string_to_wstring(std::string str)
+	{
+		std::wstring newString;
+		newString.reserve(str.size());
+		std::size_t i = 0;
+		while (i < str.size())
+		{
+			unsigned char lead = static_cast<unsigned char>(str[i]);
+			std::size_t sequenceLength;
+			char32_t codePoint;
+			if (lead < 0x80)
+			{
+				sequenceLength = 1;
+				codePoint = lead;
+			}
+			else if ((lead & 0xE0) == 0xC0)
+			{
+				sequenceLength = 2;
+				codePoint = lead & 0x1F;
+			}
+			else if ((lead & 0xF0) == 0xE0)
+			{
+				sequenceLength = 3;
+				codePoint = lead & 0x0F;
+			}
+			else if ((lead & 0xF8) == 0xF0)
+			{
+				sequenceLength = 4;
+				codePoint = lead & 0x07;
+			}
+			else
+			{
+				throw std::runtime_error{ "Invalid UTF-8 lead byte at position " + std::to_string(i) };
+			}
+			if (str.size() - i < sequenceLength)
+			{
+				throw std::runtime_error{ "Truncated UTF-8 sequence at position " + std::to_string(i) };
+			}
+			for (std::size_t j = 1; j < sequenceLength; j++)
+			{
+				unsigned char continuation = static_cast<unsigned char>(str[i + j]);
+				if ((continuation & 0xC0) != 0x80)
+				{
+					throw std::runtime_error{ "Invalid UTF-8 continuation byte at position " + std::to_string(i + j) };
+				}
+				codePoint = (codePoint << 6) | (continuation & 0x3F);
+			}
+			newString.push_back(static_cast<wchar_t>(codePoint));
+			i += sequenceLength;
+		}
+		return newString;
+	}
+
+	std::string wstring_to_utf8string(std::wstring str)
+	{
+		std::string newString;
+		newString.reserve(str.size());
+		for (wchar_t ch : str)
+		{
+			char32_t codePoint = static_cast<char32_t>(ch);
+			if (codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+			{
+				// Not a valid Unicode scalar value
+				codePoint = REPLACEMENT_CHARACTER;
+			}
+			AppendUtf8(newString, codePoint);
+		}
+		return newString;
+	}
+
+	std::wstring u16string_to_wstring(std::u16string str)
+	{
+		std::wstring convertedStr;
+		convertedStr.reserve(str.length());
+		for (std::size_t i = 0; i < str.length(); i++)
+		{
+			char32_t unit = str[i];
+			if (unit >= 0xD800 && unit <= 0xDBFF
+				&& i + 1 < str.length()
+				&& str[i + 1] >= 0xDC00 && str[i + 1] <= 0xDFFF)
+			{
+				// A surrogate pair
+				char32_t low = str[++i];
+				convertedStr.push_back(static_cast<wchar_t>(0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00)));
+			}
+			else if (unit >= 0xD800 && unit <= 0xDFFF)
+			{
+				// An unpaired surrogate
+				convertedStr.push_back(static_cast<wchar_t>(REPLACEMENT_CHARACTER));
+			}
+			else
+			{
+				convertedStr.push_back(static_cast<wchar_t>(unit));
+			}
+		}
+		return convertedStr;
+	}
+}
+#endif
@@ -1,3 +1,4 @@
+#if defined _WIN32
 #include "Strings.hpp"
 #include "Windows.hpp"
 
@@ -100,4 +101,5 @@ namespace Eyesol
 		}
 		return std::move(convertedStr);
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include "ViewCache.hpp"
+#include "Runtime.hpp"
+
+namespace Eyesol::MemoryMappedIO::Impl
+{
+	ViewCache::ViewCache(std::size_t capacity)
+		: _granularity{ Eyesol::Runtime::AllocationGranularity() },
+		_capacity{ capacity },
+		_hits{},
+		_misses{},
+		_evictions{}
+	{
+	}
+
+	MappedView ViewCache::Find(std::uint64_t offset, std::size_t length)
+	{
+		Shard& shard = _shards[ShardIndex(offset)];
+		std::lock_guard lock{ shard.mutex };
+		auto& entries = shard.entries;
+		for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+		{
+			if (it->offset == offset && it->length >= length)
+			{
+				// Move the entry to the most recently used position
+				auto forwardIt = std::prev(it.base());
+				std::rotate(forwardIt, forwardIt + 1, entries.end());
+				_hits.fetch_add(1, std::memory_order_relaxed);
+				return entries.back().view;
+			}
+		}
+		_misses.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	MappedView ViewCache::Insert(std::uint64_t offset, std::size_t length, MappedView view)
+	{
+		std::size_t shardIndex = ShardIndex(offset);
+		std::size_t shardCapacity = ShardCapacity(shardIndex);
+		if (shardCapacity == 0)
+		{
+			return view;
+		}
+		Shard& shard = _shards[shardIndex];
+		std::lock_guard lock{ shard.mutex };
+		auto& entries = shard.entries;
+		for (auto&& entry : entries)
+		{
+			if (entry.offset == offset && entry.length >= length)
+			{
+				return entry.view;
+			}
+		}
+		Trim(shard, shardCapacity - 1);
+		entries.push_back(Entry{ offset, length, view });
+		return view;
+	}
+
+	void ViewCache::SetCapacity(std::size_t capacity)
+	{
+		_capacity.store(capacity, std::memory_order_relaxed);
+		for (std::size_t i = 0; i < SHARDS_COUNT; i++)
+		{
+			std::lock_guard lock{ _shards[i].mutex };
+			Trim(_shards[i], ShardCapacity(i));
+		}
+	}
+
+	ViewCacheStatistics ViewCache::statistics() const noexcept
+	{
+		return ViewCacheStatistics{
+			_hits.load(std::memory_order_relaxed),
+			_misses.load(std::memory_order_relaxed),
+			_evictions.load(std::memory_order_relaxed),
+			_capacity.load(std::memory_order_relaxed)
+		};
+	}
+
+	std::size_t ViewCache::ShardIndex(std::uint64_t offset) const noexcept
+	{
+		// Neighbouring windows go to different shards
+		return static_cast<std::size_t>(offset / _granularity % SHARDS_COUNT);
+	}
+
+	std::size_t ViewCache::ShardCapacity(std::size_t shardIndex) const noexcept
+	{
+		std::size_t capacity = _capacity.load(std::memory_order_relaxed);
+		return capacity / SHARDS_COUNT + (shardIndex < capacity % SHARDS_COUNT ? 1 : 0);
+	}
+
+	void ViewCache::Trim(Shard& shard, std::size_t shardCapacity)
+	{
+		auto& entries = shard.entries;
+		if (entries.size() <= shardCapacity)
+		{
+			return;
+		}
+		std::size_t evictedCount = entries.size() - shardCapacity;
+		entries.erase(entries.begin(), entries.begin() + evictedCount);
+		_evictions.fetch_add(evictedCount, std::memory_order_relaxed);
+	}
+}
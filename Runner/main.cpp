@@ -2,10 +2,48 @@
 #include <WindowsConsoleOutputFix.hpp>
 #include <Eyesol.PeReader.hpp>
 #include <PeHeaders.hpp>
+#include <Memory.hpp>
+#include <CpuFeatures.hpp>
 #include <vector>
 #include <array>
 #include <chrono>
 
+// Measures throughput of the MZ checksum word sum with every kernel available on this CPU
+void BenchmarkMzChecksum()
+{
+	constexpr std::size_t BUFFER_LENGTH = 64 * 1024 * 1024;
+	constexpr int REPETITIONS = 16;
+	std::vector<unsigned char> buffer(BUFFER_LENGTH);
+	for (std::size_t i = 0; i < buffer.size(); i++)
+	{
+		buffer[i] = static_cast<unsigned char>(i * 31);
+	}
+	std::cout << "CPU features: " << Eyesol::Cpu::Features::Detected().ToString() << std::endl;
+
+	using Eyesol::Cpu::Feature;
+	const std::pair<const char*, Eyesol::Cpu::Features> configurations[] =
+	{
+		{ "best", ~Eyesol::Cpu::Features{} },
+		{ "without AVX2", ~Eyesol::Cpu::Features{ Feature::Avx2 } },
+		{ "portable", Eyesol::Cpu::Features{} },
+	};
+	for (auto&& [name, allowedFeatures] : configurations)
+	{
+		Eyesol::Cpu::SetAllowedFeatures(allowedFeatures);
+		std::uint16_t sum{};
+		auto t1 = std::chrono::steady_clock::now();
+		for (int i = 0; i < REPETITIONS; i++)
+		{
+			sum += Eyesol::Memory::Impl::LittleEndianWordSum(buffer.data(), buffer.size());
+		}
+		auto t2 = std::chrono::steady_clock::now();
+		std::chrono::duration<double> time = t2 - t1;
+		double gigabytesPerSecond = static_cast<double>(BUFFER_LENGTH) * REPETITIONS / time.count() / 1e9;
+		std::cout << "MZ checksum (" << name << "): " << gigabytesPerSecond << " GB/s, sum " << sum << std::endl;
+	}
+	Eyesol::Cpu::SetAllowedFeatures(~Eyesol::Cpu::Features{});
+}
+
 int main()
 {
 	Eyesol::Windows::FixStdStreams();
@@ -42,6 +80,7 @@ int main()
 	{
 		std::cout << e.what() << std::endl;
 	}
+	BenchmarkMzChecksum();
 
 	return Eyesol::start();
 }
\ No newline at end of file